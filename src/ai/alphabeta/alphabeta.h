@@ -5,26 +5,52 @@
 #ifndef AI_ALPHABETA_ALPHABETA_H_
 #define AI_ALPHABETA_ALPHABETA_H_
 
-#include <time.h>
+#include <stdint.h>
 
 #include <algorithm>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "ai/alphabeta/move_ordering.h"
+#include "ai/alphabeta/transposition_table.h"
 #include "base/basic_macros.h"
-#include "base/hash_map.h"
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/log.h"
+#include "base/method.h"
 #include "base/ptr/scoped_ptr.h"
+#include "base/random.h"
+#include "base/string_util.h"
+#include "base/threading/atomic.h"
+#include "base/threading/condition_variable.h"
+#include "base/threading/lock.h"
+#include "base/threading/scoped_guard.h"
+#include "base/threading/thread.h"
+#include "base/time_util.h"
 
 namespace ai {
 namespace alphabeta {
 
 // Placeholder for hashing function that must be specialized for each concrete
-// type that is used to encode a game state.
+// type that is used to encode a game state. The result is used as the key of
+// the state in the transposition table, so different states should have
+// different hashes with a very high probability.
 template <class State> size_t Hash(const State& state);
 
+// The algorithms that can be used to split a search between multiple threads.
+enum ParallelSearchMode {
+  // Lazy SMP: each helper thread runs its own iterative deepening search and
+  // the threads only communicate through the shared transposition table.
+  SHARED_TRANSPOSITION_TABLE,
+  // Young Brothers Wait: the first successor of a state is always searched
+  // by the thread that owns the state. After that, the remaining successors
+  // can be searched in parallel by any idle thread.
+  YOUNG_BROTHERS_WAIT
+};
+
 // This represents a generic implementation of the Alpha Beta Pruning algorithm.
 // The template is based on two external classes. The |State| class must be an
 // encoding of a game state. It is extensively used throughout the search so
@@ -35,7 +61,9 @@ template <class State> size_t Hash(const State& state);
 //   - The State class must provide a default constructor, copy constructor,
 //     assignment operator and == operator.
 //   - The Score class must be copyable, assignable and must implement the
-//     comparison operators <, == and <=.
+//     comparison operators <, == and <=. It must also support adding and
+//     subtracting Score values, including the integer 1, which are used to
+//     build the null windows and the aspiration windows.
 template <class State, class Score = int>
 class AlphaBeta {
  public:
@@ -54,11 +82,63 @@ class AlphaBeta {
     // not mandatory to be a terminal one.
     virtual Score Evaluate(const State& state) = 0;
 
+    // This method can store in |scores| the scores of the |count| states from
+    // |states|, as returned by |Evaluate()|, and return |true|. The search
+    // calls it with all the successors of a state whose successors are
+    // leaves, before it visits them, so the delegate can evaluate the sibling
+    // states together. This is only useful if the evaluation is cheap, since
+    // the leaves that are pruned are also evaluated. By default, it returns
+    // |false| and |Evaluate()| is called for each leaf that is visited.
+    virtual bool EvaluateBatch(const State* states, int count, Score* scores) {
+      return false;
+    }
+
     // This method must fill in the |successors| vector with the successors of
-    // the state given as first argument.
+    // the state given as first argument. The successors of a given state must
+    // always be returned in the same order, since the transposition table only
+    // stores the index of the best successor.
     virtual void GetSuccessors(const State& state,
                                std::vector<State>* successors) = 0;
 
+    // This method must return a new delegate, owned by the caller, that
+    // behaves like this one and that can be used on a different thread at the
+    // same time with this one. It is only called if the search uses helper
+    // threads.
+    virtual Delegate* CreateHelperDelegate() {
+      NOTREACHED();
+      return NULL;
+    }
+
+    // This method can return an id, between 0 and |GetMoveCount()| - 1, for
+    // the move that leads from |state| to its |successor|. Moves that have
+    // the same effect in different states, e.g. moving a piece between the
+    // same two locations, must have the same id. The ids are used by the
+    // killer move and the history heuristics to order the successors. By
+    // default these heuristics are disabled, and the method returns -1.
+    virtual int GetMoveId(const State& state, const State& successor) {
+      return -1;
+    }
+
+    // Returns the number of distinct move ids. See |GetMoveId()|.
+    virtual int GetMoveCount() { return 0; }
+
+    // This method can return the key of |state| in the transposition table.
+    // Different states can share a key if they have the same score and if
+    // their successors are returned in corresponding orders, so that the
+    // index of the best successor stored for one of them is also valid for
+    // the others (e.g. symmetric positions). By default, the key is given by
+    // |Hash()|.
+    virtual uint64_t GetTranspositionKey(const State& state) {
+      return Hash<State>(state);
+    }
+
+    // This method can fill in the |successors| vector with the noisy
+    // successors of |state|, i.e. the ones whose static evaluation is not
+    // reliable because they are in the middle of an exchange. The quiescence
+    // search only follows these successors. By default there are none.
+    virtual void GetNoisySuccessors(const State& state,
+                                    std::vector<State>* successors) {}
+
    protected:
     Delegate() {}
 
@@ -66,25 +146,128 @@ class AlphaBeta {
     DISALLOW_COPY_AND_ASSIGN(Delegate);
   };
 
+  // The number of states visited by a thread between two checks of the
+  // search limits, so that the cost of reading the clock is amortized.
+  static const int kNodesPerLimitCheck = 1024;
+
+  // The statistics of one iteration of the iterative deepening search. The
+  // counters only include the states visited by the calling thread.
+  struct IterationStatistics {
+    IterationStatistics()
+        : depth(0),
+          score(),
+          node_count(0),
+          tt_hits(0),
+          tt_misses(0),
+          tt_cutoffs(0),
+          expanded_states(0),
+          searched_successors(0),
+          quiescence_node_count(0),
+          time(0) {}
+
+    // The average number of successors searched for each expanded state.
+    double branching_factor() const {
+      return expanded_states ?
+          static_cast<double>(searched_successors) / expanded_states : 0;
+    }
+
+    int depth;
+    Score score;
+    int64_t node_count;
+
+    // The number of transposition table probes that found an entry for the
+    // searched state and the number of probes that did not. |tt_cutoffs| is
+    // the number of hits whose score was used without searching the state.
+    int64_t tt_hits;
+    int64_t tt_misses;
+    int64_t tt_cutoffs;
+
+    // The number of states whose successors were generated and the number of
+    // successors searched before the cutoffs.
+    int64_t expanded_states;
+    int64_t searched_successors;
+
+    // The number of states visited by the quiescence search, which are also
+    // included in |node_count|.
+    int64_t quiescence_node_count;
+
+    // The duration of the iteration in nanoseconds.
+    int64_t time;
+
+    // The states along the best line of play found by the iteration, starting
+    // with the best successor of the root. It is read from the transposition
+    // table, so it is shorter than |depth| if the entries were overwritten.
+    std::vector<State> principal_variation;
+  };
+
   // The constructor receives as argument a Delegate instance that is used to
   // adapt the Alpha Beta Pruning algorithm to a specific game.
   explicit AlphaBeta(std::auto_ptr<Delegate> delegate)
       : delegate_(delegate.release()),
         max_search_time_(1000000000),  // One second
         max_search_depth_(std::numeric_limits<int>::max()),
-        shuffle_(true) {}
+        max_node_count_(0),
+        shuffle_(true),
+        random_(),
+        pvs_(false),
+        aspiration_window_(),
+        quiescence_depth_(0),
+        helper_thread_count_(0),
+        parallel_search_mode_(SHARED_TRANSPOSITION_TABLE),
+        node_count_(0),
+        statistics_(NULL),
+        owned_trans_table_(new TranspositionTable<Score>()),
+        trans_table_(Get(owned_trans_table_)),
+        split_condition_(&split_lock_) {}
+
+  // Same as above, but the searches will use the given |trans_table| instead
+  // of creating a new one. This allows the clients to keep the results of
+  // previous searches between different AlphaBeta instances. The table is not
+  // owned by this class and it must outlive it.
+  AlphaBeta(std::auto_ptr<Delegate> delegate,
+            TranspositionTable<Score>* trans_table)
+      : delegate_(delegate.release()),
+        max_search_time_(1000000000),  // One second
+        max_search_depth_(std::numeric_limits<int>::max()),
+        max_node_count_(0),
+        shuffle_(true),
+        random_(),
+        pvs_(false),
+        aspiration_window_(),
+        quiescence_depth_(0),
+        helper_thread_count_(0),
+        parallel_search_mode_(SHARED_TRANSPOSITION_TABLE),
+        node_count_(0),
+        statistics_(NULL),
+        owned_trans_table_(),
+        trans_table_(trans_table),
+        split_condition_(&split_lock_) {
+    DCHECK(trans_table_);
+  }
 
   // Parameter used to limit the time (in nanoseconds) required to perform a
-  // search. The value cannot be greater than 2 seconds.
-  // The limit is not a strict one. When the time expires the search will still
-  // continue until the current depth level is reached. By default the limit is
-  // set to one second.
-  unsigned int max_search_time() const { return max_search_time_; }
-  void set_max_search_time(unsigned int max_time) {
-    DCHECK_LT(max_time, 2000000000);  // No more than 2 seconds per search.
+  // search. The time is checked after every |kNodesPerLimitCheck| states
+  // visited by each thread, so the limit is only exceeded by the time needed
+  // to visit that many states. When the time expires, the iteration of the
+  // iterative deepening that is in progress is abandoned and the search
+  // returns the best successor found by the last completed one. The first
+  // iteration is always completed. By default the limit is set to one second.
+  int64_t max_search_time() const { return max_search_time_; }
+  void set_max_search_time(int64_t max_time) {
+    DCHECK_GT(max_time, 0);
     max_search_time_ = max_time;
   }
 
+  // Parameter used to limit the number of states visited by all the threads
+  // during a search. The limit is enforced in the same way as the time limit,
+  // so it can be exceeded by |kNodesPerLimitCheck| states for each thread. By
+  // default there is no limit for this, which is denoted by zero.
+  int64_t max_node_count() const { return max_node_count_; }
+  void set_max_node_count(int64_t max_node_count) {
+    DCHECK(max_node_count >= 0);
+    max_node_count_ = max_node_count;
+  }
+
   // Parameter used to limit the depth of a search. By default there is no
   // limit for this.
   int max_search_depth() const { return max_search_depth_; }
@@ -98,73 +281,672 @@ class AlphaBeta {
   bool is_shuffling_enabled() const { return shuffle_; }
   void set_shuffling_enabled(bool enable) { shuffle_ = enable; }
 
+  // Sets the seed of the random generator used to shuffle the successors. Each
+  // thread of a search shuffles with its own generator, which is seeded from
+  // this one when the search starts, so the searches without helper threads
+  // are reproducible for a given seed.
+  void set_seed(uint64_t seed) { random_ = base::XorShift64Star(seed); }
+
+  // Specify whether the Principal Variation Search should be used. In this
+  // case, only the first successor of a state is searched with the full
+  // window. The other ones are searched with a null window that only checks
+  // if they are better than the first one, and they are searched again with
+  // the full window only if they are. By default, PVS is disabled.
+  bool is_pvs_enabled() const { return pvs_; }
+  void set_pvs_enabled(bool enable) { pvs_ = enable; }
+
+  // If this is greater than zero, each iteration of the iterative deepening
+  // search, except for the first one, starts with a window of this size
+  // around the score found by the previous iteration. If the score falls
+  // outside the window, the window is widened in that direction and the
+  // search is repeated. By default, aspiration windows are disabled.
+  Score aspiration_window() const { return aspiration_window_; }
+  void set_aspiration_window(Score size) { aspiration_window_ = size; }
+
+  // The number of helper threads that search the game tree at the same time
+  // with the calling thread. The result is always the one found by the
+  // calling thread, which also decides when the search is over. The delegate
+  // must implement |CreateHelperDelegate()| if this is not zero. By default
+  // there are no helper threads.
+  int helper_thread_count() const { return helper_thread_count_; }
+  void set_helper_thread_count(int count) {
+    DCHECK(count >= 0);
+    helper_thread_count_ = count;
+  }
+
+  // The way in which the work is split between the calling thread and the
+  // helper threads. With SHARED_TRANSPOSITION_TABLE the helpers run their own
+  // iterative deepening searches, half of them one level ahead of the calling
+  // thread, so the calling thread finds more of its states already evaluated.
+  // With YOUNG_BROTHERS_WAIT the helpers only search the successors of the
+  // states that the calling thread shares with them. By default, the helpers
+  // use the shared transposition table.
+  ParallelSearchMode parallel_search_mode() const {
+    return parallel_search_mode_;
+  }
+  void set_parallel_search_mode(ParallelSearchMode mode) {
+    parallel_search_mode_ = mode;
+  }
+
+  // If this is greater than zero, the states at the maximum depth of the
+  // search are not evaluated directly. Instead, a quiescence search follows
+  // their noisy successors, as returned by |Delegate::GetNoisySuccessors()|,
+  // for at most this many levels. At each level, the player to move can also
+  // stand pat, i.e. choose a quiet move, which is assumed to be worth the
+  // static evaluation of the state. By default, there is no quiescence search.
+  int quiescence_depth() const { return quiescence_depth_; }
+  void set_quiescence_depth(int depth) {
+    DCHECK(depth >= 0);
+    quiescence_depth_ = depth;
+  }
+
+  // The number of states visited by all the threads during the last search.
+  int64_t node_count() const { return node_count_; }
+
+  // If this is not NULL, it is cleared at the start of each search and the
+  // statistics of each completed iteration are appended to it. The counters
+  // are only updated while statistics are collected, so they have no cost
+  // otherwise. The vector is not owned by this class. By default, statistics
+  // are not collected.
+  std::vector<IterationStatistics>* statistics() const { return statistics_; }
+  void set_statistics(std::vector<IterationStatistics>* statistics) {
+    statistics_ = statistics;
+  }
+
+  // The maximum amount of memory, in bytes, used by the transposition table.
+  // Changing the size deletes all the entries from the table.
+  size_t transposition_table_size() const { return trans_table_->size(); }
+  void set_transposition_table_size(size_t size) { trans_table_->Resize(size); }
+
+  // Specify whether the next searches ponder, i.e. search the position that
+  // follows the move predicted for the opponent while the opponent thinks.
+  // A pondering search ignores the time and node limits until |PonderHit()|
+  // is called, so it only ends when |max_search_depth_| is reached or when
+  // |Stop()| is called. By default, pondering is disabled.
+  bool is_pondering() const { return pondering_.Get() != 0; }
+  void set_pondering(bool enable) {
+    if (enable) {
+      pondering_.BitwiseOr(1);
+    } else {
+      pondering_.BitwiseAnd(0);
+    }
+  }
+
+  // Called from another thread during a pondering search if the opponent
+  // played the predicted move. The search continues, but the time and node
+  // limits are enforced from now on. The time limit is measured from this
+  // call, while the node limit includes the states visited while pondering.
+  void PonderHit() {
+    int64_t start_time;
+    do {
+      start_time = start_time_.Get();
+    } while (!start_time_.CompareAndSwap(start_time, base::GetMonotonicTime()));
+    pondering_.BitwiseAnd(0);
+  }
+
+  // Can be called from any thread to abandon the search that is in progress.
+  // If no search is in progress, the next one is abandoned as soon as it
+  // starts. The search returns the best successor found by the last completed
+  // iteration, or the first successor if no iteration was completed.
+  void Stop() { search_aborted_.BitwiseOr(1); }
+
   // Starts an iterative deepening search in the partially constructed game tree
   // that is rooted at the state given by the |origin| argument. It continously
   // increases the depth of the search until |max_search_depth_| is reached or
-  // the time required to reach the current depth level exceeded
-  // |max_search_time_|. The method returns the best successor state that it
-  // found. It is the responsibility of the users of this method to determine
-  // the actual move that gets them from |origin| to that specific state.
+  // one of the |max_search_time_| and |max_node_count_| limits is exceeded.
+  // The method returns the best successor state found by the last completed
+  // iteration. It is the responsibility of the users of this method to
+  // determine the actual move that gets them from |origin| to that specific
+  // state.
   State GetBestSuccessor(const State& origin) {
     const Score min_infinity = std::numeric_limits<Score>::min();
     const Score max_infinity = std::numeric_limits<Score>::max();
-    clock_gettime(CLOCK_MONOTONIC, &start_time_);
+    start_time_.BitwiseAnd(0);
+    start_time_.Add(base::GetMonotonicTime());
+    trans_table_->NewSearch();
+    node_count_ = 0;
+    shared_node_count_.BitwiseAnd(0);
+    limits_enabled_.BitwiseAnd(0);
+    if (statistics_) {
+      statistics_->clear();
+    }
+    StartHelperThreads(origin);
+    SearchThread main_thread(Get(delegate_), false, NextSeed());
+    int best_move = 0;
+    Score score = Score();
     for (int depth = 1; depth <= max_search_depth_; ++depth) {
-      Search(origin, depth, min_infinity, max_infinity, true);
-      if (TimedOut()) {
+      main_thread.root_depth = depth;
+      IterationStatistics iteration;
+      if (statistics_) {
+        main_thread.statistics = &iteration;
+        iteration.node_count = main_thread.node_count;
+        iteration.time = base::GetMonotonicTime();
+      }
+      int move = best_move;
+      Score iteration_score;
+      if (depth > 1 && Score() < aspiration_window_) {
+        iteration_score =
+            AspirationSearch(&main_thread, origin, depth, score, &move);
+      } else {
+        iteration_score = Search(&main_thread, origin, depth, min_infinity,
+                                 max_infinity, true, &move);
+      }
+      if (search_aborted_.Get()) {
+        // The results of an incomplete iteration are discarded.
         break;
       }
+      best_move = move;
+      score = iteration_score;
+      if (statistics_) {
+        iteration.depth = depth;
+        iteration.score = score;
+        iteration.node_count = main_thread.node_count - iteration.node_count;
+        iteration.time = base::GetMonotonicTime() - iteration.time;
+        GetPrincipalVariation(origin, best_move, depth,
+                              &iteration.principal_variation);
+        statistics_->push_back(iteration);
+      }
+      if (LimitsExceeded(main_thread.node_count)) {
+        break;
+      }
+      limits_enabled_.BitwiseOr(1);
     }
-    typename TranspositionTable::const_iterator it = trans_table_.find(origin);
-    DCHECK(it != trans_table_.end());
-    DCHECK_GT(it->second.successors.size(), 0);
-    return it->second.successors[0];
+    StopHelperThreads();
+    search_aborted_.BitwiseAnd(0);
+    node_count_ += main_thread.node_count;
+    std::vector<State> successors;
+    delegate_->GetSuccessors(origin, &successors);
+    DCHECK_LT(static_cast<size_t>(best_move), successors.size());
+    return successors[best_move];
   };
 
  private:
-  // Enum used to specify how the score of a state stored in the transposition
-  // table should be interpreted.
-  enum EvalType {
-    // The score was obtained by calling |Delegate::Evaluate| on that state.
-    EXACT,
-    // The exact score is less than or equal to the value from the table.
-    ALPHA,
-    // The exact score is greater that or equal to the value from the table.
-    BETA
-  };
+  typedef typename TranspositionTable<Score>::Entry TransTableEntry;
 
-  struct TransTableEntry {
-    int depth;
-    Score score;
+  // Successors are only searched in parallel if they are the roots of
+  // subtrees that are at least this deep, so that sharing them with other
+  // threads is worth the synchronization cost.
+  static const int kMinSplitDepth = 2;
+
+  // The bounds of a state that is being searched and its best successor.
+  struct Window {
+    Window(Score alpha, Score beta, bool max_player, int best)
+        : alpha(alpha),
+          beta(beta),
+          max_player(max_player),
+          best(best),
+          eval_type(max_player ? ALPHA : BETA) {}
+
+    // Updates the bounds with the |score| of the successor at index
+    // |successor|. Returns |true| if the remaining successors can be pruned.
+    bool Update(Score score, int successor) {
+      if (max_player) {
+        if (alpha < score) {
+          alpha = score;
+          best = successor;
+          eval_type = EXACT;
+        }
+        if (beta <= alpha) {
+          eval_type = BETA;
+          return true;
+        }
+        return false;
+      }
+      if (score < beta) {
+        beta = score;
+        best = successor;
+        eval_type = EXACT;
+      }
+      if (beta <= alpha) {
+        eval_type = ALPHA;
+        return true;
+      }
+      return false;
+    }
+
+    // The score of the state, as it is returned by the search.
+    Score score() const { return max_player ? alpha : beta; }
+
+    // The score of the state, as it is stored in the transposition table.
+    Score stored_score() const {
+      return eval_type == BETA ? beta : (eval_type == ALPHA ? alpha : score());
+    }
+
+    Score alpha;
+    Score beta;
+    bool max_player;
+    int best;
     EvalType eval_type;
+  };
+
+  // A state whose successors, except for the first one, can be searched by
+  // any thread. It lives on the stack of the thread that owns the state, which
+  // waits until all the successors are searched.
+  struct SplitPoint {
+    SplitPoint(SplitPoint* parent, const std::vector<State>& successors,
+               const std::vector<int>& move_ids, const std::vector<int>& order,
+               int depth, int ply, const Window& window)
+        : parent(parent),
+          successors(successors),
+          move_ids(move_ids),
+          order(order),
+          depth(depth),
+          ply(ply),
+          window(window),
+          next(1),
+          active_threads(0),
+          cutoff(false) {}
+
+    // The split point under which the owner thread searches this state.
+    SplitPoint* const parent;
+    const std::vector<State>& successors;
+    const std::vector<int>& move_ids;
+    const std::vector<int>& order;
+    const int depth;
+    const int ply;
+
+    // The following members are guarded by |split_lock_|.
+    Window window;
+    // The position in |order| of the next successor that must be searched.
+    size_t next;
+    int active_threads;
+
+    // Set when the remaining successors can be pruned. All the searches that
+    // are still running below this split point are abandoned.
+    volatile bool cutoff;
+  };
+
+  // The successors of a state that is being searched, together with the data
+  // used to order them.
+  struct PlyBuffers {
     std::vector<State> successors;
+    std::vector<int> move_ids;
+    std::vector<int> order;
+
+    // The scores of the successors, if they are leaves.
+    std::vector<Score> leaf_scores;
   };
 
-  struct Hasher {
-    size_t operator()(const State& state) const {
-      return Hash<State>(state);
+  // The data that is specific to each of the threads that run a search.
+  struct SearchThread {
+    SearchThread(Delegate* delegate, bool is_helper, uint64_t seed)
+        : delegate(delegate),
+          is_helper(is_helper),
+          random(seed),
+          split_point(NULL),
+          root_depth(0),
+          leaf_score(NULL),
+          ordering(delegate->GetMoveCount()),
+          node_count(0),
+          statistics(NULL) {}
+
+    Delegate* delegate;
+
+    // Helper threads abandon their search as soon as the main search is over.
+    bool is_helper;
+
+    // Shuffles the successors searched by this thread.
+    base::XorShift64Star random;
+
+    // The split point whose successor is searched by this thread, if any.
+    SplitPoint* split_point;
+
+    // The depth of the current iteration of the search. The difference
+    // between this and the depth of a state is the distance from the root.
+    int root_depth;
+
+    // If not NULL, the score of the leaf that is searched next, which was
+    // already computed by |Delegate::EvaluateBatch()|.
+    const Score* leaf_score;
+
+    MoveOrdering ordering;
+    int64_t node_count;
+
+    // The statistics of the current iteration, if they are collected by this
+    // thread.
+    IterationStatistics* statistics;
+
+    // Returns the buffers used by the state at |ply|. At most one state from
+    // each ply is searched at any time by a thread, so the buffers are reused
+    // and the search does not allocate memory for each state. A deque is used
+    // since the split points keep references to the buffers while it grows.
+    PlyBuffers* GetPlyBuffers(int ply) {
+      DCHECK(ply >= 0);
+      while (ply_buffers.size() <= static_cast<size_t>(ply)) {
+        ply_buffers.push_back(PlyBuffers());
+      }
+      return &ply_buffers[ply];
     }
+
+    std::deque<PlyBuffers> ply_buffers;
   };
 
-  typedef base::hash_map<State,  // NOLINT(build/include_what_you_use)
-                         TransTableEntry, Hasher> TranspositionTable;
+  // Returns a new seed for the generator of a SearchThread.
+  uint64_t NextSeed() {
+    const uint64_t high = random_.Next();
+    return (high << 32) | random_.Next();
+  }
 
-  bool TimedOut() const {
-    const int sec_to_nano = 1000000000;
-    timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    timespec diff;
-    if (now.tv_nsec < start_time_.tv_nsec) {
-      diff.tv_sec = now.tv_sec - start_time_.tv_sec - 1;
-      diff.tv_nsec = sec_to_nano + now.tv_nsec - start_time_.tv_nsec;
-    } else {
-      diff.tv_sec = now.tv_sec - start_time_.tv_sec;
-      diff.tv_nsec = now.tv_nsec - start_time_.tv_nsec;
+  // Creates the helper threads and starts their searches from |origin|.
+  void StartHelperThreads(const State& origin) {
+    if (helper_thread_count_ == 0) {
+      return;
+    }
+    origin_ = origin;
+    stop_helpers_.BitwiseAnd(0);
+    for (int i = 0; i < helper_thread_count_; ++i) {
+      Delegate* delegate = delegate_->CreateHelperDelegate();
+      DCHECK(delegate);
+      helpers_.push_back(new SearchThread(delegate, true, NextSeed()));
+      helper_threads_.push_back(
+          new base::threading::Thread("AlphaBeta helper " + base::ToString(i)));
+      helper_threads_.back()->Start();
+      if (parallel_search_mode_ == YOUNG_BROTHERS_WAIT) {
+        helper_threads_.back()->SubmitTask(FROM_HERE,
+            base::Bind(new base::Method<void(AlphaBeta::*)(int)>(
+                &AlphaBeta::RunSplitPointHelper), this, i));
+      } else {
+        helper_threads_.back()->SubmitTask(FROM_HERE,
+            base::Bind(new base::Method<void(AlphaBeta::*)(int)>(
+                &AlphaBeta::RunHelperSearch), this, i));
+      }
+    }
+  }
+
+  // Signals the helper threads to abandon their searches and waits for them.
+  void StopHelperThreads() {
+    if (helper_threads_.empty()) {
+      return;
+    }
+    stop_helpers_.BitwiseOr(1);
+    {
+      base::threading::ScopedGuard guard(&split_lock_);
+      split_condition_.Broadcast();
+    }
+    for (size_t i = 0; i < helper_threads_.size(); ++i) {
+      helper_threads_[i]->SubmitQuitTaskAndJoin();
+      delete helper_threads_[i];
+      node_count_ += helpers_[i]->node_count;
+      delete helpers_[i]->delegate;
+      delete helpers_[i];
+    }
+    helper_threads_.clear();
+    helpers_.clear();
+  }
+
+  // The iterative deepening search performed by each helper thread in the
+  // SHARED_TRANSPOSITION_TABLE mode. Odd helpers start at the same depth as
+  // the main thread and even ones start one level deeper, so that the threads
+  // do not search the same tree in lockstep.
+  void RunHelperSearch(int helper_index) {
+    const Score min_infinity = std::numeric_limits<Score>::min();
+    const Score max_infinity = std::numeric_limits<Score>::max();
+    SearchThread* thread = helpers_[helper_index];
+    int best_move = 0;
+    for (int depth = 1 + (helper_index + 1) % 2;
+         depth <= max_search_depth_ && !IsStopped(*thread); ++depth) {
+      thread->root_depth = depth;
+      Search(thread, origin_, depth, min_infinity, max_infinity, true,
+             &best_move);
+    }
+  }
+
+  // The loop performed by each helper thread in the YOUNG_BROTHERS_WAIT mode.
+  // The helper waits for split points and searches their successors until the
+  // main search is over.
+  void RunSplitPointHelper(int helper_index) {
+    SearchThread* thread = helpers_[helper_index];
+    base::threading::ScopedGuard guard(&split_lock_);
+    while (!stop_helpers_.Get()) {
+      if (!SearchSplitPointSuccessor(thread, NULL)) {
+        split_condition_.Wait();
+      }
     }
-    if (diff.tv_nsec > max_search_time_) {
+  }
+
+  // Searches the tree rooted at |origin| using a window centered in the
+  // |previous_score| found by the previous iteration. The window is doubled in
+  // the direction in which the search failed until the score falls inside it.
+  Score AspirationSearch(SearchThread* thread, const State& origin, int depth,
+                         Score previous_score, int* best_move) {
+    const Score min_infinity = std::numeric_limits<Score>::min();
+    const Score max_infinity = std::numeric_limits<Score>::max();
+    Score low_delta = aspiration_window_;
+    Score high_delta = aspiration_window_;
+    while (true) {
+      const Score alpha = previous_score < min_infinity + low_delta ?
+          min_infinity : previous_score - low_delta;
+      const Score beta = max_infinity - high_delta < previous_score ?
+          max_infinity : previous_score + high_delta;
+      int move = *best_move;
+      const Score score =
+          Search(thread, origin, depth, alpha, beta, true, &move);
+      if (IsStopped(*thread)) {
+        return previous_score;
+      }
+      if (score <= alpha && !(alpha == min_infinity)) {
+        low_delta = Widen(low_delta);
+      } else if (beta <= score && !(beta == max_infinity)) {
+        high_delta = Widen(high_delta);
+      } else {
+        *best_move = move;
+        return score;
+      }
+    }
+  }
+
+  // Returns the size of an aspiration window after it is doubled.
+  static Score Widen(Score delta) {
+    const Score max_infinity = std::numeric_limits<Score>::max();
+    return max_infinity - delta < delta ? max_infinity : delta + delta;
+  }
+
+  // Searches the |successor| of a state whose bounds are given by |window|.
+  // With PVS, all the successors except for the |first| one are first
+  // searched with a null window, and they are searched again with the full
+  // window only if they improve the bounds of the state.
+  Score SearchSuccessor(SearchThread* thread, const State& successor,
+                        int depth, const Window& window, bool first) {
+    if (thread->statistics) {
+      ++thread->statistics->searched_successors;
+    }
+    if (pvs_ && !first) {
+      Score score;
+      if (window.max_player) {
+        score = Search(thread, successor, depth - 1, window.alpha,
+                       window.alpha + 1, false);
+      } else {
+        score = Search(thread, successor, depth - 1, window.beta - 1,
+                       window.beta, true);
+      }
+      if (score <= window.alpha || window.beta <= score ||
+          IsStopped(*thread)) {
+        return score;
+      }
+    }
+    return Search(thread, successor, depth - 1, window.alpha, window.beta,
+                  !window.max_player);
+  }
+
+  // Returns |true| if |thread| must abandon its search. The partial results
+  // of an abandoned search must not be stored in the transposition table.
+  bool IsStopped(const SearchThread& thread) const {
+    if (search_aborted_.Get()) {
+      return true;
+    }
+    if (thread.is_helper && stop_helpers_.Get()) {
       return true;
     }
-    return (max_search_time_ - diff.tv_nsec) / float(sec_to_nano) < diff.tv_sec;
+    for (const SplitPoint* split_point = thread.split_point; split_point;
+         split_point = split_point->parent) {
+      if (split_point->cutoff) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns |true| if the successors of a state, except for the first one,
+  // should be searched in parallel.
+  bool ShouldSplit(int depth, size_t successor_count) const {
+    return parallel_search_mode_ == YOUNG_BROTHERS_WAIT &&
+           !helper_threads_.empty() &&
+           depth >= kMinSplitDepth &&
+           successor_count > 1;
+  }
+
+  // Searches the successors of a state, except for the first one which was
+  // already searched, together with the idle helper threads. The bounds of the
+  // state are updated in |window|.
+  void SearchSplitPoint(SearchThread* thread,
+                        const std::vector<State>& successors,
+                        const std::vector<int>& move_ids,
+                        const std::vector<int>& order,
+                        int depth,
+                        Window* window) {
+    SplitPoint split_point(thread->split_point, successors, move_ids, order,
+                           depth, thread->root_depth - depth, *window);
+    base::threading::ScopedGuard guard(&split_lock_);
+    split_points_.push_back(&split_point);
+    split_condition_.Broadcast();
+    // While the other threads are searching successors of this split point,
+    // the owner helps them with the split points below it, so that it does
+    // not wait for them idly.
+    while (split_point.next < order.size() ||
+           split_point.active_threads > 0) {
+      if (!SearchSplitPointSuccessor(thread, &split_point)) {
+        split_condition_.Wait();
+      }
+    }
+    RemoveSplitPoint(&split_point);
+    *window = split_point.window;
+  }
+
+  // Searches one of the successors from a split point that is either
+  // |ancestor| or one of its descendants. If |ancestor| is NULL, any split
+  // point can be used. Returns |false| if there is no such successor left.
+  // Must be called with |split_lock_| acquired, but the lock is released
+  // while the successor is searched.
+  bool SearchSplitPointSuccessor(SearchThread* thread, SplitPoint* ancestor) {
+    SplitPoint* split_point = NULL;
+    for (size_t i = 0; i < split_points_.size() && !split_point; ++i) {
+      for (SplitPoint* p = split_points_[i]; p; p = p->parent) {
+        if (p == ancestor || !ancestor) {
+          split_point = split_points_[i];
+          break;
+        }
+      }
+    }
+    if (!split_point) {
+      return false;
+    }
+    const int index = split_point->order[split_point->next++];
+    if (split_point->next == split_point->order.size()) {
+      RemoveSplitPoint(split_point);
+    }
+    const Window window = split_point->window;
+    ++split_point->active_threads;
+    SplitPoint* const previous_split_point = thread->split_point;
+    const int previous_root_depth = thread->root_depth;
+    thread->split_point = split_point;
+    thread->root_depth = split_point->depth + split_point->ply;
+    split_lock_.Release();
+    const Score score = SearchSuccessor(thread, split_point->successors[index],
+                                        split_point->depth, window, false);
+    const bool stopped = IsStopped(*thread);
+    thread->split_point = previous_split_point;
+    thread->root_depth = previous_root_depth;
+    split_lock_.Acquire();
+    if (!stopped && split_point->window.Update(score, index)) {
+      thread->ordering.RecordCutoff(split_point->move_ids[index],
+                                    split_point->ply, split_point->depth);
+      split_point->cutoff = true;
+      split_point->next = split_point->order.size();
+      RemoveSplitPoint(split_point);
+    }
+    --split_point->active_threads;
+    split_condition_.Broadcast();
+    return true;
+  }
+
+  // Removes |split_point| from the list of split points that have successors
+  // which were not searched yet. Must be called with |split_lock_| acquired.
+  void RemoveSplitPoint(SplitPoint* split_point) {
+    split_points_.erase(
+        std::remove(split_points_.begin(), split_points_.end(), split_point),
+        split_points_.end());
+  }
+
+  // Returns the number of nanoseconds elapsed since the search started, or
+  // since the last ponder hit.
+  int64_t GetElapsedTime() const {
+    return base::GetMonotonicTime() - start_time_.Get();
+  }
+
+  bool TimedOut() const {
+    return GetElapsedTime() > max_search_time_;
+  }
+
+  // Returns |true| if the search must stop because one of the time and node
+  // limits was exceeded. See |NodeBudgetExceeded()| for |node_count|.
+  bool LimitsExceeded(int64_t node_count) const {
+    if (pondering_.Get()) {
+      return false;
+    }
+    return TimedOut() || NodeBudgetExceeded(node_count);
+  }
+
+  // Fills |variation| with the states along the best line of play from
+  // |origin|, which has the successor given by |best_move| as the best one,
+  // by following the best moves stored in the transposition table.
+  void GetPrincipalVariation(const State& origin, int best_move, int depth,
+                             std::vector<State>* variation) const {
+    std::vector<State> successors;
+    delegate_->GetSuccessors(origin, &successors);
+    DCHECK_LT(static_cast<size_t>(best_move), successors.size());
+    variation->push_back(successors[best_move]);
+    while (static_cast<int>(variation->size()) < depth) {
+      const State& state = variation->back();
+      TransTableEntry entry;
+      if (delegate_->IsTerminal(state) ||
+          !trans_table_->Probe(delegate_->GetTranspositionKey(state),
+                               &entry)) {
+        break;
+      }
+      successors.clear();
+      delegate_->GetSuccessors(state, &successors);
+      if (static_cast<size_t>(entry.best_move) >= successors.size()) {
+        break;
+      }
+      variation->push_back(successors[entry.best_move]);
+    }
+  }
+
+  // Returns |true| if the search visited at least |max_node_count_| states.
+  // The states visited by the helper threads are only known with a precision
+  // of |kNodesPerLimitCheck| states, so without helpers the exact number of
+  // states visited by the calling thread, |node_count|, is used instead.
+  bool NodeBudgetExceeded(int64_t node_count) const {
+    if (max_node_count_ == 0) {
+      return false;
+    }
+    if (helper_threads_.empty()) {
+      return node_count >= max_node_count_;
+    }
+    return shared_node_count_.Get() >= max_node_count_;
+  }
+
+  // Called by each thread after it visits |kNodesPerLimitCheck| states.
+  // Aborts the search of all the threads if one of the limits was exceeded
+  // after the first iteration of the main thread was completed.
+  void CheckSearchLimits(const SearchThread& thread) {
+    shared_node_count_.Add(kNodesPerLimitCheck);
+    if (!limits_enabled_.Get()) {
+      return;
+    }
+    if (LimitsExceeded(thread.node_count)) {
+      search_aborted_.BitwiseOr(1);
+    }
   }
 
   // Checks if a state was already evaluated and stored in the transposition
@@ -193,93 +975,231 @@ class AlphaBeta {
     return false;
   }
 
-  // Update the transposition table entry for |state|. If there is no entry for
-  // this state, a new one will be created.
-  void Update(const State& state, int depth, Score score, EvalType eval_type,
-      std::vector<State> successors = std::vector<State>()) {
-    TransTableEntry& entry = trans_table_[state];
+  // Update the transposition table entry for the state identified by |key|.
+  // If there is no entry for this state, a new one will be created.
+  void Update(uint64_t key, int depth, Score score, EvalType eval_type,
+      int best_move = TranspositionTable<Score>::kNoBestMove) {
+    TransTableEntry entry;
     entry.depth = depth;
     entry.eval_type = eval_type;
     entry.score = score;
-    entry.successors = successors;
+    entry.best_move = best_move;
+    trans_table_->Store(key, entry);
+  }
+
+  // Counts the visit of |thread| to a state. The search limits are checked
+  // after every |kNodesPerLimitCheck| visits.
+  void CountNode(SearchThread* thread) {
+    if (++thread->node_count % kNodesPerLimitCheck == 0) {
+      CheckSearchLimits(*thread);
+    }
+  }
+
+  // Searches the noisy successors of |state|, which is at the maximum depth
+  // of the search or below it, for at most |depth| levels. The player to move
+  // can also stand pat, so the score is never worse for it than the static
+  // evaluation of |state|. |ply| is the distance from the root of the search.
+  Score Quiescence(SearchThread* thread, const State& state, int depth,
+                   int ply, Score alpha, Score beta, bool max_player) {
+    Delegate* const delegate = thread->delegate;
+    // Terminal states must be checked first, since the delegate can use the
+    // check to compute their score.
+    const bool terminal = delegate->IsTerminal(state);
+    const Score stand_pat = delegate->Evaluate(state);
+    if (terminal || depth == 0) {
+      return stand_pat;
+    }
+    Window window(alpha, beta, max_player,
+                  TranspositionTable<Score>::kNoBestMove);
+    if (window.Update(stand_pat, TranspositionTable<Score>::kNoBestMove)) {
+      return window.score();
+    }
+    PlyBuffers* const buffers = thread->GetPlyBuffers(ply);
+    const std::vector<State>& successors = buffers->successors;
+    buffers->successors.clear();
+    delegate->GetNoisySuccessors(state, &buffers->successors);
+    for (size_t i = 0; i < successors.size(); ++i) {
+      CountNode(thread);
+      if (thread->statistics) {
+        ++thread->statistics->quiescence_node_count;
+      }
+      if (IsStopped(*thread)) {
+        break;
+      }
+      const Score score = Quiescence(thread, successors[i], depth - 1,
+                                     ply + 1, window.alpha, window.beta,
+                                     !max_player);
+      if (IsStopped(*thread) || window.Update(score, i)) {
+        break;
+      }
+    }
+    return window.score();
   }
 
   // The core of the Alpha Beta Pruning search algorithm. For more details read
   // http://en.wikipedia.org/wiki/Alpha-beta_pruning.
-  Score Search(const State& state, int depth, Score alpha, Score beta,
-               bool max_player) {
-    typename TranspositionTable::const_iterator it = trans_table_.find(state);
-    if (it != trans_table_.end()) {
+  // If |best_move| is not NULL, |state| is the root of the search. In this case
+  // the transposition table is only used for move ordering and the index of the
+  // best successor is stored in |best_move|.
+  Score Search(SearchThread* thread, const State& state, int depth,
+               Score alpha, Score beta, bool max_player,
+               int* best_move = NULL) {
+    if (IsStopped(*thread)) {
+      return alpha;
+    }
+    CountNode(thread);
+    if (IsStopped(*thread)) {
+      return alpha;
+    }
+    Delegate* const delegate = thread->delegate;
+    const uint64_t key = delegate->GetTranspositionKey(state);
+    TransTableEntry entry;
+    const bool found = trans_table_->Probe(key, &entry);
+    IterationStatistics* const statistics = thread->statistics;
+    if (statistics) {
+      ++(found ? statistics->tt_hits : statistics->tt_misses);
+    }
+    if (found && !best_move) {
       Score score;
-      if (GetFromTranspositionTable(it->second, depth, alpha, beta, &score)) {
+      if (GetFromTranspositionTable(entry, depth, alpha, beta, &score)) {
+        if (statistics) {
+          ++statistics->tt_cutoffs;
+        }
+        return score;
+      }
+    }
+    if (depth == 0 && quiescence_depth_ > 0) {
+      const Score score = Quiescence(thread, state, quiescence_depth_,
+                                     thread->root_depth, alpha, beta,
+                                     max_player);
+      if (IsStopped(*thread)) {
         return score;
       }
+      Update(key, depth, score,
+             score <= alpha ? ALPHA : (beta <= score ? BETA : EXACT));
+      return score;
     }
-    if (depth == 0 || delegate_->IsTerminal(state)) {
-      Score score = delegate_->Evaluate(state);
-      Update(state, depth, score, EXACT);
+    if (depth == 0 || delegate->IsTerminal(state)) {
+      Score score = thread->leaf_score ? *thread->leaf_score :
+                                         delegate->Evaluate(state);
+      Update(key, depth, score, EXACT);
       return score;
     }
-    std::vector<State> successors;
-    if (it != trans_table_.end() && !it->second.successors.empty()) {
-      successors = it->second.successors;
-    } else {
-      delegate_->GetSuccessors(state, &successors);
+    const int ply = thread->root_depth - depth;
+    PlyBuffers* const buffers = thread->GetPlyBuffers(ply);
+    const std::vector<State>& successors = buffers->successors;
+    const std::vector<int>& move_ids = buffers->move_ids;
+    const std::vector<int>& order = buffers->order;
+    buffers->successors.clear();
+    delegate->GetSuccessors(state, &buffers->successors);
+    DCHECK(!successors.empty());
+    if (statistics) {
+      ++statistics->expanded_states;
+    }
+    buffers->move_ids.resize(successors.size());
+    for (size_t i = 0; i < successors.size(); ++i) {
+      buffers->move_ids[i] = delegate->GetMoveId(state, successors[i]);
+    }
+    // The order in which the successors are searched. The successors that
+    // are equally likely to cause a cutoff are shuffled.
+    buffers->order.resize(successors.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      buffers->order[i] = i;
     }
     if (shuffle_) {
-      DCHECK(!successors.empty());
-      std::random_shuffle(successors.begin() + 1, successors.end());
-    }
-    if (max_player) {
-      EvalType eval_type = ALPHA;
-      for (size_t i = 0; i < successors.size(); ++i) {
-        Score s = Search(successors[i], depth - 1, alpha, beta, !max_player);
-        if (alpha < s) {
-          alpha = s;
-          std::swap(successors[i], successors[0]);
-          eval_type = EXACT;
-        }
-        if (beta <= alpha) {
-          eval_type = BETA;
-          Update(state, depth, beta, BETA, successors);
-          break;
-        }
+      for (size_t i = buffers->order.size(); i > 1; --i) {
+        std::swap(buffers->order[i - 1],
+                  buffers->order[thread->random.NextBelow(i)]);
       }
-      if (eval_type != BETA) {
-        Update(state, depth, alpha, eval_type, successors);
-      }
-      return alpha;
     }
-    EvalType eval_type = BETA;
-    for (size_t i = 0; i < successors.size(); ++i) {
-      Score s = Search(successors[i], depth - 1, alpha, beta, !max_player);
-      if (s < beta) {
-        beta = s;
-        std::swap(successors[i], successors[0]);
-        eval_type = EXACT;
+    int hash_move = -1;
+    if (found && static_cast<size_t>(entry.best_move) < successors.size()) {
+      hash_move = entry.best_move;
+    }
+    thread->ordering.Sort(move_ids, hash_move, ply, &buffers->order);
+    // The successors of a frontier state are leaves, so they are evaluated
+    // together before they are searched.
+    bool frontier = false;
+    if (depth == 1 && quiescence_depth_ == 0) {
+      buffers->leaf_scores.resize(successors.size());
+      frontier = delegate->EvaluateBatch(&successors[0], successors.size(),
+                                         &buffers->leaf_scores[0]);
+    }
+    Window window(alpha, beta, max_player, order[0]);
+    for (size_t i = 0; i < order.size(); ++i) {
+      if (i == 1 && ShouldSplit(depth, order.size())) {
+        SearchSplitPoint(thread, successors, move_ids, order, depth, &window);
+        break;
       }
-      if (beta < alpha || beta == alpha) {
-        eval_type = ALPHA;
-        Update(state, depth, alpha, ALPHA, successors);
+      if (frontier) {
+        thread->leaf_score = &buffers->leaf_scores[order[i]];
+      }
+      Score s =
+          SearchSuccessor(thread, successors[order[i]], depth, window, i == 0);
+      thread->leaf_score = NULL;
+      if (IsStopped(*thread)) {
+        return window.score();
+      }
+      if (window.Update(s, order[i])) {
+        thread->ordering.RecordCutoff(move_ids[order[i]], ply, depth);
         break;
       }
     }
-    if (eval_type != ALPHA) {
-      Update(state, depth, beta, eval_type, successors);
+    if (IsStopped(*thread)) {
+      return window.score();
     }
-    return beta;
+    Update(key, depth, window.stored_score(), window.eval_type, window.best);
+    if (best_move) {
+      *best_move = window.best;
+    }
+    return window.score();
   };
 
   base::ptr::scoped_ptr<Delegate> delegate_;
-  unsigned int max_search_time_;
+  int64_t max_search_time_;
   int max_search_depth_;
+  int64_t max_node_count_;
   bool shuffle_;
-  TranspositionTable trans_table_;
-  timespec start_time_;
+  base::XorShift64Star random_;
+  bool pvs_;
+  Score aspiration_window_;
+  int quiescence_depth_;
+  int helper_thread_count_;
+  ParallelSearchMode parallel_search_mode_;
+  int64_t node_count_;
+  std::vector<IterationStatistics>* statistics_;
+  base::ptr::scoped_ptr<TranspositionTable<Score> > owned_trans_table_;
+  TranspositionTable<Score>* trans_table_;
+
+  // The limits of the search, which are checked by all the threads.
+  // |shared_node_count_| is increased by each thread after it visits
+  // |kNodesPerLimitCheck| states. The limits are only enforced after the
+  // first iteration is completed, so that the search always finds a move.
+  // These can also be changed by the threads that call |PonderHit()| and
+  // |Stop()|.
+  base::threading::Atomic<int64_t> start_time_;
+  base::threading::Atomic<int64_t> shared_node_count_;
+  base::threading::Atomic<int> limits_enabled_;
+  base::threading::Atomic<int> search_aborted_;
+  base::threading::Atomic<int> pondering_;
+
+  // The state of the search shared with the helper threads.
+  State origin_;
+  std::vector<SearchThread*> helpers_;
+  std::vector<base::threading::Thread*> helper_threads_;
+  base::threading::Atomic<int> stop_helpers_;
+
+  // The split points whose successors can be searched by any thread.
+  std::vector<SplitPoint*> split_points_;
+  base::threading::Lock split_lock_;
+  base::threading::ConditionVariable split_condition_;
 
   DISALLOW_COPY_AND_ASSIGN(AlphaBeta);
 };
 
+template <class State, class Score>
+const int AlphaBeta<State, Score>::kNodesPerLimitCheck;
+
 // Template specializations that explicitly deny the use of |float| and |double|
 // as scoring types, since the values returned by std::numeric_limits::min() are
 // not OK from the algorithm's point of view.
@@ -2,12 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+
 #include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "ai/alphabeta/alphabeta.h"
 #include "base/basic_macros.h"
+#include "base/time_util.h"
 #include "gtest/gtest.h"
 
 namespace ai {
@@ -103,11 +107,88 @@ class TestDelegate : public AlphaBeta<int>::Delegate {
     successors->insert(successors->end(), children.begin(), children.end());
   }
 
+  virtual AlphaBeta<int>::Delegate* CreateHelperDelegate() {
+    return new TestDelegate();
+  }
+
   std::map<int, std::vector<int> > children_;
   std::map<int, int> scores_;
   std::set<int> visited_states_;
 };
 
+// An abstract game in which each state has the same number of successors and
+// the scores are pseudo-random, so the game tree can be searched at any depth.
+const int kBranchingFactor = 4;
+
+class UniformTreeDelegate : public AlphaBeta<int>::Delegate {
+ public:
+  UniformTreeDelegate() {}
+
+ private:
+  virtual bool IsTerminal(const int& state) { return false; }
+
+  virtual int Evaluate(const int& state) {
+    return (static_cast<unsigned int>(state) * 2654435761U >> 16) % 100;
+  }
+
+  virtual void GetSuccessors(const int& state, std::vector<int>* successors) {
+    for (int i = 1; i <= kBranchingFactor; ++i) {
+      successors->push_back((state * kBranchingFactor + i) & 0xFFFFFF);
+    }
+  }
+
+  virtual AlphaBeta<int>::Delegate* CreateHelperDelegate() {
+    return new UniformTreeDelegate();
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(UniformTreeDelegate);
+};
+
+// A game in which the static evaluation of the successors of the root is
+// misleading. After the move to state 1, the opponent can win a lot (state 3),
+// but then the max player can win even more (state 5). After the move to
+// state 2, the opponent can only make a losing noisy move (state 4). All the
+// other moves are quiet and are not needed by the tests.
+class QuiescenceTestDelegate : public AlphaBeta<int>::Delegate {
+ public:
+  QuiescenceTestDelegate() {
+    noisy_children_[1].push_back(3);
+    noisy_children_[2].push_back(4);
+    noisy_children_[3].push_back(5);
+    scores_[1] = 10;
+    scores_[2] = 5;
+    scores_[3] = -20;
+    scores_[4] = 50;
+    scores_[5] = 100;
+  }
+
+ private:
+  virtual bool IsTerminal(const int& state) { return false; }
+
+  virtual int Evaluate(const int& state) { return scores_[state]; }
+
+  virtual void GetSuccessors(const int& state, std::vector<int>* successors) {
+    ASSERT_EQ(0, state);
+    successors->push_back(1);
+    successors->push_back(2);
+  }
+
+  virtual void GetNoisySuccessors(const int& state,
+                                  std::vector<int>* successors) {
+    const std::vector<int>& children = noisy_children_[state];
+    successors->insert(successors->end(), children.begin(), children.end());
+  }
+
+  virtual AlphaBeta<int>::Delegate* CreateHelperDelegate() {
+    return new QuiescenceTestDelegate();
+  }
+
+  std::map<int, std::vector<int> > noisy_children_;
+  std::map<int, int> scores_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuiescenceTestDelegate);
+};
+
 TEST(AlphaBeta, AbstractGame) {
   const int v[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 11, 12, 13, 14, 15, 16, 19,
                     20, 21, 22, 24, 25, 26, 28, 29 };
@@ -120,6 +201,190 @@ TEST(AlphaBeta, AbstractGame) {
   EXPECT_EQ(expected_visited_states, delegate->visited_states());
 }
 
+TEST(AlphaBeta, SharedTranspositionTable) {
+  const int kRoot = 0;
+  TranspositionTable<int> trans_table(1 << 16);
+  TestDelegate* first_delegate = new TestDelegate();
+  AlphaBeta<int> first_search(
+      std::auto_ptr<AlphaBeta<int>::Delegate>(first_delegate), &trans_table);
+  first_search.set_shuffling_enabled(false);
+  first_search.set_max_search_depth(4);
+  EXPECT_EQ(2, first_search.GetBestSuccessor(kRoot));
+  // The second search only has to expand the root, since the results for all
+  // its successors are already stored in the table.
+  TestDelegate* second_delegate = new TestDelegate();
+  AlphaBeta<int> second_search(
+      std::auto_ptr<AlphaBeta<int>::Delegate>(second_delegate), &trans_table);
+  second_search.set_shuffling_enabled(false);
+  second_search.set_max_search_depth(4);
+  EXPECT_EQ(2, second_search.GetBestSuccessor(kRoot));
+  EXPECT_EQ(std::set<int>(&kRoot, &kRoot + 1),
+            second_delegate->visited_states());
+}
+
+TEST(AlphaBeta, HelperThreads) {
+  TestDelegate* delegate = new TestDelegate();
+  AlphaBeta<int> alpha_beta(
+      (std::auto_ptr<AlphaBeta<int>::Delegate>(delegate)));
+  alpha_beta.set_max_search_depth(4);
+  alpha_beta.set_helper_thread_count(4);
+  EXPECT_EQ(4, alpha_beta.helper_thread_count());
+  // The helper threads can only change the order in which the states are
+  // searched, not the result.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(2, alpha_beta.GetBestSuccessor(0));
+  }
+}
+
+TEST(AlphaBeta, YoungBrothersWait) {
+  TestDelegate* delegate = new TestDelegate();
+  AlphaBeta<int> alpha_beta(
+      (std::auto_ptr<AlphaBeta<int>::Delegate>(delegate)));
+  alpha_beta.set_max_search_depth(4);
+  alpha_beta.set_helper_thread_count(4);
+  alpha_beta.set_parallel_search_mode(YOUNG_BROTHERS_WAIT);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(2, alpha_beta.GetBestSuccessor(0));
+    EXPECT_LT(0, alpha_beta.node_count());
+  }
+}
+
+TEST(AlphaBeta, PrincipalVariationSearchAndAspirationWindows) {
+  for (int i = 0; i < 4; ++i) {
+    AlphaBeta<int> alpha_beta(
+        std::auto_ptr<AlphaBeta<int>::Delegate>(new TestDelegate()));
+    alpha_beta.set_shuffling_enabled(false);
+    alpha_beta.set_max_search_depth(4);
+    alpha_beta.set_pvs_enabled(i & 1);
+    alpha_beta.set_aspiration_window(i & 2);
+    EXPECT_EQ(2, alpha_beta.GetBestSuccessor(0));
+  }
+}
+
+TEST(AlphaBeta, Statistics) {
+  const int kMaxDepth = 4;
+  AlphaBeta<int> alpha_beta(
+      std::auto_ptr<AlphaBeta<int>::Delegate>(new TestDelegate()));
+  alpha_beta.set_shuffling_enabled(false);
+  alpha_beta.set_max_search_depth(kMaxDepth);
+  std::vector<AlphaBeta<int>::IterationStatistics> statistics;
+  alpha_beta.set_statistics(&statistics);
+  EXPECT_EQ(2, alpha_beta.GetBestSuccessor(0));
+  ASSERT_EQ(static_cast<size_t>(kMaxDepth), statistics.size());
+  int64_t node_count = 0;
+  for (int i = 0; i < kMaxDepth; ++i) {
+    EXPECT_EQ(i + 1, statistics[i].depth);
+    EXPECT_EQ(statistics[i].node_count,
+              statistics[i].tt_hits + statistics[i].tt_misses);
+    EXPECT_LE(statistics[i].tt_cutoffs, statistics[i].tt_hits);
+    EXPECT_LT(0, statistics[i].expanded_states);
+    EXPECT_LE(1.0, statistics[i].branching_factor());
+    node_count += statistics[i].node_count;
+  }
+  EXPECT_EQ(alpha_beta.node_count(), node_count);
+  EXPECT_EQ(6, statistics.back().score);
+  const int pv[] = { 2, 6, 13, 25 };
+  EXPECT_EQ(std::vector<int>(pv, pv + arraysize(pv)),
+            statistics.back().principal_variation);
+  // The statistics are replaced by the next search.
+  alpha_beta.set_max_search_depth(2);
+  alpha_beta.GetBestSuccessor(0);
+  EXPECT_EQ(2U, statistics.size());
+}
+
+TEST(AlphaBeta, Quiescence) {
+  // The expected best successor and its score for each quiescence depth.
+  const int expected_successors[] = { 1, 2, 1, 1 };
+  const int expected_scores[] = { 10, 5, 10, 10 };
+  // The quiescence nodes visited by the search of each depth. Starting with
+  // depth 2, the stand pat of the opponent in state 2 is enough to prune it,
+  // so state 4 is only visited by the search of depth 1.
+  const int expected_node_counts[] = { 0, 2, 2, 2 };
+  for (size_t depth = 0; depth < arraysize(expected_successors); ++depth) {
+    AlphaBeta<int> alpha_beta(
+        std::auto_ptr<AlphaBeta<int>::Delegate>(new QuiescenceTestDelegate()));
+    alpha_beta.set_shuffling_enabled(false);
+    alpha_beta.set_max_search_depth(1);
+    alpha_beta.set_quiescence_depth(depth);
+    std::vector<AlphaBeta<int>::IterationStatistics> statistics;
+    alpha_beta.set_statistics(&statistics);
+    EXPECT_EQ(expected_successors[depth], alpha_beta.GetBestSuccessor(0));
+    ASSERT_EQ(1U, statistics.size());
+    EXPECT_EQ(expected_scores[depth], statistics[0].score);
+    EXPECT_EQ(expected_node_counts[depth],
+              statistics[0].quiescence_node_count);
+  }
+}
+
+TEST(AlphaBeta, NodeBudget) {
+  const int kMaxDepth = 12;
+  const int64_t kMaxNodeCount = 10000;
+  // The results of the iterations that the budgeted search can complete.
+  std::set<int> depth_limited_results;
+  for (int depth = 1; depth <= kMaxDepth; ++depth) {
+    AlphaBeta<int> alpha_beta(
+        std::auto_ptr<AlphaBeta<int>::Delegate>(new UniformTreeDelegate()));
+    alpha_beta.set_shuffling_enabled(false);
+    alpha_beta.set_max_search_depth(depth);
+    depth_limited_results.insert(alpha_beta.GetBestSuccessor(0));
+  }
+  AlphaBeta<int> alpha_beta(
+      std::auto_ptr<AlphaBeta<int>::Delegate>(new UniformTreeDelegate()));
+  alpha_beta.set_shuffling_enabled(false);
+  alpha_beta.set_max_search_depth(kMaxDepth);
+  alpha_beta.set_max_node_count(kMaxNodeCount);
+  const int best_successor = alpha_beta.GetBestSuccessor(0);
+  EXPECT_LE(kMaxNodeCount, alpha_beta.node_count());
+  EXPECT_GE(kMaxNodeCount + AlphaBeta<int>::kNodesPerLimitCheck,
+            alpha_beta.node_count());
+  // The incomplete iteration is discarded.
+  EXPECT_EQ(1U, depth_limited_results.count(best_successor));
+}
+
+TEST(AlphaBeta, TimeLimit) {
+  const int64_t kMaxSearchTime = 20000000;  // 20 milliseconds
+  for (int helper_thread_count = 0; helper_thread_count <= 2;
+       helper_thread_count += 2) {
+    AlphaBeta<int> alpha_beta(
+        std::auto_ptr<AlphaBeta<int>::Delegate>(new UniformTreeDelegate()));
+    alpha_beta.set_max_search_time(kMaxSearchTime);
+    alpha_beta.set_helper_thread_count(helper_thread_count);
+    const int64_t start_time = base::GetMonotonicTime();
+    const int best_successor = alpha_beta.GetBestSuccessor(0);
+    const int64_t elapsed = base::GetMonotonicTime() - start_time;
+    EXPECT_LE(1, best_successor);
+    EXPECT_GE(kBranchingFactor, best_successor);
+    // There is no depth limit, so the search only stops because of the time
+    // limit, shortly after it expires.
+    EXPECT_LE(kMaxSearchTime, elapsed);
+    EXPECT_GT(50 * kMaxSearchTime, elapsed);
+  }
+}
+
+TEST(AlphaBeta, PonderingAndStop) {
+  const int kMaxDepth = 7;
+  AlphaBeta<int> alpha_beta(
+      std::auto_ptr<AlphaBeta<int>::Delegate>(new UniformTreeDelegate()));
+  alpha_beta.set_max_search_depth(kMaxDepth);
+  alpha_beta.set_max_node_count(1);
+  std::vector<AlphaBeta<int>::IterationStatistics> statistics;
+  alpha_beta.set_statistics(&statistics);
+  // The limits are ignored while pondering.
+  alpha_beta.set_pondering(true);
+  alpha_beta.GetBestSuccessor(0);
+  EXPECT_EQ(static_cast<size_t>(kMaxDepth), statistics.size());
+  // The limits are enforced after a ponder hit.
+  alpha_beta.PonderHit();
+  EXPECT_FALSE(alpha_beta.is_pondering());
+  alpha_beta.GetBestSuccessor(0);
+  EXPECT_EQ(1U, statistics.size());
+  // A search stopped before it starts does not complete any iteration.
+  alpha_beta.set_pondering(true);
+  alpha_beta.Stop();
+  alpha_beta.GetBestSuccessor(0);
+  EXPECT_TRUE(statistics.empty());
+}
+
 }  // anonymous namespace
 }  // namespace alphabeta
 }  // namespace ai
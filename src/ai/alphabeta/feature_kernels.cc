@@ -0,0 +1,195 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/alphabeta/feature_kernels.h"
+
+#include <stdint.h>
+
+#include "ai/bitboard.h"
+#include "base/log.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FEATURE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+// Indices of the weights.
+enum {
+  kMobilityWeight = 0,
+  kMaterialWeight = 1,
+  kMillsWeight = 2,
+  kWeightsPerPlayer = 3
+};
+
+// Scores the states from |begin| to the end of |batch|, one at a time.
+void ComputeScalar(const FeatureBatch& batch,
+                   const int* weights,
+                   int begin,
+                   int* scores) {
+  for (int i = begin; i < batch.count; ++i) {
+    int score = 0;
+    for (int p = 0; p < 2; ++p) {
+      const int* w = weights + p * kWeightsPerPlayer;
+      score += w[kMobilityWeight] * batch.mobility[p][i] +
+               w[kMaterialWeight] * PopCount(batch.pieces[p][i]) +
+               w[kMillsWeight] * batch.mills[p][i];
+    }
+    scores[i] = score;
+  }
+}
+
+#if defined(FEATURE_KERNELS_X86)
+
+// The SIMD kernels are compiled for their instruction sets with the target
+// attribute, so the rest of the code does not require them. They are only
+// called after the processor support is checked.
+
+// Scores four states at a time. SSE4.2 processors have the POPCNT
+// instruction, and SSE4.1 provides the 32-bit multiplication.
+__attribute__((target("sse4.2,popcnt")))
+void ComputeSse42(const FeatureBatch& batch, const int* weights, int* scores) {
+  __m128i w[2][kWeightsPerPlayer];
+  for (int p = 0; p < 2; ++p) {
+    for (int k = 0; k < kWeightsPerPlayer; ++k) {
+      w[p][k] = _mm_set1_epi32(weights[p * kWeightsPerPlayer + k]);
+    }
+  }
+  int i = 0;
+  for (; i + 4 <= batch.count; i += 4) {
+    __m128i score = _mm_setzero_si128();
+    for (int p = 0; p < 2; ++p) {
+      const uint32_t* pieces = batch.pieces[p] + i;
+      const __m128i material = _mm_setr_epi32(
+          _mm_popcnt_u32(pieces[0]), _mm_popcnt_u32(pieces[1]),
+          _mm_popcnt_u32(pieces[2]), _mm_popcnt_u32(pieces[3]));
+      const __m128i mobility = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(batch.mobility[p] + i));
+      const __m128i mills = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(batch.mills[p] + i));
+      score = _mm_add_epi32(score,
+                            _mm_mullo_epi32(mobility, w[p][kMobilityWeight]));
+      score = _mm_add_epi32(score,
+                            _mm_mullo_epi32(material, w[p][kMaterialWeight]));
+      score = _mm_add_epi32(score,
+                            _mm_mullo_epi32(mills, w[p][kMillsWeight]));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(scores + i), score);
+  }
+  ComputeScalar(batch, weights, i, scores);
+}
+
+// Scores eight states at a time. The population counts are computed with a
+// lookup table of the counts of all the nibbles, and the counts of the bytes
+// are summed to 32 bits by two multiply-add instructions.
+__attribute__((target("avx2")))
+void ComputeAvx2(const FeatureBatch& batch, const int* weights, int* scores) {
+  const __m256i nibble_counts = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+  const __m256i byte_ones = _mm256_set1_epi8(1);
+  const __m256i word_ones = _mm256_set1_epi16(1);
+  __m256i w[2][kWeightsPerPlayer];
+  for (int p = 0; p < 2; ++p) {
+    for (int k = 0; k < kWeightsPerPlayer; ++k) {
+      w[p][k] = _mm256_set1_epi32(weights[p * kWeightsPerPlayer + k]);
+    }
+  }
+  int i = 0;
+  for (; i + 8 <= batch.count; i += 8) {
+    __m256i score = _mm256_setzero_si256();
+    for (int p = 0; p < 2; ++p) {
+      const __m256i pieces = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(batch.pieces[p] + i));
+      const __m256i byte_counts = _mm256_add_epi8(
+          _mm256_shuffle_epi8(nibble_counts,
+                              _mm256_and_si256(pieces, low_nibbles)),
+          _mm256_shuffle_epi8(nibble_counts, _mm256_and_si256(
+              _mm256_srli_epi16(pieces, 4), low_nibbles)));
+      const __m256i material = _mm256_madd_epi16(
+          _mm256_maddubs_epi16(byte_counts, byte_ones), word_ones);
+      const __m256i mobility = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(batch.mobility[p] + i));
+      const __m256i mills = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(batch.mills[p] + i));
+      score = _mm256_add_epi32(
+          score, _mm256_mullo_epi32(mobility, w[p][kMobilityWeight]));
+      score = _mm256_add_epi32(
+          score, _mm256_mullo_epi32(material, w[p][kMaterialWeight]));
+      score = _mm256_add_epi32(
+          score, _mm256_mullo_epi32(mills, w[p][kMillsWeight]));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(scores + i), score);
+  }
+  ComputeScalar(batch, weights, i, scores);
+}
+
+#endif  // defined(FEATURE_KERNELS_X86)
+
+FeatureKernel SelectBestFeatureKernel() {
+  if (IsFeatureKernelSupported(AVX2_FEATURE_KERNEL)) {
+    return AVX2_FEATURE_KERNEL;
+  }
+  if (IsFeatureKernelSupported(SSE42_FEATURE_KERNEL)) {
+    return SSE42_FEATURE_KERNEL;
+  }
+  return SCALAR_FEATURE_KERNEL;
+}
+
+const FeatureKernel kBestFeatureKernel = SelectBestFeatureKernel();
+
+}  // anonymous namespace
+
+bool IsFeatureKernelSupported(FeatureKernel kernel) {
+#if defined(FEATURE_KERNELS_X86)
+  // This can be called before main(), so the processor information may not
+  // be initialized yet.
+  __builtin_cpu_init();
+  switch (kernel) {
+    case SCALAR_FEATURE_KERNEL:
+      return true;
+    case SSE42_FEATURE_KERNEL:
+      return __builtin_cpu_supports("sse4.2") &&
+             __builtin_cpu_supports("popcnt");
+    case AVX2_FEATURE_KERNEL:
+      return __builtin_cpu_supports("avx2");
+  }
+  NOTREACHED();
+  return false;
+#else
+  return kernel == SCALAR_FEATURE_KERNEL;
+#endif
+}
+
+FeatureKernel GetBestFeatureKernel() {
+  return kBestFeatureKernel;
+}
+
+void ComputeFeatureScores(const FeatureBatch& batch,
+                          const int* weights,
+                          int* scores,
+                          FeatureKernel kernel) {
+  DCHECK(batch.count >= 0 && batch.count <= kFeatureBatchSize);
+  DCHECK(IsFeatureKernelSupported(kernel));
+  switch (kernel) {
+#if defined(FEATURE_KERNELS_X86)
+    case AVX2_FEATURE_KERNEL:
+      ComputeAvx2(batch, weights, scores);
+      return;
+    case SSE42_FEATURE_KERNEL:
+      ComputeSse42(batch, weights, scores);
+      return;
+#endif
+    default:
+      ComputeScalar(batch, weights, 0, scores);
+      return;
+  }
+}
+
+}  // namespace alphabeta
+}  // namespace ai
@@ -0,0 +1,56 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_ALPHABETA_FEATURE_KERNELS_H_
+#define AI_ALPHABETA_FEATURE_KERNELS_H_
+
+#include <stdint.h>
+
+#include "ai/ai_export.h"
+
+namespace ai {
+namespace alphabeta {
+
+// The maximum number of states scored by one call of ComputeFeatureScores().
+const int kFeatureBatchSize = 64;
+
+// The features of the default evaluators for a batch of states, stored with
+// one array per feature so they can be processed with SIMD instructions. The
+// first index is 0 for the player whose score is computed and 1 for the
+// opponent. The material is given by the population count of |pieces|.
+struct FeatureBatch {
+  int count;
+  uint32_t pieces[2][kFeatureBatchSize];
+  int32_t mobility[2][kFeatureBatchSize];
+  int32_t mills[2][kFeatureBatchSize];
+};
+
+// The implementations of ComputeFeatureScores(). The SIMD ones are only
+// available on x86 processors that support the corresponding instructions.
+enum FeatureKernel {
+  SCALAR_FEATURE_KERNEL,
+  SSE42_FEATURE_KERNEL,
+  AVX2_FEATURE_KERNEL
+};
+
+// Returns true if |kernel| can be used on this processor.
+AI_EXPORT bool IsFeatureKernelSupported(FeatureKernel kernel);
+
+// Returns the fastest kernel supported by this processor. It is selected once,
+// before main().
+AI_EXPORT FeatureKernel GetBestFeatureKernel();
+
+// Stores in |scores| the weighted sum of the features of each state from
+// |batch|. The |weights| are given in the order of the default MorrisAlphaBeta
+// evaluators: the mobility, the material and the mills of the player,
+// followed by the same features of the opponent.
+AI_EXPORT void ComputeFeatureScores(const FeatureBatch& batch,
+                                    const int* weights,
+                                    int* scores,
+                                    FeatureKernel kernel);
+
+}  // namespace alphabeta
+}  // namespace ai
+
+#endif  // AI_ALPHABETA_FEATURE_KERNELS_H_
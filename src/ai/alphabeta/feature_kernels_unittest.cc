@@ -0,0 +1,74 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include "ai/alphabeta/feature_kernels.h"
+#include "ai/bitboard.h"
+#include "base/basic_macros.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+const int kWeights[] = { 3, 10, -7, -2, -10, 5 };
+
+// Fills |batch| with |count| states whose features are derived from |seed|.
+void FillBatch(int count, uint32_t seed, FeatureBatch* batch) {
+  batch->count = count;
+  for (int i = 0; i < count; ++i) {
+    for (int p = 0; p < 2; ++p) {
+      seed = seed * 1103515245U + 12345U;
+      batch->pieces[p][i] = seed & 0xffffff;
+      batch->mobility[p][i] = (seed >> 24) % 40;
+      batch->mills[p][i] = (seed >> 8) % 10;
+    }
+  }
+}
+
+TEST(FeatureKernels, ScalarKernel) {
+  EXPECT_TRUE(IsFeatureKernelSupported(SCALAR_FEATURE_KERNEL));
+  EXPECT_TRUE(IsFeatureKernelSupported(GetBestFeatureKernel()));
+  FeatureBatch batch;
+  FillBatch(1, 0, &batch);
+  batch.pieces[0][0] = BitAt(0) | BitAt(5) | BitAt(23);
+  batch.pieces[1][0] = BitAt(7);
+  batch.mobility[0][0] = 4;
+  batch.mobility[1][0] = 1;
+  batch.mills[0][0] = 0;
+  batch.mills[1][0] = 2;
+  int score = 0;
+  ComputeFeatureScores(batch, kWeights, &score, SCALAR_FEATURE_KERNEL);
+  EXPECT_EQ(3 * 4 + 10 * 3 - 2 * 1 - 10 * 1 + 5 * 2, score);
+}
+
+TEST(FeatureKernels, SimdKernels) {
+  const FeatureKernel kernels[] = {
+    SSE42_FEATURE_KERNEL, AVX2_FEATURE_KERNEL
+  };
+  // The sizes cover the full SIMD blocks and the remaining states.
+  const int counts[] = { 0, 1, 7, 8, 13, 33, kFeatureBatchSize };
+  for (size_t i = 0; i < arraysize(kernels); ++i) {
+    if (!IsFeatureKernelSupported(kernels[i])) {
+      continue;
+    }
+    for (size_t j = 0; j < arraysize(counts); ++j) {
+      FeatureBatch batch;
+      FillBatch(counts[j], j, &batch);
+      int expected_scores[kFeatureBatchSize];
+      int scores[kFeatureBatchSize];
+      ComputeFeatureScores(batch, kWeights, expected_scores,
+                           SCALAR_FEATURE_KERNEL);
+      ComputeFeatureScores(batch, kWeights, scores, kernels[i]);
+      for (int k = 0; k < counts[j]; ++k) {
+        EXPECT_EQ(expected_scores[k], scores[k]) << kernels[i] << " " << k;
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
+}  // namespace alphabeta
+}  // namespace ai
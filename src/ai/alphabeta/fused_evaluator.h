@@ -0,0 +1,166 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_ALPHABETA_FUSED_EVALUATOR_H_
+#define AI_ALPHABETA_FUSED_EVALUATOR_H_
+
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "base/basic_macros.h"
+#include "base/log.h"
+#include "game/piece_color.h"
+
+namespace ai {
+namespace alphabeta {
+
+// Interface of the heuristics that score a GameState directly, without
+// decoding it into a game::Board.
+class AI_EXPORT StateEvaluator {
+ public:
+  virtual ~StateEvaluator() {}
+
+  // Returns the score of |state| from the perspective of |player|.
+  virtual int Evaluate(const GameState& state,
+                       game::PieceColor player) const = 0;
+};
+
+// The data shared by the features while they visit the pieces of a state.
+struct FeatureContext {
+  FeatureContext(const BitboardLayout& layout, Bitboard empty)
+      : layout(layout), empty(empty) {}
+
+  const BitboardLayout& layout;
+  Bitboard empty;
+};
+
+// The features are classes with a static Visit() method, which is called once
+// for each piece on the board with the location |index| of the piece and the
+// set of |own| pieces of its owner. The value of a feature for a player is the
+// sum of the values returned for the pieces of that player. These features
+// compute the same values as the similar functions from evaluators.h.
+
+// The number of moves to adjacent empty locations.
+struct MobilityFeature {
+  static int Visit(const FeatureContext& context, Bitboard own, int index) {
+    return PopCount(context.layout.adjacency[index] & context.empty);
+  }
+};
+
+// The number of pieces on the board.
+struct MaterialFeature {
+  static int Visit(const FeatureContext& context, Bitboard own, int index) {
+    return 1;
+  }
+};
+
+// The number of pieces that are part of a closed mill.
+struct MillsFeature {
+  static int Visit(const FeatureContext& context, Bitboard own, int index) {
+    return IsPartOfMill(context.layout, own, index);
+  }
+};
+
+// A list of features, built as FeatureList<F1, FeatureList<F2, ...> >.
+struct NullFeatureList {
+  enum { kSize = 0 };
+};
+
+template <class Head, class Tail = NullFeatureList>
+struct FeatureList {
+  typedef Head HeadFeature;
+  typedef Tail TailList;
+  enum { kSize = 1 + Tail::kSize };
+};
+
+// The features used by the default MorrisAlphaBeta evaluators.
+typedef FeatureList<MobilityFeature,
+        FeatureList<MaterialFeature,
+        FeatureList<MillsFeature> > > DefaultFeatures;
+
+// Adds the values of all the |Features| for one piece to |values|. The
+// recursion is resolved at compile time, so the calls are inlined.
+template <class Features>
+struct FeatureVisitor {
+  static void Visit(const FeatureContext& context,
+                    Bitboard own,
+                    int index,
+                    int* values) {
+    values[0] += Features::HeadFeature::Visit(context, own, index);
+    FeatureVisitor<typename Features::TailList>::Visit(context, own, index,
+                                                       values + 1);
+  }
+};
+
+template <>
+struct FeatureVisitor<NullFeatureList> {
+  static void Visit(const FeatureContext& context,
+                    Bitboard own,
+                    int index,
+                    int* values) {}
+};
+
+// Evaluator that computes all the |Features| for both players in a single pass
+// over the pieces of the state. The score is the weighted sum of the features
+// of the player, followed by the same features of the opponent, so there are
+// 2 * Features::kSize weights, e.g. the weights of the default MorrisAlphaBeta
+// evaluators can be used with DefaultFeatures.
+template <class Features>
+class FusedEvaluator : public StateEvaluator {
+ public:
+  enum { kFeatureCount = Features::kSize };
+
+  explicit FusedEvaluator(const std::vector<int>& weights) {
+    DCHECK_EQ(weights.size(), static_cast<size_t>(2 * kFeatureCount));
+    for (int i = 0; i < 2 * kFeatureCount; ++i) {
+      weights_[i] = weights[i];
+    }
+  }
+
+  // Stores the values of the features of |player| in |values| and the ones of
+  // the opponent in |values| + kFeatureCount.
+  static void ComputeFeatures(const GameState& state,
+                              game::PieceColor player,
+                              int* values) {
+    for (int i = 0; i < 2 * kFeatureCount; ++i) {
+      values[i] = 0;
+    }
+    const FeatureContext context(state.layout(), state.empty_locations());
+    const Bitboard own[] = {
+      state.pieces(player), state.pieces(game::GetOpponent(player))
+    };
+    for (int i = 0; i < 2; ++i) {
+      Bitboard pieces = own[i];
+      while (pieces) {
+        FeatureVisitor<Features>::Visit(context, own[i],
+                                        LowestBitIndex(pieces),
+                                        values + i * kFeatureCount);
+        pieces &= pieces - 1;
+      }
+    }
+  }
+
+  // StateEvaluator interface
+  virtual int Evaluate(const GameState& state, game::PieceColor player) const {
+    int values[2 * kFeatureCount];
+    ComputeFeatures(state, player, values);
+    int score = 0;
+    for (int i = 0; i < 2 * kFeatureCount; ++i) {
+      score += weights_[i] * values[i];
+    }
+    return score;
+  }
+
+ private:
+  int weights_[2 * kFeatureCount];
+
+  DISALLOW_COPY_AND_ASSIGN(FusedEvaluator);
+};
+
+}  // namespace alphabeta
+}  // namespace ai
+
+#endif  // AI_ALPHABETA_FUSED_EVALUATOR_H_
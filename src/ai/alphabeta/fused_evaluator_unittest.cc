@@ -0,0 +1,135 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/evaluators.h"
+#include "ai/alphabeta/fused_evaluator.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "base/basic_macros.h"
+#include "game/board.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+const int kWeights[] = { 3, 5, 7, -11, -13, -17 };
+
+// Feature that counts the pieces on the first location of the board.
+struct FirstLocationFeature {
+  static int Visit(const FeatureContext& context, Bitboard own, int index) {
+    return index == 0;
+  }
+};
+
+class FusedEvaluatorTest : public ::testing::TestWithParam<game::GameType> {
+};
+
+TEST_P(FusedEvaluatorTest, DefaultFeatures) {
+  game::GameOptions options;
+  options.set_game_type(GetParam());
+  const std::vector<int> weights(kWeights, kWeights + arraysize(kWeights));
+  const FusedEvaluator<DefaultFeatures> evaluator(weights);
+  EXPECT_EQ(3, FusedEvaluator<DefaultFeatures>::kFeatureCount);
+  GameStateTree tree(options);
+  const int piece_count =
+      game::Game::GetInitialPieceCountByGameType(options.game_type());
+  GameState state(options.game_type());
+  state.set_pieces_in_hand(game::WHITE_COLOR, piece_count);
+  state.set_pieces_in_hand(game::BLACK_COLOR, piece_count);
+  SuccessorBuffer successors;
+  for (int ply = 0; ply < 100; ++ply) {
+    game::Board board(options.game_type());
+    state.Decode(&board);
+    const game::PieceColor colors[] = { game::WHITE_COLOR, game::BLACK_COLOR };
+    for (size_t i = 0; i < arraysize(colors); ++i) {
+      const game::PieceColor opponent = game::GetOpponent(colors[i]);
+      const int expected_values[] = {
+        Mobility(board, colors[i]), Material(board, colors[i]),
+        Mills(board, colors[i]), Mobility(board, opponent),
+        Material(board, opponent), Mills(board, opponent)
+      };
+      int values[arraysize(expected_values)];
+      FusedEvaluator<DefaultFeatures>::ComputeFeatures(state, colors[i],
+                                                       values);
+      int expected_score = 0;
+      for (size_t k = 0; k < arraysize(expected_values); ++k) {
+        EXPECT_EQ(expected_values[k], values[k]);
+        expected_score += kWeights[k] * expected_values[k];
+      }
+      EXPECT_EQ(expected_score, evaluator.Evaluate(state, colors[i]));
+    }
+    successors.clear();
+    tree.GenerateSuccessors(state, &successors);
+    if (successors.empty()) {
+      break;
+    }
+    state = successors[(ply * 5) % successors.size()];
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(FusedEvaluatorTestInstance,
+                        FusedEvaluatorTest,
+                        ::testing::Values(game::THREE_MEN_MORRIS,
+                                          game::SIX_MEN_MORRIS,
+                                          game::NINE_MEN_MORRIS));
+
+TEST(FusedEvaluator, CustomFeatures) {
+  typedef FeatureList<FirstLocationFeature, FeatureList<MaterialFeature> >
+      Features;
+  EXPECT_EQ(2, FusedEvaluator<Features>::kFeatureCount);
+  const int weights[] = { 100, 1, -100, -1 };
+  const FusedEvaluator<Features> evaluator(
+      std::vector<int>(weights, weights + arraysize(weights)));
+  GameState state(game::SIX_MEN_MORRIS);
+  state.AddPiece(0, game::WHITE_COLOR);
+  state.AddPiece(1, game::WHITE_COLOR);
+  state.AddPiece(2, game::BLACK_COLOR);
+  EXPECT_EQ(100 + 2 - 1, evaluator.Evaluate(state, game::WHITE_COLOR));
+  EXPECT_EQ(1 - 100 - 2, evaluator.Evaluate(state, game::BLACK_COLOR));
+}
+
+TEST(FusedEvaluator, MorrisAlphaBeta) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  // The default evaluators and the fused ones with the same weights search
+  // the same trees.
+  MorrisAlphaBeta default_alg(options);
+  const int default_weights[] = { 10, 10, 10, -10, -10, -10 };
+  MorrisAlphaBeta fused_alg(options, std::auto_ptr<StateEvaluator>(
+      new FusedEvaluator<DefaultFeatures>(std::vector<int>(
+          default_weights, default_weights + arraysize(default_weights)))));
+  EXPECT_FALSE(fused_alg.is_incremental_evaluation_enabled());
+  MorrisAlphaBeta* const algorithms[] = { &default_alg, &fused_alg };
+  for (size_t i = 0; i < arraysize(algorithms); ++i) {
+    algorithms[i]->set_max_search_depth(3);
+    algorithms[i]->set_shuffling_enabled(false);
+  }
+  game::Game test_game(options);
+  test_game.Initialize();
+  for (int i = 0; i < 12 && !test_game.is_game_over(); ++i) {
+    const game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&fused_alg)->GetNextAction(test_game);
+    const game::PlayerAction expected_action =
+        static_cast<AIAlgorithm*>(&default_alg)->GetNextAction(test_game);
+    EXPECT_EQ(default_alg.node_count(), fused_alg.node_count());
+    EXPECT_EQ(expected_action.destination(), action.destination());
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(action));
+    test_game.ExecutePlayerAction(action);
+  }
+}
+
+}  // anonymous namespace
+}  // namespace alphabeta
+}  // namespace ai
@@ -4,6 +4,7 @@
 
 #include "ai/alphabeta/morris_alphabeta.h"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <utility>
@@ -12,12 +13,22 @@
 #include "ai/ai_algorithm.h"
 #include "ai/alphabeta/alphabeta.h"
 #include "ai/alphabeta/evaluators.h"
+#include "ai/alphabeta/feature_kernels.h"
+#include "ai/alphabeta/transposition_table.h"
+#include "ai/book/opening_book.h"
+#include "ai/bitboard.h"
 #include "ai/game_state.h"
 #include "ai/game_state_tree.h"
+#include "ai/symmetry.h"
+#include "ai/tablebase/tablebase.h"
 #include "base/basic_macros.h"
 #include "base/bind.h"
 #include "base/function.h"
+#include "base/location.h"
 #include "base/log.h"
+#include "base/method.h"
+#include "base/ptr/scoped_ptr.h"
+#include "base/threading/thread.h"
 #include "game/board.h"
 #include "game/board_location.h"
 #include "game/game.h"
@@ -30,6 +41,8 @@ namespace alphabeta {
 namespace {
 
 // TODO(alphabeta): Find the optimal values of these weights using the trainer.
+// The weights of the default evaluators: the mobility, the material and the
+// mills of the player, followed by the same features of the opponent.
 const int kBestWeights[] = { 10, 10, 10, -10, -10, -10 };
 
 const game::BoardLocation kInvalidLocation(-1, -1);
@@ -51,18 +64,154 @@ class ProxyPtr : public AlphaBeta<GameState>::Delegate {
     return alg_->Evaluate(state);
   };
 
+  virtual bool EvaluateBatch(const GameState* states, int count, int* scores) {
+    return alg_->EvaluateBatch(states, count, scores);
+  }
+
   virtual void GetSuccessors(const GameState& state,
                              std::vector<GameState>* successors) {
     alg_->GetSuccessors(state, successors);
   };
 
+  virtual AlphaBeta<GameState>::Delegate* CreateHelperDelegate() {
+    return alg_->CreateHelperDelegate();
+  }
+
+  virtual int GetMoveId(const GameState& state, const GameState& successor) {
+    return alg_->GetMoveId(state, successor);
+  }
+
+  virtual int GetMoveCount() {
+    return alg_->GetMoveCount();
+  }
+
+  virtual void GetNoisySuccessors(const GameState& state,
+                                  std::vector<GameState>* successors) {
+    alg_->GetNoisySuccessors(state, successors);
+  }
+
+  virtual uint64_t GetTranspositionKey(const GameState& state) {
+    return alg_->GetTranspositionKey(state);
+  }
+
   AlphaBeta<GameState>::Delegate* const alg_;
 
   DISALLOW_COPY_AND_ASSIGN(ProxyPtr);
 };
 
+// Returns the number of distinct move ids for the given board |layout|. A
+// move is identified by its source (or none, for placing a piece), its
+// destination and the removed piece (or none).
+int ComputeMoveCount(const BitboardLayout& layout) {
+  const int locations = layout.location_count;
+  return (locations + 1) * locations * (locations + 1);
+}
+
+int ComputeMoveId(const GameState& state, const GameState& successor) {
+  const int locations = state.layout().location_count;
+  const game::PieceColor player = state.current_player();
+  const game::PieceColor opponent = game::GetOpponent(player);
+  const Bitboard sources = state.pieces(player) & ~successor.pieces(player);
+  const Bitboard destinations =
+      successor.pieces(player) & ~state.pieces(player);
+  const Bitboard removed =
+      state.pieces(opponent) & ~successor.pieces(opponent);
+  DCHECK(destinations);
+  const int source = sources ? LowestBitIndex(sources) : locations;
+  const int remove = removed ? LowestBitIndex(removed) : locations;
+  return (source * locations + LowestBitIndex(destinations)) *
+      (locations + 1) + remove;
+}
+
+// Returns true if the move from |state| to |successor| removes a piece of the
+// opponent, or if it moves a piece out of a mill, which can be closed again by
+// moving the piece back.
+bool IsNoisyMove(const GameState& state, const GameState& successor) {
+  const game::PieceColor player = state.current_player();
+  const game::PieceColor opponent = game::GetOpponent(player);
+  if (state.pieces(opponent) & ~successor.pieces(opponent)) {
+    return true;
+  }
+  const Bitboard sources = state.pieces(player) & ~successor.pieces(player);
+  return sources && IsPartOfMill(state.layout(), state.pieces(player),
+                                 LowestBitIndex(sources));
+}
+
+// Returns the score of a solved position for the player to move. The wins and
+// the losses are worse than the terminal states by their distance to the end
+// of the game, so the search prefers the shortest wins and the longest losses.
+int GetScoreForPlayerToMove(const tablebase::Entry& entry) {
+  switch (entry.outcome) {
+    case tablebase::WIN:
+      return std::numeric_limits<int>::max() - entry.distance;
+    case tablebase::LOSS:
+      return std::numeric_limits<int>::min() + entry.distance;
+    case tablebase::DRAW:
+      return 0;
+  }
+  NOTREACHED();
+  return 0;
+}
+
 }  // anonymous namespace
 
+// The delegate used by a helper thread of the search and by the pondering
+// search. It uses the settings of the MorrisAlphaBeta instance that created
+// it, but it has its own buffers and caches, since these are not thread-safe.
+// Each search creates new helper delegates, so their caches only keep the
+// scores of the states visited by one search.
+class MorrisAlphaBeta::HelperDelegate : public AlphaBeta<GameState>::Delegate {
+ public:
+  explicit HelperDelegate(const MorrisAlphaBeta* alg)
+      : alg_(alg) {}
+
+ private:
+  // AlphaBeta<GameState, double>::Delegate interface
+  virtual bool IsTerminal(const GameState& state) {
+    return alg_->IsTerminalState(state, &successor_buffer_, &score_cache_);
+  }
+
+  virtual int Evaluate(const GameState& state) {
+    return alg_->EvaluateState(state, &score_cache_);
+  }
+
+  virtual bool EvaluateBatch(const GameState* states, int count, int* scores) {
+    return alg_->EvaluateStates(states, count, scores, &score_cache_);
+  }
+
+  virtual void GetSuccessors(const GameState& state,
+                             std::vector<GameState>* successors) {
+    alg_->GenerateSuccessors(state, &successor_buffer_, successors);
+  }
+
+  virtual int GetMoveId(const GameState& state, const GameState& successor) {
+    return ComputeMoveId(state, successor);
+  }
+
+  virtual AlphaBeta<GameState>::Delegate* CreateHelperDelegate() {
+    return new HelperDelegate(alg_);
+  }
+
+  virtual int GetMoveCount() {
+    return ComputeMoveCount(GetBitboardLayout(alg_->options_.game_type()));
+  }
+
+  virtual void GetNoisySuccessors(const GameState& state,
+                                  std::vector<GameState>* successors) {
+    alg_->GenerateNoisySuccessors(state, &successor_buffer_, successors);
+  }
+
+  virtual uint64_t GetTranspositionKey(const GameState& state) {
+    return alg_->GetCacheState(state).key();
+  }
+
+  const MorrisAlphaBeta* const alg_;
+  SuccessorBuffer successor_buffer_;
+  ScoreCache score_cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(HelperDelegate);
+};
+
 template <> size_t Hash<GameState>(const GameState& state) {
   return GameState::Hash(state);
 }
@@ -71,9 +220,24 @@ MorrisAlphaBeta::MorrisAlphaBeta(const game::GameOptions& options)
     : options_(options),
       max_search_depth_(-1),
       max_search_time_(-1),
+      max_node_count_(0),
+      shuffle_(true),
+      random_(),
+      pvs_(true),
+      aspiration_window_(0),
+      quiescence_depth_(0),
+      helper_thread_count_(0),
+      parallel_search_mode_(SHARED_TRANSPOSITION_TABLE),
+      canonical_keys_(false),
+      node_count_(0),
+      collect_statistics_(false),
+      default_evaluators_(true),
+      incremental_evaluation_(true),
       tree_(options),
       remove_location_(kInvalidLocation),
-      max_player_color_(game::NO_COLOR) {
+      max_player_color_(game::NO_COLOR),
+      tablebase_(NULL),
+      opening_book_(NULL) {
   typedef int(OppEvalSig)(Evaluator*, const game::Board&, game::PieceColor);
   using base::Function;
   evaluators_.push_back(new Function<EvaluatorSignature>(&Mobility));
@@ -95,11 +259,26 @@ MorrisAlphaBeta::MorrisAlphaBeta(const game::GameOptions& options,
     : options_(options),
       max_search_depth_(-1),
       max_search_time_(-1),
+      max_node_count_(0),
+      shuffle_(true),
+      random_(),
+      pvs_(true),
+      aspiration_window_(0),
+      quiescence_depth_(0),
+      helper_thread_count_(0),
+      parallel_search_mode_(SHARED_TRANSPOSITION_TABLE),
+      canonical_keys_(false),
+      node_count_(0),
+      collect_statistics_(false),
       evaluators_(evaluators),
       weights_(weights),
+      default_evaluators_(false),
+      incremental_evaluation_(false),
       tree_(options),
       remove_location_(kInvalidLocation),
-      max_player_color_(game::NO_COLOR) {
+      max_player_color_(game::NO_COLOR),
+      tablebase_(NULL),
+      opening_book_(NULL) {
   DCHECK(!evaluators.empty());
   if (weights_.empty()) {
     weights_.insert(weights_.begin(), evaluators_.size(), 1.0);
@@ -108,39 +287,128 @@ MorrisAlphaBeta::MorrisAlphaBeta(const game::GameOptions& options,
   }
 }
 
+MorrisAlphaBeta::MorrisAlphaBeta(const game::GameOptions& options,
+                                 std::auto_ptr<StateEvaluator> evaluator)
+    : options_(options),
+      max_search_depth_(-1),
+      max_search_time_(-1),
+      max_node_count_(0),
+      shuffle_(true),
+      random_(),
+      pvs_(true),
+      aspiration_window_(0),
+      quiescence_depth_(0),
+      helper_thread_count_(0),
+      parallel_search_mode_(SHARED_TRANSPOSITION_TABLE),
+      canonical_keys_(false),
+      node_count_(0),
+      collect_statistics_(false),
+      state_evaluator_(evaluator.release()),
+      default_evaluators_(false),
+      incremental_evaluation_(false),
+      tree_(options),
+      remove_location_(kInvalidLocation),
+      max_player_color_(game::NO_COLOR),
+      tablebase_(NULL),
+      opening_book_(NULL) {
+  DCHECK(Get(state_evaluator_));
+}
+
 MorrisAlphaBeta::~MorrisAlphaBeta() {
+  StopPondering();
   for (size_t i = 0; i < evaluators_.size(); ++i) {
     delete evaluators_[i];
     evaluators_[i] = NULL;
   }
 }
 
+bool MorrisAlphaBeta::StartPondering(const game::Game& game_model) {
+  DCHECK_EQ(options_, game_model.options());
+  DCHECK(!is_pondering());
+  if (game_model.is_game_over() ||
+      game::GetOpponent(game_model.current_player()) != max_player_color_ ||
+      game_model.next_action_type() == game::PlayerAction::REMOVE_PIECE) {
+    return false;
+  }
+  // The opponent is predicted to play the best move found for it by the
+  // previous searches.
+  const GameState state = GetGameState(game_model);
+  TranspositionTable<int>::Entry entry;
+  if (!trans_table_.Probe(GetTranspositionKey(state), &entry)) {
+    return false;
+  }
+  std::vector<GameState> successors;
+  GenerateSuccessors(state, &successor_buffer_, &successors);
+  if (static_cast<size_t>(entry.best_move) >= successors.size() ||
+      IsTerminal(successors[entry.best_move])) {
+    return false;
+  }
+  ponder_state_ = successors[entry.best_move];
+  Reset(ponder_search_, CreateSearch(
+      std::auto_ptr<AlphaBeta<GameState>::Delegate>(new HelperDelegate(this)),
+      &ponder_statistics_));
+  ponder_search_->set_pondering(true);
+  Reset(ponder_thread_, new base::threading::Thread("MorrisAlphaBeta ponder"));
+  ponder_thread_->Start();
+  ponder_thread_->SubmitTask(FROM_HERE,
+      base::Bind(new base::Method<void(MorrisAlphaBeta::*)(void)>(
+          &MorrisAlphaBeta::Ponder), this));
+  return true;
+}
+
+void MorrisAlphaBeta::StopPondering() {
+  if (!is_pondering()) {
+    return;
+  }
+  ponder_search_->Stop();
+  JoinPonderThread();
+  Reset(ponder_search_);
+}
+
 game::PlayerAction MorrisAlphaBeta::GetNextAction(
     const game::Game& game_model) {
   DCHECK_EQ(options_, game_model.options());
+  search_statistics_.clear();
   if (game_model.next_action_type() == game::PlayerAction::REMOVE_PIECE) {
+    StopPondering();
     game::PlayerAction action(game_model.current_player(),
                               game::PlayerAction::REMOVE_PIECE);
     action.set_source(remove_location_);
     return action;
   }
-  max_player_color_ = game_model.current_player();
-  std::auto_ptr<AlphaBeta<GameState>::Delegate> delegate(new ProxyPtr(this));
-  AlphaBeta<GameState> alphabeta(delegate);
-  if (max_search_depth_ > 0) {
-    alphabeta.set_max_search_depth(max_search_depth_);
+  const GameState origin = GetGameState(game_model);
+  GameState best_successor;
+  if (GetBookSuccessor(origin, &best_successor) ||
+      GetTablebaseSuccessor(origin, &best_successor)) {
+    // The positions from the book and the solved positions are not searched.
+    StopPondering();
+    node_count_ = 0;
+  } else if (is_pondering() && origin == ponder_state_) {
+    // Ponder hit: the search continues with the normal limits.
+    ponder_search_->PonderHit();
+    JoinPonderThread();
+    best_successor = ponder_result_;
+    node_count_ = ponder_search_->node_count();
+    search_statistics_.swap(ponder_statistics_);
+    Reset(ponder_search_);
+  } else {
+    // Ponder miss: the results are only kept in the transposition table.
+    StopPondering();
+    if (max_player_color_ != game_model.current_player()) {
+      // The scores computed so far are relative to the other player.
+      max_player_color_ = game_model.current_player();
+      trans_table_.Clear();
+    }
+    // Only the transposition table keeps the results of the previous
+    // searches, so the memory used by the score cache does not grow with the
+    // number of moves played.
+    score_cache_.clear();
+    base::ptr::scoped_ptr<AlphaBeta<GameState> > alphabeta(CreateSearch(
+        std::auto_ptr<AlphaBeta<GameState>::Delegate>(new ProxyPtr(this)),
+        &search_statistics_));
+    best_successor = alphabeta->GetBestSuccessor(origin);
+    node_count_ = alphabeta->node_count();
   }
-  if (max_search_time_ > 0) {
-    alphabeta.set_max_search_time(max_search_time_);
-  }
-  GameState origin;
-  origin.set_current_player(game_model.current_player());
-  origin.set_pieces_in_hand(
-      game::WHITE_COLOR, game_model.GetPiecesInHand(game::WHITE_COLOR));
-  origin.set_pieces_in_hand(
-      game::BLACK_COLOR, game_model.GetPiecesInHand(game::BLACK_COLOR));
-  origin.Encode(game_model.board());
-  const GameState best_successor = alphabeta.GetBestSuccessor(origin);
   const std::vector<game::PlayerAction> actions =
       GameState::GetTransition(origin, best_successor);
   if (actions.size() > 1) {
@@ -153,19 +421,151 @@ game::PlayerAction MorrisAlphaBeta::GetNextAction(
   return actions[0];
 }
 
+void MorrisAlphaBeta::set_tablebase(const tablebase::Tablebase* tablebase) {
+  StopPondering();
+  tablebase_ = tablebase;
+  // The scores computed so far ignored the solved positions.
+  score_cache_.clear();
+  trans_table_.Clear();
+}
+
+void MorrisAlphaBeta::set_incremental_evaluation_enabled(bool enable) {
+  DCHECK(!enable || default_evaluators_);
+  StopPondering();
+  incremental_evaluation_ = enable;
+}
+
+void MorrisAlphaBeta::set_transposition_table_size(size_t size) {
+  StopPondering();
+  trans_table_.Resize(size);
+}
+
+void MorrisAlphaBeta::ClearTranspositionTable() {
+  StopPondering();
+  trans_table_.Clear();
+}
+
+void MorrisAlphaBeta::set_canonical_keys_enabled(bool enable) {
+  if (enable == canonical_keys_) {
+    return;
+  }
+  StopPondering();
+  canonical_keys_ = enable;
+  // The best moves stored so far are indices into successor lists generated
+  // in another order.
+  score_cache_.clear();
+  trans_table_.Clear();
+}
+
+void MorrisAlphaBeta::set_opening_book(
+    const book::OpeningBook* opening_book) {
+  DCHECK(!opening_book || opening_book->options() == options_);
+  opening_book_ = opening_book;
+}
+
+AlphaBeta<GameState>* MorrisAlphaBeta::CreateSearch(
+    std::auto_ptr<AlphaBeta<GameState>::Delegate> delegate,
+    std::vector<IterationStatistics>* statistics) {
+  AlphaBeta<GameState>* alphabeta =
+      new AlphaBeta<GameState>(delegate, &trans_table_);
+  if (max_search_depth_ > 0) {
+    alphabeta->set_max_search_depth(max_search_depth_);
+  }
+  if (max_search_time_ > 0) {
+    alphabeta->set_max_search_time(max_search_time_);
+  }
+  alphabeta->set_max_node_count(max_node_count_);
+  alphabeta->set_shuffling_enabled(shuffle_);
+  const uint64_t seed = random_.Next();
+  alphabeta->set_seed((seed << 32) | random_.Next());
+  alphabeta->set_pvs_enabled(pvs_);
+  alphabeta->set_aspiration_window(aspiration_window_);
+  alphabeta->set_quiescence_depth(quiescence_depth_);
+  alphabeta->set_helper_thread_count(helper_thread_count_);
+  alphabeta->set_parallel_search_mode(parallel_search_mode_);
+  if (collect_statistics_) {
+    alphabeta->set_statistics(statistics);
+  }
+  return alphabeta;
+}
+
+GameState MorrisAlphaBeta::GetGameState(const game::Game& game_model) const {
+  GameState state;
+  state.Encode(game_model);
+  return state;
+}
+
+void MorrisAlphaBeta::Ponder() {
+  ponder_result_ = ponder_search_->GetBestSuccessor(ponder_state_);
+}
+
+void MorrisAlphaBeta::JoinPonderThread() {
+  ponder_thread_->SubmitQuitTaskAndJoin();
+  Reset(ponder_thread_);
+}
+
 bool MorrisAlphaBeta::IsTerminal(const GameState& state) {
-  game::Board board(options_.game_type());
-  state.Decode(&board);
+  return IsTerminalState(state, &successor_buffer_, &score_cache_);
+}
+
+int MorrisAlphaBeta::Evaluate(const GameState& state) {
+  return EvaluateState(state, &score_cache_);
+}
+
+bool MorrisAlphaBeta::EvaluateBatch(const GameState* states,
+                                    int count,
+                                    int* scores) {
+  return EvaluateStates(states, count, scores, &score_cache_);
+}
+
+void MorrisAlphaBeta::GetSuccessors(const GameState& state,
+                                    std::vector<GameState>* successors) {
+  GenerateSuccessors(state, &successor_buffer_, successors);
+}
+
+AlphaBeta<GameState>::Delegate* MorrisAlphaBeta::CreateHelperDelegate() {
+  return new HelperDelegate(this);
+}
+
+int MorrisAlphaBeta::GetMoveId(const GameState& state,
+                               const GameState& successor) {
+  return ComputeMoveId(state, successor);
+}
+
+int MorrisAlphaBeta::GetMoveCount() {
+  return ComputeMoveCount(GetBitboardLayout(options_.game_type()));
+}
+
+void MorrisAlphaBeta::GetNoisySuccessors(const GameState& state,
+                                         std::vector<GameState>* successors) {
+  GenerateNoisySuccessors(state, &successor_buffer_, successors);
+}
+
+uint64_t MorrisAlphaBeta::GetTranspositionKey(const GameState& state) {
+  return GetCacheState(state).key();
+}
+
+GameState MorrisAlphaBeta::GetCacheState(const GameState& state) const {
+  return canonical_keys_ ? state.GetCanonicalState(NULL) : state;
+}
+
+bool MorrisAlphaBeta::IsTerminalState(const GameState& state,
+                                      SuccessorBuffer* buffer,
+                                      ScoreCache* score_cache) const {
   // TODO(alphabeta): Similar logic with game::Game:CheckIfGameIsOver()
   const game::PieceColor player = state.current_player();
-  const int remaining_pieces_on_board = board.GetPieceCountByColor(player);
+  const int remaining_pieces_on_board = PopCount(state.pieces(player));
   const int remaining_pieces_in_hand = state.pieces_in_hand(player);
-  const int total_remaining_pieces =
-      remaining_pieces_on_board + remaining_pieces_in_hand;
   const int score = state.current_player() != max_player_color_ ?
     std::numeric_limits<int>::max() : std::numeric_limits<int>::min();
-  if (total_remaining_pieces <= 2) {
-    score_cache_.insert(std::make_pair(state, score));
+  if (IsLost(state.pieces(player), remaining_pieces_in_hand)) {
+    score_cache->insert(std::make_pair(GetCacheState(state), score));
+    return true;
+  }
+  tablebase::Entry entry;
+  if (tablebase_ && tablebase_->Probe(state, &entry)) {
+    score_cache->insert(std::make_pair(GetCacheState(state),
+                                       GetTablebaseScore(state, entry)));
     return true;
   }
   if (remaining_pieces_in_hand > 0) {
@@ -177,34 +577,194 @@ bool MorrisAlphaBeta::IsTerminal(const GameState& state) {
     return false;
   }
   // End of similar code.
+  buffer->clear();
+  tree_.GenerateSuccessors(state, buffer);
+  if (buffer->empty()) {
+    score_cache->insert(std::make_pair(GetCacheState(state), score));
+  }
+  return buffer->empty();
+}
+
+void MorrisAlphaBeta::GenerateSuccessors(
+    const GameState& state,
+    SuccessorBuffer* buffer,
+    std::vector<GameState>* successors) const {
+  buffer->clear();
+  int symmetry = 0;
+  if (!canonical_keys_) {
+    tree_.GenerateSuccessors(state, buffer);
+  } else {
+    tree_.GenerateSuccessors(state.GetCanonicalState(&symmetry), buffer);
+  }
+  if (!symmetry) {
+    successors->insert(successors->end(), buffer->begin(), buffer->end());
+    return;
+  }
+  // The successors of the canonical state are moved back to the orientation
+  // of |state|, so they keep the order shared by all the symmetric states.
+  const int inverse = GetInverseSymmetry(state.game_type(), symmetry);
+  for (int i = 0; i < buffer->size(); ++i) {
+    successors->push_back((*buffer)[i].GetSymmetricState(inverse));
+  }
+}
+
+void MorrisAlphaBeta::GenerateNoisySuccessors(
+    const GameState& state,
+    SuccessorBuffer* buffer,
+    std::vector<GameState>* successors) const {
+  buffer->clear();
+  tree_.GenerateSuccessors(state, buffer);
+  for (int i = 0; i < buffer->size(); ++i) {
+    if (IsNoisyMove(state, (*buffer)[i])) {
+      successors->push_back((*buffer)[i]);
+    }
+  }
+}
+
+int MorrisAlphaBeta::GetTablebaseScore(const GameState& state,
+                                       const tablebase::Entry& entry) const {
+  if (state.current_player() == max_player_color_) {
+    return GetScoreForPlayerToMove(entry);
+  }
+  // The same result, seen by the other player.
+  tablebase::Entry opponent_entry(entry);
+  if (entry.outcome == tablebase::WIN) {
+    opponent_entry.outcome = tablebase::LOSS;
+  } else if (entry.outcome == tablebase::LOSS) {
+    opponent_entry.outcome = tablebase::WIN;
+  }
+  return GetScoreForPlayerToMove(opponent_entry);
+}
+
+bool MorrisAlphaBeta::GetTablebaseSuccessor(const GameState& origin,
+                                            GameState* best_successor) {
+  tablebase::Entry entry;
+  if (!tablebase_ || !tablebase_->Probe(origin, &entry)) {
+    return false;
+  }
   std::vector<GameState> successors;
-  GetSuccessors(state, &successors);
-  if (successors.empty()) {
-    score_cache_.insert(std::make_pair(state, score));
+  GenerateSuccessors(origin, &successor_buffer_, &successors);
+  int best_score = 0;
+  for (size_t i = 0; i < successors.size(); ++i) {
+    tablebase::Entry successor_entry;
+    if (!tablebase_->Probe(successors[i], &successor_entry)) {
+      return false;
+    }
+    // The best successor is the worst one for the opponent.
+    const int score = GetScoreForPlayerToMove(successor_entry);
+    if (i == 0 || score < best_score) {
+      best_score = score;
+      *best_successor = successors[i];
+    }
   }
-  return successors.empty();
+  return !successors.empty();
 }
 
-int MorrisAlphaBeta::Evaluate(const GameState& state) {
-  ScoreCache::const_iterator it = score_cache_.find(state);
-  if (it != score_cache_.end()) {
+bool MorrisAlphaBeta::GetBookSuccessor(const GameState& origin,
+                                       GameState* best_successor) {
+  int symmetry = 0;
+  const book::BookMove* const move =
+      opening_book_ ? opening_book_->Find(origin, &symmetry) : NULL;
+  if (!move) {
+    return false;
+  }
+  std::vector<GameState> successors;
+  GenerateSuccessors(origin, &successor_buffer_, &successors);
+  for (size_t i = 0; i < successors.size(); ++i) {
+    if (successors[i].GetSymmetricState(symmetry).encoding() ==
+        move->successor) {
+      *best_successor = successors[i];
+      return true;
+    }
+  }
+  // The book move is not valid in this position, so the book was built for
+  // other game rules.
+  ELOG(WARNING) << "Invalid opening book move";
+  return false;
+}
+
+int MorrisAlphaBeta::EvaluateState(const GameState& state,
+                                   ScoreCache* score_cache) const {
+  const GameState cache_state(GetCacheState(state));
+  ScoreCache::const_iterator it = score_cache->find(cache_state);
+  if (it != score_cache->end()) {
     return it->second;
   }
+  if (incremental_evaluation_) {
+    // The features are cheaper to combine than to cache, so the cache only
+    // keeps the scores of the terminal states. The same goes for the state
+    // evaluator below.
+    return EvaluateFeatures(state);
+  }
+  if (Get(state_evaluator_)) {
+    return state_evaluator_->Evaluate(state, max_player_color_);
+  }
   game::Board board(options_.game_type());
   state.Decode(&board);
   int score = 0;
   for (size_t i = 0; i < evaluators_.size(); ++i) {
     score += weights_[i] * ((*evaluators_[i])(board, max_player_color_));
   }
-  score_cache_.insert(std::make_pair(state, score));
+  score_cache->insert(std::make_pair(cache_state, score));
   return score;
 }
 
-void MorrisAlphaBeta::GetSuccessors(const GameState& state,
-                                       std::vector<GameState>* successors) {
-  tree_.GetSuccessors(state, successors);
+bool MorrisAlphaBeta::EvaluateStates(const GameState* states,
+                                     int count,
+                                     int* scores,
+                                     ScoreCache* score_cache) const {
+  if (!incremental_evaluation_) {
+    // The other evaluators are too slow to evaluate the leaves that are
+    // pruned.
+    return false;
+  }
+  // The features of each chunk of states are gathered in arrays that are
+  // scored by one SIMD kernel. The cached scores of the terminal states
+  // replace the computed ones.
+  const game::PieceColor colors[] = {
+    max_player_color_, game::GetOpponent(max_player_color_)
+  };
+  FeatureBatch batch;
+  for (int begin = 0; begin < count; begin += kFeatureBatchSize) {
+    batch.count = std::min(count - begin, kFeatureBatchSize);
+    for (int i = 0; i < batch.count; ++i) {
+      const GameState& state = states[begin + i];
+      for (int p = 0; p < 2; ++p) {
+        batch.pieces[p][i] = state.pieces(colors[p]);
+        batch.mobility[p][i] = state.mobility(colors[p]);
+        batch.mills[p][i] = state.pieces_in_mills(colors[p]);
+      }
+    }
+    ComputeFeatureScores(batch, &weights_[0], scores + begin,
+                         GetBestFeatureKernel());
+  }
+  if (score_cache->empty()) {
+    return true;
+  }
+  for (int i = 0; i < count; ++i) {
+    ScoreCache::const_iterator it =
+        score_cache->find(GetCacheState(states[i]));
+    if (it != score_cache->end()) {
+      scores[i] = it->second;
+    }
+  }
+  return true;
+}
+
+int MorrisAlphaBeta::EvaluateFeatures(const GameState& state) const {
+  DCHECK(default_evaluators_);
+  const game::PieceColor colors[] = {
+    max_player_color_, game::GetOpponent(max_player_color_)
+  };
+  int score = 0;
+  for (int i = 0; i < 2; ++i) {
+    const int* weights = &weights_[3 * i];
+    score += weights[0] * state.mobility(colors[i]) +
+             weights[1] * PopCount(state.pieces(colors[i])) +
+             weights[2] * state.pieces_in_mills(colors[i]);
+  }
+  return score;
 }
 
 }  // namespace alphabeta
 }  // namespace ai
-
@@ -5,16 +5,26 @@
 #ifndef AI_ALPHABETA_MORRIS_ALPHABETA_H_
 #define AI_ALPHABETA_MORRIS_ALPHABETA_H_
 
+#include <stdint.h>
+
+#include <memory>
 #include <vector>
 
 #include "ai/ai_algorithm.h"
 #include "ai/ai_export.h"
 #include "ai/alphabeta/alphabeta.h"
 #include "ai/alphabeta/evaluators.h"
+#include "ai/alphabeta/fused_evaluator.h"
+#include "ai/alphabeta/transposition_table.h"
+#include "ai/book/opening_book.h"
 #include "ai/game_state.h"
 #include "ai/game_state_tree.h"
+#include "ai/tablebase/tablebase.h"
 #include "base/basic_macros.h"
 #include "base/hash_map.h"
+#include "base/ptr/scoped_ptr.h"
+#include "base/random.h"
+#include "base/threading/thread.h"
 #include "game/board_location.h"
 #include "game/piece_color.h"
 #include "game/player_action.h"
@@ -37,41 +47,241 @@ class AI_EXPORT MorrisAlphaBeta
   MorrisAlphaBeta(const game::GameOptions& options,
       const std::vector<Evaluator*>& evaluators,
       const std::vector<int>& weights = std::vector<int>());
+  // Scores the positions with |evaluator| (e.g. a FusedEvaluator), which is
+  // called once per position, without decoding it into a game::Board.
+  MorrisAlphaBeta(const game::GameOptions& options,
+                  std::auto_ptr<StateEvaluator> evaluator);
   ~MorrisAlphaBeta();
 
   // See the similar methods from the generic AlphaBeta algorithm for details.
   int max_search_depth() const { return max_search_depth_; }
   void set_max_search_depth(int max_depth) { max_search_depth_ = max_depth; }
-  int max_search_time() const { return max_search_time_; }
-  void set_max_search_time(int max_time) { max_search_time_ = max_time; }
+  int64_t max_search_time() const { return max_search_time_; }
+  void set_max_search_time(int64_t max_time) { max_search_time_ = max_time; }
+  int64_t max_node_count() const { return max_node_count_; }
+  void set_max_node_count(int64_t count) { max_node_count_ = count; }
+  bool is_shuffling_enabled() const { return shuffle_; }
+  void set_shuffling_enabled(bool enable) { shuffle_ = enable; }
+  // Each search, including the pondering ones, is seeded from this seed.
+  void set_seed(uint64_t seed) { random_ = base::XorShift64Star(seed); }
+  bool is_pvs_enabled() const { return pvs_; }
+  void set_pvs_enabled(bool enable) { pvs_ = enable; }
+  int aspiration_window() const { return aspiration_window_; }
+  void set_aspiration_window(int size) { aspiration_window_ = size; }
+  int quiescence_depth() const { return quiescence_depth_; }
+  void set_quiescence_depth(int depth) { quiescence_depth_ = depth; }
+  int helper_thread_count() const { return helper_thread_count_; }
+  void set_helper_thread_count(int count) { helper_thread_count_ = count; }
+  ParallelSearchMode parallel_search_mode() const {
+    return parallel_search_mode_;
+  }
+  void set_parallel_search_mode(ParallelSearchMode mode) {
+    parallel_search_mode_ = mode;
+  }
+
+  // If enabled, the positions are scored from the features that GameState
+  // updates incrementally with each move (see GameState::mobility()), instead
+  // of being decoded into a game::Board that is scanned by each evaluator.
+  // This is only possible with the default evaluators, which compute the same
+  // features, so the scores are the same in both modes. By default, it is
+  // enabled if the default evaluators are used.
+  bool is_incremental_evaluation_enabled() const {
+    return incremental_evaluation_;
+  }
+  void set_incremental_evaluation_enabled(bool enable);
+
+  // The number of states visited by the last search.
+  int64_t node_count() const { return node_count_; }
+
+  // If enabled, the statistics of each iteration of the last search are
+  // available in |search_statistics()|. The statistics are empty if the last
+  // action did not require a search. By default, they are not collected.
+  typedef AlphaBeta<GameState>::IterationStatistics IterationStatistics;
+  bool is_search_statistics_enabled() const { return collect_statistics_; }
+  void set_search_statistics_enabled(bool enable) {
+    collect_statistics_ = enable;
+  }
+  const std::vector<IterationStatistics>& search_statistics() const {
+    return search_statistics_;
+  }
+
+  // Pondering: while the opponent thinks, the position that follows the move
+  // predicted for the opponent can be searched on a background thread.
+  // |StartPondering()| must be called when it is the opponent's turn in
+  // |game_model|, after this instance chose the previous move. It returns
+  // |false| if there is no predicted move. When |GetNextAction()| is called,
+  // the pondering search continues if the opponent played the predicted move
+  // (ponder hit), or it is stopped otherwise (ponder miss), in which case its
+  // results are only kept in the transposition table. |StopPondering()|
+  // stops the pondering search without using its result. |ponder_state()|
+  // is the state searched by the last pondering search.
+  bool StartPondering(const game::Game& game_model);
+  void StopPondering();
+  bool is_pondering() const { return Get(ponder_thread_) != NULL; }
+  const GameState& ponder_state() const { return ponder_state_; }
+
+  // The transposition table is shared by all the searches performed by this
+  // instance, so each search starts with the results of the previous ones.
+  // Changing its size or clearing it deletes all these results and stops the
+  // pondering search, which uses the table.
+  size_t transposition_table_size() const { return trans_table_.size(); }
+  void set_transposition_table_size(size_t size);
+  void ClearTranspositionTable();
+
+  // If enabled, the symmetric positions share their entries in the
+  // transposition table and in the score cache, so a position that was
+  // searched in one orientation is not searched again in the others. The
+  // successors of each position are generated from its canonical form (see
+  // GameState::GetCanonicalState()), so the best move stored for a position
+  // is valid for all its symmetric positions. The evaluators must give the
+  // same score to the symmetric positions, like the default ones do.
+  // Changing this setting clears the transposition table. By default, it is
+  // disabled.
+  bool is_canonical_keys_enabled() const { return canonical_keys_; }
+  void set_canonical_keys_enabled(bool enable);
+
+  // If set, the positions solved by |tablebase| are not searched. The move
+  // played from a solved position is read from the tablebase, and the solved
+  // positions reached by the search are terminal states, scored by their
+  // distance to the end of the game. The tablebase is not owned and it must
+  // outlive this instance. By default, there is no tablebase.
+  const tablebase::Tablebase* tablebase() const { return tablebase_; }
+  void set_tablebase(const tablebase::Tablebase* tablebase);
+
+  // If set, the positions from |opening_book| are not searched: the move
+  // stored by the book is played instead. The book is not owned and it must
+  // outlive this instance. By default, there is no opening book.
+  const book::OpeningBook* opening_book() const { return opening_book_; }
+  void set_opening_book(const book::OpeningBook* opening_book);
 
  private:
+  class HelperDelegate;
+
+  typedef base::hash_map<GameState, int, GameStateHasher> ScoreCache;  // NOLINT
+
   // AIAlgorithm interface
   virtual game::PlayerAction GetNextAction(const game::Game& game_model);
 
   // AlphaBeta<GameState, double>::Delegate interface
   virtual bool IsTerminal(const GameState& state);
   virtual int Evaluate(const GameState& state);
+  virtual bool EvaluateBatch(const GameState* states, int count, int* scores);
   virtual void GetSuccessors(const GameState& state,
                              std::vector<GameState>* successors);
+  virtual AlphaBeta<GameState>::Delegate* CreateHelperDelegate();
+  virtual int GetMoveId(const GameState& state, const GameState& successor);
+  virtual int GetMoveCount();
+  virtual void GetNoisySuccessors(const GameState& state,
+                                  std::vector<GameState>* successors);
+  virtual uint64_t GetTranspositionKey(const GameState& state);
+
+  // Returns the state under which |state| is stored in the caches: its
+  // canonical form if the canonical keys are enabled, or |state| otherwise.
+  GameState GetCacheState(const GameState& state) const;
+
+  // The implementation of the Delegate interface, which is shared with the
+  // helper delegates. Each delegate uses its own |buffer| and |score_cache|.
+  bool IsTerminalState(const GameState& state,
+                       SuccessorBuffer* buffer,
+                       ScoreCache* score_cache) const;
+  int EvaluateState(const GameState& state, ScoreCache* score_cache) const;
+  // Evaluates the states together if the incremental evaluation is enabled.
+  // Returns false otherwise.
+  bool EvaluateStates(const GameState* states,
+                      int count,
+                      int* scores,
+                      ScoreCache* score_cache) const;
+
+  // Returns the score given to |state| by the default evaluators, computed
+  // from its incrementally updated features.
+  int EvaluateFeatures(const GameState& state) const;
+
+  // Returns the score of the solved |state|, relative to |max_player_color_|.
+  int GetTablebaseScore(const GameState& state,
+                        const tablebase::Entry& entry) const;
+
+  // If |origin| is solved by the tablebase, stores its best successor in
+  // |best_successor| and returns true.
+  bool GetTablebaseSuccessor(const GameState& origin,
+                             GameState* best_successor);
+
+  // If |origin| is in the opening book, stores the successor reached by the
+  // book move in |best_successor| and returns true.
+  bool GetBookSuccessor(const GameState& origin, GameState* best_successor);
+
+  // Creates a search configured with the settings of this instance, which
+  // collects statistics in |statistics| if they are enabled.
+  AlphaBeta<GameState>* CreateSearch(
+      std::auto_ptr<AlphaBeta<GameState>::Delegate> delegate,
+      std::vector<IterationStatistics>* statistics);
+
+  // Returns the state encoding the position from |game_model|.
+  GameState GetGameState(const game::Game& game_model) const;
+
+  // Runs the pondering search on |ponder_thread_|.
+  void Ponder();
+  void JoinPonderThread();
+
+  // Appends the successors of |state| to |successors|. They are generated
+  // each time into |buffer| instead of being cached, so that the memory used
+  // does not grow with the number of states visited during a game.
+  void GenerateSuccessors(const GameState& state,
+                          SuccessorBuffer* buffer,
+                          std::vector<GameState>* successors) const;
+
+  // Appends the noisy successors of |state| to |successors|: the ones reached
+  // by closing a mill, or by opening a mill that can be closed again by the
+  // next move of the same player.
+  void GenerateNoisySuccessors(const GameState& state,
+                               SuccessorBuffer* buffer,
+                               std::vector<GameState>* successors) const;
 
   const game::GameOptions& options_;
 
   int max_search_depth_;
-  int max_search_time_;
+  int64_t max_search_time_;
+  int64_t max_node_count_;
+  bool shuffle_;
+  base::XorShift64Star random_;
+  bool pvs_;
+  int aspiration_window_;
+  int quiescence_depth_;
+  int helper_thread_count_;
+  ParallelSearchMode parallel_search_mode_;
+  bool canonical_keys_;
+  int64_t node_count_;
+  bool collect_statistics_;
+  std::vector<IterationStatistics> search_statistics_;
 
   std::vector<Evaluator*> evaluators_;
   std::vector<int> weights_;
+  base::ptr::scoped_ptr<StateEvaluator> state_evaluator_;
+  const bool default_evaluators_;
+  bool incremental_evaluation_;
 
   GameStateTree tree_;
+  SuccessorBuffer successor_buffer_;
 
   game::BoardLocation remove_location_;
 
-  typedef base::hash_map<GameState, int, GameStateHasher> ScoreCache;  // NOLINT
+  // The scores of the states visited by the current search.
   ScoreCache score_cache_;
 
   game::PieceColor max_player_color_;
 
+  TranspositionTable<int> trans_table_;
+
+  const tablebase::Tablebase* tablebase_;
+  const book::OpeningBook* opening_book_;
+
+  // The pondering search, which runs on |ponder_thread_| and searches
+  // |ponder_state_|. Both are NULL if there is no pondering search.
+  base::ptr::scoped_ptr<AlphaBeta<GameState> > ponder_search_;
+  base::ptr::scoped_ptr<base::threading::Thread> ponder_thread_;
+  GameState ponder_state_;
+  GameState ponder_result_;
+  std::vector<IterationStatistics> ponder_statistics_;
+
   DISALLOW_COPY_AND_ASSIGN(MorrisAlphaBeta);
 };
 
@@ -16,9 +16,9 @@
 #include <vector>
 
 #include "ai/ai_algorithm.h"
-#include "ai/alphabeta/morris_alphabeta.h"
-#include "ai/alphabeta/evaluators.h"
+#include "ai/alphabeta/fused_evaluator.h"
 #include "ai/alphabeta/genetic_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
 #include "base/bind.h"
 #include "base/callable.h"
 #include "base/debug/stacktrace.h"
@@ -38,10 +38,11 @@ namespace {
 typedef std::vector<int> Weights;
 typedef std::map<Weights, int> ScoreMap;
 
-using ai::alphabeta::MorrisAlphaBeta;
-using ai::alphabeta::Evaluator;
-using ai::alphabeta::EvaluatorSignature;
+using ai::alphabeta::DefaultFeatures;
+using ai::alphabeta::FusedEvaluator;
 using ai::alphabeta::GeneticAlgorithm;
+using ai::alphabeta::MorrisAlphaBeta;
+using ai::alphabeta::StateEvaluator;
 using base::ptr::scoped_ptr;
 using base::threading::ThreadPoolForUnittests;
 
@@ -53,29 +54,11 @@ const int kMaxSearchDepth = 25;
 game::GameOptions g_game_options;
 base::threading::Lock g_scores_lock;
 
-void GetEvaluators(std::vector<Evaluator*>* evaluators) {
-  typedef int(OppEvalSig)(Evaluator*, const game::Board&, game::PieceColor);
-  using ai::alphabeta::Material;
-  using ai::alphabeta::Mills;
-  using ai::alphabeta::Mobility;
-  using ai::alphabeta::OpponentEval;
-  using base::Function;
-  evaluators->push_back(new Function<EvaluatorSignature>(&Mobility));
-  evaluators->push_back(new Function<EvaluatorSignature>(&Material));
-  evaluators->push_back(new Function<EvaluatorSignature>(&Mills));
-  evaluators->push_back(base::Bind(new Function<OppEvalSig>(&OpponentEval),
-      std::auto_ptr<Evaluator>(new Function<EvaluatorSignature>(&Mobility))));
-  evaluators->push_back(base::Bind(new Function<OppEvalSig>(&OpponentEval),
-      std::auto_ptr<Evaluator>(new Function<EvaluatorSignature>(&Material))));
-  evaluators->push_back(base::Bind(new Function<OppEvalSig>(&OpponentEval),
-      std::auto_ptr<Evaluator>(new Function<EvaluatorSignature>(&Mills))));
-}
-
 std::auto_ptr<MorrisAlphaBeta> GetPlayer(const Weights& w) {
-  std::vector<Evaluator*> evaluators;
-  GetEvaluators(&evaluators);
-  std::auto_ptr<MorrisAlphaBeta> player(
-      new MorrisAlphaBeta(g_game_options, evaluators, w));
+  // Only the weights of the default features vary, so the features are
+  // computed by the fused evaluator, in a single pass over each position.
+  std::auto_ptr<MorrisAlphaBeta> player(new MorrisAlphaBeta(g_game_options,
+      std::auto_ptr<StateEvaluator>(new FusedEvaluator<DefaultFeatures>(w))));
   player->set_max_search_depth(kMaxSearchDepth);
   player->set_max_search_time(100000000);
   return player;
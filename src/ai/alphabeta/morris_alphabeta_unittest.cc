@@ -2,9 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
 #include "ai/alphabeta/morris_alphabeta.h"
 #include "ai/alphabeta/evaluators.h"
+#include "ai/game_state.h"
 #include "ai/random/random_algorithm.h"
+#include "base/basic_macros.h"
 #include "base/function.h"
 #include "base/ptr/scoped_ptr.h"
 #include "base/random.h"
@@ -13,12 +20,17 @@
 #include "game/game.h"
 #include "game/game_options.h"
 #include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
 #include "gtest/gtest.h"
 
 namespace ai {
 namespace alphabeta {
 namespace {
 
+// The time limit used by the searches that must reach a given depth.
+const int64_t kMaxSearchTime = static_cast<int64_t>(60) * 1000000000;
+
 // Evaluator that favors pieces in the upper corner of the board.
 int TestEvaluator(const game::Board& board, game::PieceColor player) {
   const game::BoardLocation loc(board.size() - 1, board.size() - 1);
@@ -49,6 +61,245 @@ TEST(MorrisAlphaBeta, Evaluators) {
   EXPECT_EQ(upper_corner, action.destination());
 }
 
+TEST(MorrisAlphaBeta, TranspositionTable) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  game::Game test_game(options);
+  test_game.Initialize();
+  MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(4);
+  alg.set_transposition_table_size(1 << 16);
+  EXPECT_EQ(1U << 16, alg.transposition_table_size());
+  // Consecutive searches reuse the table. Clearing it must not change the
+  // fact that the returned actions are valid.
+  for (int i = 0; i < 4; ++i) {
+    if (i == 2) {
+      alg.ClearTranspositionTable();
+    }
+    game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(action));
+    test_game.ExecutePlayerAction(action);
+  }
+}
+
+void PlayWithHelperThreads(ParallelSearchMode mode) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  game::Game test_game(options);
+  test_game.Initialize();
+  MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(4);
+  alg.set_helper_thread_count(3);
+  alg.set_parallel_search_mode(mode);
+  for (int i = 0; i < 6; ++i) {
+    game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(action));
+    test_game.ExecutePlayerAction(action);
+  }
+}
+
+TEST(MorrisAlphaBeta, HelperThreads) {
+  PlayWithHelperThreads(SHARED_TRANSPOSITION_TABLE);
+}
+
+TEST(MorrisAlphaBeta, YoungBrothersWait) {
+  PlayWithHelperThreads(YOUNG_BROTHERS_WAIT);
+}
+
+typedef std::vector<std::pair<game::BoardLocation, game::BoardLocation> >
+    Moves;
+
+// Returns the number of states visited while searching, at a fixed depth,
+// positions reached by playing random moves from the start of a nine men
+// morris game. The source and the destination of the actions chosen by the
+// searches are appended to |moves|.
+int64_t SearchRandomPositions(bool pvs, int aspiration_window, Moves* moves) {
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  random::RandomAlgorithm random_player(1);
+  int64_t node_count = 0;
+  for (int i = 0; i < 8; ++i) {
+    game::Game test_game(options);
+    test_game.Initialize();
+    for (int move = 0; move < 12 + 3 * i; ++move) {
+      test_game.ExecutePlayerAction(
+          static_cast<AIAlgorithm*>(&random_player)->GetNextAction(test_game));
+    }
+    MorrisAlphaBeta alg(options);
+    alg.set_max_search_depth(5);
+    alg.set_max_search_time(kMaxSearchTime);
+    alg.set_shuffling_enabled(false);
+    alg.set_pvs_enabled(pvs);
+    alg.set_aspiration_window(aspiration_window);
+    const game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+    moves->push_back(std::make_pair(action.source(), action.destination()));
+    node_count += alg.node_count();
+  }
+  return node_count;
+}
+
+// PVS and aspiration windows must find the same moves as the plain search,
+// while visiting fewer states.
+TEST(MorrisAlphaBeta, PrincipalVariationSearchAndAspirationWindows) {
+  const int kAspirationWindow = 80;
+  Moves expected_moves;
+  const int64_t plain_nodes = SearchRandomPositions(false, 0, &expected_moves);
+  Moves moves;
+  const int64_t pvs_nodes = SearchRandomPositions(true, 0, &moves);
+  EXPECT_EQ(expected_moves, moves);
+  EXPECT_GT(plain_nodes, pvs_nodes);
+  moves.clear();
+  const int64_t aspiration_nodes =
+      SearchRandomPositions(false, kAspirationWindow, &moves);
+  EXPECT_EQ(expected_moves, moves);
+  EXPECT_GT(plain_nodes, aspiration_nodes);
+  moves.clear();
+  const int64_t combined_nodes =
+      SearchRandomPositions(true, kAspirationWindow, &moves);
+  EXPECT_EQ(expected_moves, moves);
+  EXPECT_GT(plain_nodes, combined_nodes);
+}
+
+TEST(MorrisAlphaBeta, SearchStatistics) {
+  const int kMaxDepth = 3;
+  game::GameOptions options;
+  game::Game test_game(options);
+  test_game.Initialize();
+  MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(kMaxDepth);
+  alg.set_max_search_time(kMaxSearchTime);
+  static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+  EXPECT_TRUE(alg.search_statistics().empty());
+  alg.set_search_statistics_enabled(true);
+  const game::PlayerAction action =
+      static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+  const std::vector<MorrisAlphaBeta::IterationStatistics>& statistics =
+      alg.search_statistics();
+  ASSERT_EQ(static_cast<size_t>(kMaxDepth), statistics.size());
+  for (int i = 0; i < kMaxDepth; ++i) {
+    EXPECT_EQ(i + 1, statistics[i].depth);
+    EXPECT_LT(0, statistics[i].node_count);
+    ASSERT_FALSE(statistics[i].principal_variation.empty());
+  }
+  // The principal variation starts with the chosen action.
+  const GameState& best_successor = statistics.back().principal_variation[0];
+  EXPECT_EQ(game::GetOpponent(test_game.current_player()),
+            best_successor.current_player());
+  game::Board board(options.game_type());
+  best_successor.Decode(&board);
+  EXPECT_EQ(test_game.current_player(),
+            board.GetPieceAt(action.destination()));
+}
+
+TEST(MorrisAlphaBeta, Pondering) {
+  game::GameOptions options;
+  MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(4);
+  alg.set_max_search_time(kMaxSearchTime);
+  alg.set_shuffling_enabled(false);
+  AIAlgorithm* const player = &alg;
+  for (int ponder_hit = 0; ponder_hit < 2; ++ponder_hit) {
+    game::Game test_game(options);
+    test_game.Initialize();
+    // There is no prediction before the first search.
+    EXPECT_FALSE(alg.StartPondering(test_game));
+    test_game.ExecutePlayerAction(player->GetNextAction(test_game));
+    // Pondering is only possible during the opponent's turn.
+    ASSERT_TRUE(alg.StartPondering(test_game));
+    EXPECT_TRUE(alg.is_pondering());
+    GameState state;
+    state.Encode(test_game);
+    const std::vector<game::PlayerAction> predicted_move =
+        GameState::GetTransition(state, alg.ponder_state());
+    ASSERT_EQ(1U, predicted_move.size());
+    game::PlayerAction opponent_action(predicted_move[0]);
+    if (!ponder_hit) {
+      // Place the piece somewhere else.
+      const std::vector<game::BoardLocation>& locations =
+          test_game.board().locations();
+      for (size_t i = 0; i < locations.size(); ++i) {
+        if (!(locations[i] == predicted_move[0].destination()) &&
+            test_game.board().GetPieceAt(locations[i]) == game::NO_COLOR) {
+          opponent_action.set_destination(locations[i]);
+          break;
+        }
+      }
+    }
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(opponent_action));
+    test_game.ExecutePlayerAction(opponent_action);
+    state.Encode(test_game);
+    EXPECT_EQ(ponder_hit != 0, state == alg.ponder_state());
+    const game::PlayerAction action = player->GetNextAction(test_game);
+    EXPECT_FALSE(alg.is_pondering());
+    EXPECT_LT(0, alg.node_count());
+    EXPECT_TRUE(test_game.CanExecutePlayerAction(action));
+    // Pondering can also be stopped without using its result.
+    test_game.ExecutePlayerAction(action);
+    ASSERT_TRUE(alg.StartPondering(test_game));
+    alg.StopPondering();
+    EXPECT_FALSE(alg.is_pondering());
+    // Changing the settings used by the pondering search stops it. The
+    // prediction is lost once the transposition table is cleared, so each
+    // iteration checks one of the ways to clear it.
+    ASSERT_TRUE(alg.StartPondering(test_game));
+    alg.set_incremental_evaluation_enabled(
+        alg.is_incremental_evaluation_enabled());
+    EXPECT_FALSE(alg.is_pondering());
+    ASSERT_TRUE(alg.StartPondering(test_game));
+    if (ponder_hit) {
+      alg.ClearTranspositionTable();
+    } else {
+      alg.set_transposition_table_size(alg.transposition_table_size());
+    }
+    EXPECT_FALSE(alg.is_pondering());
+  }
+}
+
+void PlacePiece(game::PieceColor color, int line, int column,
+                game::Game* game_model) {
+  game::PlayerAction action(color, game::PlayerAction::PLACE_PIECE);
+  action.set_destination(game::BoardLocation(line, column));
+  ASSERT_TRUE(game_model->CanExecutePlayerAction(action));
+  game_model->ExecutePlayerAction(action);
+}
+
+TEST(MorrisAlphaBeta, Quiescence) {
+  game::GameOptions options;
+  game::Game test_game(options);
+  test_game.Initialize();
+  // Black threatens to close the mill on the first line.
+  PlacePiece(game::WHITE_COLOR, 6, 6, &test_game);
+  PlacePiece(game::BLACK_COLOR, 0, 0, &test_game);
+  PlacePiece(game::WHITE_COLOR, 3, 1, &test_game);
+  PlacePiece(game::BLACK_COLOR, 0, 3, &test_game);
+  const game::BoardLocation kBlockingLocation(0, 6);
+  for (int quiescence_depth = 0; quiescence_depth <= 2; ++quiescence_depth) {
+    MorrisAlphaBeta alg(options);
+    alg.set_max_search_depth(1);
+    alg.set_max_search_time(kMaxSearchTime);
+    alg.set_shuffling_enabled(false);
+    alg.set_quiescence_depth(quiescence_depth);
+    alg.set_search_statistics_enabled(true);
+    const game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&alg)->GetNextAction(test_game);
+    ASSERT_EQ(1U, alg.search_statistics().size());
+    const int64_t quiescence_node_count =
+        alg.search_statistics()[0].quiescence_node_count;
+    if (quiescence_depth == 0) {
+      // A search of depth 1 does not see the threat.
+      EXPECT_EQ(0, quiescence_node_count);
+      continue;
+    }
+    // The quiescence search follows the move that closes the mill, so White
+    // blocks it.
+    EXPECT_LT(0, quiescence_node_count);
+    EXPECT_EQ(kBlockingLocation, action.destination());
+  }
+}
+
 void RunTestGame(game::GameType game_type, bool jumps_allowed) {
   const int max_moves = 250;
   game::GameOptions options;
@@ -74,6 +325,70 @@ void RunTestGame(game::GameType game_type, bool jumps_allowed) {
   EXPECT_TRUE(test_game.is_game_over());
 }
 
+TEST(MorrisAlphaBeta, IncrementalEvaluation) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  MorrisAlphaBeta incremental_alg(options);
+  EXPECT_TRUE(incremental_alg.is_incremental_evaluation_enabled());
+  MorrisAlphaBeta board_alg(options);
+  board_alg.set_incremental_evaluation_enabled(false);
+  MorrisAlphaBeta* const algorithms[] = { &incremental_alg, &board_alg };
+  for (size_t i = 0; i < arraysize(algorithms); ++i) {
+    algorithms[i]->set_max_search_depth(3);
+    algorithms[i]->set_max_search_time(kMaxSearchTime);
+    algorithms[i]->set_shuffling_enabled(false);
+  }
+  // Both modes give the same scores, so they search the same trees.
+  game::Game test_game(options);
+  test_game.Initialize();
+  for (int i = 0; i < 16 && !test_game.is_game_over(); ++i) {
+    const game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&incremental_alg)->GetNextAction(test_game);
+    const game::PlayerAction expected_action =
+        static_cast<AIAlgorithm*>(&board_alg)->GetNextAction(test_game);
+    EXPECT_EQ(board_alg.node_count(), incremental_alg.node_count());
+    ASSERT_EQ(expected_action.type(), action.type());
+    EXPECT_EQ(expected_action.source(), action.source());
+    EXPECT_EQ(expected_action.destination(), action.destination());
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(action));
+    test_game.ExecutePlayerAction(action);
+  }
+}
+
+TEST(MorrisAlphaBeta, CanonicalKeys) {
+  game::GameOptions options;
+  MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(4);
+  alg.set_max_search_time(kMaxSearchTime);
+  alg.set_shuffling_enabled(false);
+  alg.set_canonical_keys_enabled(true);
+  EXPECT_TRUE(alg.is_canonical_keys_enabled());
+  AIAlgorithm* const player = &alg;
+  game::Game test_game(options);
+  test_game.Initialize();
+  PlacePiece(game::WHITE_COLOR, 0, 0, &test_game);
+  game::PlayerAction action = player->GetNextAction(test_game);
+  EXPECT_TRUE(test_game.CanExecutePlayerAction(action));
+  const int64_t node_count = alg.node_count();
+  // The mirrored position is answered from the transposition table entries of
+  // the first one.
+  const int board_size = test_game.board().size();
+  game::Game mirrored_game(options);
+  mirrored_game.Initialize();
+  PlacePiece(game::WHITE_COLOR, board_size - 1, board_size - 1,
+             &mirrored_game);
+  action = player->GetNextAction(mirrored_game);
+  EXPECT_TRUE(mirrored_game.CanExecutePlayerAction(action));
+  EXPECT_LT(alg.node_count(), node_count);
+  // The moves found in canonical mode are real moves of the game.
+  mirrored_game.ExecutePlayerAction(action);
+  for (int i = 0; i < 6; ++i) {
+    action = player->GetNextAction(mirrored_game);
+    ASSERT_TRUE(mirrored_game.CanExecutePlayerAction(action));
+    mirrored_game.ExecutePlayerAction(action);
+  }
+}
+
 class MorrisAlphaBetaFullGameTest
     : public ::testing::TestWithParam<game::GameType> {
 };
@@ -0,0 +1,99 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/alphabeta/move_ordering.h"
+
+#include <limits>
+#include <vector>
+
+#include "base/log.h"
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+const int kHashMoveScore = std::numeric_limits<int>::max();
+const int kKillerMoveScore = kHashMoveScore - 1;
+
+// When a history score reaches this value, all the scores are halved, so that
+// the recent cutoffs weigh more than the old ones and the scores always stay
+// below the ones of the killer moves.
+const int kMaxHistoryScore = 1 << 30;
+
+}  // anonymous namespace
+
+MoveOrdering::MoveOrdering(int move_count) : history_(move_count, 0) {}
+
+void MoveOrdering::Sort(const std::vector<int>& move_ids, int hash_move,
+                        int ply, std::vector<int>* order) {
+  scores_.resize(move_ids.size());
+  for (size_t i = 0; i < move_ids.size(); ++i) {
+    scores_[i] = GetScore(move_ids[i], ply);
+  }
+  if (hash_move >= 0) {
+    DCHECK_LT(static_cast<size_t>(hash_move), scores_.size());
+    scores_[hash_move] = kHashMoveScore;
+  }
+  // Insertion sort, which is stable and does not allocate memory like
+  // std::stable_sort. There are only a few dozen successors per state.
+  std::vector<int>& moves = *order;
+  for (size_t i = 1; i < moves.size(); ++i) {
+    const int move = moves[i];
+    size_t j = i;
+    for (; j > 0 && scores_[moves[j - 1]] < scores_[move]; --j) {
+      moves[j] = moves[j - 1];
+    }
+    moves[j] = move;
+  }
+}
+
+void MoveOrdering::RecordCutoff(int move_id, int ply, int depth) {
+  if (move_id < 0 || history_.empty()) {
+    return;
+  }
+  DCHECK_LT(static_cast<size_t>(move_id), history_.size());
+  DCHECK(ply >= 0);
+  const size_t first_slot = ply * kKillerSlots;
+  if (killers_.size() < first_slot + kKillerSlots) {
+    killers_.resize(first_slot + kKillerSlots, -1);
+  }
+  if (killers_[first_slot] != move_id) {
+    for (int slot = kKillerSlots - 1; slot > 0; --slot) {
+      killers_[first_slot + slot] = killers_[first_slot + slot - 1];
+    }
+    killers_[first_slot] = move_id;
+  }
+  history_[move_id] += depth * depth;
+  if (history_[move_id] >= kMaxHistoryScore) {
+    for (size_t i = 0; i < history_.size(); ++i) {
+      history_[i] /= 2;
+    }
+  }
+}
+
+int MoveOrdering::GetHistoryScore(int move_id) const {
+  DCHECK_LT(static_cast<size_t>(move_id), history_.size());
+  return history_[move_id];
+}
+
+int MoveOrdering::GetKillerMove(int ply, int slot) const {
+  DCHECK(slot >= 0 && slot < kKillerSlots);
+  const size_t index = ply * kKillerSlots + slot;
+  return index < killers_.size() ? killers_[index] : -1;
+}
+
+int MoveOrdering::GetScore(int move_id, int ply) const {
+  if (move_id < 0 || history_.empty()) {
+    return 0;
+  }
+  for (int slot = 0; slot < kKillerSlots; ++slot) {
+    if (GetKillerMove(ply, slot) == move_id) {
+      return kKillerMoveScore - slot;
+    }
+  }
+  return history_[move_id];
+}
+
+}  // namespace alphabeta
+}  // namespace ai
@@ -0,0 +1,73 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_ALPHABETA_MOVE_ORDERING_H_
+#define AI_ALPHABETA_MOVE_ORDERING_H_
+
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "base/basic_macros.h"
+
+namespace ai {
+namespace alphabeta {
+
+// Decides the order in which the AlphaBeta search visits the successors of a
+// state. The successors are identified by the ids of the moves that lead to
+// them, as returned by |AlphaBeta::Delegate::GetMoveId()|. The order is:
+//   - the best move found by a previous search of the same state, which is
+//     stored in the transposition table (hash move);
+//   - the killer moves, which are the last moves that caused a cutoff at the
+//     same distance from the root in a different part of the tree;
+//   - the other moves, by their history score, which is increased each time a
+//     move causes a cutoff, proportionally with the depth of the subtree that
+//     was pruned.
+// Moves with equal scores keep their relative order, so they can be shuffled
+// before being ordered.
+// The killer moves and the history scores are only updated by the thread that
+// performs the search, so each search thread must use its own instance.
+class AI_EXPORT MoveOrdering {
+ public:
+  static const int kKillerSlots = 2;
+
+  // Creates the tables used for moves with ids between 0 and
+  // |move_count| - 1. If |move_count| is zero, only the hash move is used.
+  explicit MoveOrdering(int move_count);
+
+  // Sorts |order|, which contains indices in |move_ids|, so that the moves
+  // that are more likely to cause a cutoff go first. |hash_move| is the index
+  // of the hash move in |move_ids|, or -1 if there is no hash move. The
+  // successors are at the distance given by |ply| from the root of the search.
+  void Sort(const std::vector<int>& move_ids, int hash_move, int ply,
+            std::vector<int>* order);
+
+  // Records that the move identified by |move_id| caused a cutoff at |ply| in
+  // a subtree that was searched |depth| levels deep.
+  void RecordCutoff(int move_id, int ply, int depth);
+
+  // Returns the history score of the move identified by |move_id|.
+  int GetHistoryScore(int move_id) const;
+
+  // Returns the killer move from |slot| at |ply|, or -1 if there is none.
+  int GetKillerMove(int ply, int slot) const;
+
+ private:
+  // Returns the score used to sort the move identified by |move_id|.
+  int GetScore(int move_id, int ply) const;
+
+  std::vector<int> history_;
+
+  // The killer moves at each ply. The most recent one is in the first slot.
+  std::vector<int> killers_;
+
+  // Buffer used by |Sort()|, so that it does not allocate memory.
+  std::vector<int> scores_;
+
+  DISALLOW_COPY_AND_ASSIGN(MoveOrdering);
+};
+
+}  // namespace alphabeta
+}  // namespace ai
+
+#endif  // AI_ALPHABETA_MOVE_ORDERING_H_
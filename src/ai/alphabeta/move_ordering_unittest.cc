@@ -0,0 +1,80 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "ai/alphabeta/move_ordering.h"
+#include "base/basic_macros.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+std::vector<int> GetIdentityOrder(size_t size) {
+  std::vector<int> order(size);
+  for (size_t i = 0; i < size; ++i) {
+    order[i] = i;
+  }
+  return order;
+}
+
+TEST(MoveOrdering, NoMoveIds) {
+  MoveOrdering ordering(0);
+  const std::vector<int> move_ids(5, -1);
+  std::vector<int> order(GetIdentityOrder(move_ids.size()));
+  ordering.Sort(move_ids, -1, 0, &order);
+  EXPECT_EQ(GetIdentityOrder(move_ids.size()), order);
+  // The hash move goes first, the other moves keep their relative order.
+  ordering.Sort(move_ids, 3, 0, &order);
+  const int expected[] = { 3, 0, 1, 2, 4 };
+  EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)), order);
+  // Cutoffs are ignored.
+  ordering.RecordCutoff(-1, 0, 4);
+  EXPECT_EQ(-1, ordering.GetKillerMove(0, 0));
+}
+
+TEST(MoveOrdering, KillerMoves) {
+  MoveOrdering ordering(100);
+  ordering.RecordCutoff(10, 2, 1);
+  ordering.RecordCutoff(20, 2, 1);
+  ordering.RecordCutoff(20, 2, 1);
+  EXPECT_EQ(20, ordering.GetKillerMove(2, 0));
+  EXPECT_EQ(10, ordering.GetKillerMove(2, 1));
+  EXPECT_EQ(-1, ordering.GetKillerMove(1, 0));
+  EXPECT_EQ(-1, ordering.GetKillerMove(3, 0));
+  ordering.RecordCutoff(30, 2, 1);
+  EXPECT_EQ(30, ordering.GetKillerMove(2, 0));
+  EXPECT_EQ(20, ordering.GetKillerMove(2, 1));
+}
+
+TEST(MoveOrdering, Sort) {
+  MoveOrdering ordering(100);
+  // Move 50 has the highest history score, but 40 and 60 are killer moves at
+  // ply 1.
+  ordering.RecordCutoff(50, 3, 5);
+  ordering.RecordCutoff(70, 3, 2);
+  ordering.RecordCutoff(40, 1, 1);
+  ordering.RecordCutoff(60, 1, 1);
+  EXPECT_EQ(25, ordering.GetHistoryScore(50));
+  EXPECT_EQ(4, ordering.GetHistoryScore(70));
+  const int ids[] = { 10, 40, 50, 60, 70, 80 };
+  const std::vector<int> move_ids(ids, ids + arraysize(ids));
+  std::vector<int> order(GetIdentityOrder(move_ids.size()));
+  ordering.Sort(move_ids, 5, 1, &order);
+  const int expected[] = { 5, 3, 1, 2, 4, 0 };
+  EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)), order);
+  // At a different ply there are no killer moves.
+  order = GetIdentityOrder(move_ids.size());
+  ordering.Sort(move_ids, -1, 0, &order);
+  const int expected_without_killers[] = { 2, 4, 1, 3, 0, 5 };
+  EXPECT_EQ(std::vector<int>(expected_without_killers,
+                             expected_without_killers +
+                             arraysize(expected_without_killers)),
+            order);
+}
+
+}  // anonymous namespace
+}  // namespace alphabeta
+}  // namespace ai
@@ -0,0 +1,147 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the speedup of the parallel AlphaBeta search modes. Each game type
+// is searched at a fixed depth from a set of positions obtained by playing
+// random moves, using 1, 2, 4 and 8 search threads. All the searches start
+// with an empty transposition table. For each run, the benchmark reports the
+// number of visited states, the search overhead (the extra states visited
+// compared to the serial search) and the speedup.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/random/random_algorithm.h"
+#include "base/basic_macros.h"
+#include "base/debug/stacktrace.h"
+#include "base/function.h"
+#include "base/time_util.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+
+namespace {
+
+using ai::AIAlgorithm;
+using ai::alphabeta::MorrisAlphaBeta;
+using ai::alphabeta::ParallelSearchMode;
+using ai::random::RandomAlgorithm;
+
+const int kPositionCount = 8;
+const int kThreadCounts[] = { 1, 2, 4, 8 };
+
+// The searches must reach the requested depth, so the time limit is set to one
+// hour, which is never reached.
+const int64_t kMaxSearchTime = static_cast<int64_t>(3600) * 1000000000;
+
+struct BenchmarkConfig {
+  const char* name;
+  game::GameType game_type;
+  int depth;
+  // The number of random moves played before each measured search.
+  int random_moves;
+};
+
+const BenchmarkConfig kConfigs[] = {
+  { "Six men morris", game::SIX_MEN_MORRIS, 7, 6 },
+  { "Nine men morris", game::NINE_MEN_MORRIS, 6, 10 },
+};
+
+struct ParallelSearchConfig {
+  const char* name;
+  ParallelSearchMode mode;
+};
+
+const ParallelSearchConfig kParallelSearchConfigs[] = {
+  { "Shared transposition table", ai::alphabeta::SHARED_TRANSPOSITION_TABLE },
+  { "Young brothers wait", ai::alphabeta::YOUNG_BROTHERS_WAIT },
+};
+
+struct SearchResult {
+  SearchResult() : time(0), node_count(0) {}
+
+  double time;
+  int64_t node_count;
+};
+
+// Returns the total time, in seconds, and the total number of states visited
+// while searching all the positions reached by playing |config.random_moves|
+// random moves from the start of |kPositionCount| games, using |thread_count|
+// search threads.
+SearchResult RunSearches(const BenchmarkConfig& config,
+                         ParallelSearchMode mode,
+                         int thread_count) {
+  game::GameOptions options;
+  options.set_game_type(config.game_type);
+  std::srand(0);
+  RandomAlgorithm random_player(std::auto_ptr<
+      RandomAlgorithm::RandomNumberGenerator>(
+          new base::Function<int(void)>(&std::rand)));
+  SearchResult result;
+  for (int position = 0; position < kPositionCount; ++position) {
+    game::Game game_model(options);
+    game_model.Initialize();
+    for (int move = 0; move < config.random_moves; ++move) {
+      game_model.ExecutePlayerAction(
+          static_cast<AIAlgorithm*>(&random_player)->GetNextAction(
+              game_model));
+    }
+    MorrisAlphaBeta alphabeta(options);
+    alphabeta.set_max_search_depth(config.depth);
+    alphabeta.set_max_search_time(kMaxSearchTime);
+    alphabeta.set_helper_thread_count(thread_count - 1);
+    alphabeta.set_parallel_search_mode(mode);
+    const int64_t start_time = base::GetMonotonicTime();
+    static_cast<AIAlgorithm*>(&alphabeta)->GetNextAction(game_model);
+    const int64_t duration = base::GetMonotonicTime() - start_time;
+    result.time += duration / 1e9;
+    result.node_count += alphabeta.node_count();
+  }
+  return result;
+}
+
+void RunBenchmark(const BenchmarkConfig& config) {
+  std::cout << config.name << ", depth " << config.depth << std::endl;
+  const SearchResult serial =
+      RunSearches(config, ai::alphabeta::SHARED_TRANSPOSITION_TABLE, 1);
+  std::cout << "  Serial: " << std::fixed << std::setprecision(3)
+            << serial.time << " s, " << serial.node_count << " nodes"
+            << std::endl;
+  for (size_t i = 0; i < arraysize(kParallelSearchConfigs); ++i) {
+    const ParallelSearchConfig& parallel_config = kParallelSearchConfigs[i];
+    std::cout << "  " << parallel_config.name << std::endl;
+    for (size_t j = 1; j < arraysize(kThreadCounts); ++j) {
+      const SearchResult result =
+          RunSearches(config, parallel_config.mode, kThreadCounts[j]);
+      const double overhead =
+          100.0 * (result.node_count - serial.node_count) / serial.node_count;
+      std::cout << "    " << kThreadCounts[j] << " threads: "
+                << std::setprecision(3) << result.time << " s, "
+                << result.node_count << " nodes, overhead "
+                << std::setprecision(1) << overhead << "%, speedup "
+                << std::setprecision(2) << serial.time / result.time
+                << std::endl;
+    }
+  }
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  for (size_t i = 0; i < arraysize(kConfigs); ++i) {
+    RunBenchmark(kConfigs[i]);
+  }
+  return EXIT_SUCCESS;
+}
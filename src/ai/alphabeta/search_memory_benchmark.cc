@@ -0,0 +1,118 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the memory used by the AlphaBeta search. A MorrisAlphaBeta player
+// plays a nine men morris game against a random player, searching each
+// position at a fixed depth. The benchmark reports the number of heap
+// allocations per visited state and the peak resident set size of the
+// process.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/random/random_algorithm.h"
+#include "base/debug/stacktrace.h"
+#include "base/function.h"
+#include "base/time_util.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+
+namespace {
+
+using ai::AIAlgorithm;
+using ai::alphabeta::MorrisAlphaBeta;
+using ai::random::RandomAlgorithm;
+
+const int kSearchDepth = 5;
+const int kMaxMoves = 60;
+
+// The searches must reach |kSearchDepth|, so the time limit is set to one hour,
+// which is never reached.
+const int64_t kMaxSearchTime = static_cast<int64_t>(3600) * 1000000000;
+
+// Not atomic, since the searches only use the calling thread.
+int64_t g_allocation_count = 0;
+
+// The exception specification of the replaceable allocation function must
+// match the one from the standard library.
+#if __cplusplus >= 201103L
+#define NEW_EXCEPTION_SPECIFICATION
+#define DELETE_EXCEPTION_SPECIFICATION noexcept
+#else
+#define NEW_EXCEPTION_SPECIFICATION throw(std::bad_alloc)
+#define DELETE_EXCEPTION_SPECIFICATION throw()
+#endif
+
+}  // anonymous namespace
+
+void* operator new(size_t size) NEW_EXCEPTION_SPECIFICATION {
+  ++g_allocation_count;
+  void* result = malloc(size ? size : 1);
+  if (!result) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void operator delete(void* ptr) DELETE_EXCEPTION_SPECIFICATION {
+  free(ptr);
+}
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  game::Game game_model(options);
+  game_model.Initialize();
+  std::srand(0);
+  RandomAlgorithm random_player(std::auto_ptr<
+      RandomAlgorithm::RandomNumberGenerator>(
+          new base::Function<int(void)>(&std::rand)));
+  MorrisAlphaBeta alphabeta(options);
+  alphabeta.set_max_search_depth(kSearchDepth);
+  alphabeta.set_max_search_time(kMaxSearchTime);
+  alphabeta.set_shuffling_enabled(false);
+  int64_t search_allocations = 0;
+  int64_t node_count = 0;
+  double search_time = 0;
+  for (int move = 0; move < kMaxMoves && !game_model.is_game_over(); ++move) {
+    AIAlgorithm* player = &random_player;
+    if (game_model.current_player() == game::BLACK_COLOR) {
+      player = &alphabeta;
+    }
+    const int64_t allocations = g_allocation_count;
+    const int64_t start_time = base::GetMonotonicTime();
+    const game::PlayerAction action = player->GetNextAction(game_model);
+    const int64_t duration = base::GetMonotonicTime() - start_time;
+    if (player == &alphabeta) {
+      search_allocations += g_allocation_count - allocations;
+      node_count += alphabeta.node_count();
+      search_time += duration / 1e9;
+    }
+    game_model.ExecutePlayerAction(action);
+  }
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::cout << "Visited states: " << node_count << std::endl
+            << "Search time: " << search_time << " s" << std::endl
+            << "Heap allocations: " << search_allocations << " ("
+            << static_cast<double>(search_allocations) / node_count
+            << " per state)" << std::endl
+            << "Peak RSS: " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_ALPHABETA_TRANSPOSITION_TABLE_H_
+#define AI_ALPHABETA_TRANSPOSITION_TABLE_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/basic_macros.h"
+#include "base/log.h"
+#include "base/ptr/scoped_malloc_ptr.h"
+
+namespace ai {
+namespace alphabeta {
+
+// Enum used to specify how the score of a state stored in the transposition
+// table should be interpreted.
+enum EvalType {
+  // The score was obtained by calling |Delegate::Evaluate| on that state.
+  EXACT,
+  // The exact score is less than or equal to the value from the table.
+  ALPHA,
+  // The exact score is greater that or equal to the value from the table.
+  BETA
+};
+
+// Fixed-size hash table used by the AlphaBeta search to store the results of
+// the states that were already evaluated. The memory used by the table is
+// allocated once, when the table is created or resized, and does not grow
+// during the search.
+//
+// The table is an array of cache-line-aligned buckets. Each bucket has
+// |kDepthPreferredSlots| slots in which an entry is only replaced by entries
+// that were searched at least as deep, and one slot that is always replaced.
+// Each entry is also stamped with the generation of the search that stored it.
+// The table can be reused by consecutive searches: entries stored by previous
+// searches can still be found, but they are replaced first.
+// Each entry is packed in a single 64-bit word. It is stored together with the
+// XOR between the word and the key of the state, so that entries that were
+// corrupted by concurrent writers are detected and ignored by the readers. This
+// makes the table safe to be shared by multiple search threads without locks.
+//
+// The scores are stored as 32-bit integers, so the |Score| type must be
+// convertible to and from int32_t without losing information.
+template <class Score>
+class TranspositionTable {
+ public:
+  // The data stored for one state.
+  struct Entry {
+    Entry() : depth(0), score(), eval_type(EXACT), best_move(kNoBestMove) {}
+
+    int depth;
+    Score score;
+    EvalType eval_type;
+
+    // The index of the best successor, in the order in which the successors
+    // are returned by the delegate, or |kNoBestMove| if it is not known.
+    int best_move;
+  };
+
+  static const int kNoBestMove = 0xffff;
+  static const int kMaxDepth = 0xff;
+  static const size_t kDefaultSize = 16 << 20;  // 16 MB
+
+  // Creates a table that uses at most |size| bytes.
+  explicit TranspositionTable(size_t size = kDefaultSize)
+      : bucket_count_(0),
+        generation_(0) {
+    Resize(size);
+  }
+
+  // Returns the number of bytes used by the table.
+  size_t size() const { return bucket_count_ * sizeof(Bucket); }
+
+  // Reallocates the table so that it uses at most |size| bytes. The number of
+  // buckets is the largest power of two that fits in |size| bytes, or a smaller
+  // one if that many buckets cannot be allocated. All the entries are deleted.
+  void Resize(size_t size) {
+    size_t bucket_count = 1;
+    while (bucket_count * 2 * sizeof(Bucket) <= size) {
+      bucket_count *= 2;
+    }
+    if (bucket_count != bucket_count_) {
+      void* buckets = NULL;
+      // If there is not enough memory, the table uses fewer buckets.
+      while (posix_memalign(&buckets, kCacheLineSize,
+                            bucket_count * sizeof(Bucket)) != 0) {
+        if (bucket_count == 1) {
+          LOG(ERROR) << "Could not allocate the transposition table";
+          abort();
+        }
+        bucket_count /= 2;
+      }
+      Reset(buckets_, static_cast<Bucket*>(buckets));
+      bucket_count_ = bucket_count;
+    }
+    Clear();
+  }
+
+  // Deletes all the entries from the table.
+  void Clear() {
+    memset(Get(buckets_), 0, size());
+    generation_ = 0;
+  }
+
+  // Must be called at the beginning of each new search that reuses the table.
+  // All the entries stored so far become stale.
+  void NewSearch() {
+    generation_ = (generation_ + 1) & kMaxGeneration;
+  }
+
+  // Searches the entry corresponding to |key|. If it is found, the method
+  // returns |true| and fills in |entry|.
+  bool Probe(uint64_t key, Entry* entry) const {
+    const Bucket& bucket = GetBucket(key);
+    for (int i = 0; i < kSlotsPerBucket; ++i) {
+      const uint64_t data = bucket.slots[i].data;
+      if ((bucket.slots[i].check ^ data) == key && data != 0) {
+        Unpack(data, entry);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Stores the |entry| corresponding to |key|. If there is already an entry
+  // for |key| it is overwritten. Otherwise, the entry replaces the shallowest
+  // entry from the depth-preferred slots if it is at least as deep as that one,
+  // or it is stored in the always-replace slot. Stale entries are considered
+  // shallower than the entries stored by the current search.
+  void Store(uint64_t key, const Entry& entry) {
+    Bucket& bucket = GetBucket(key);
+    int slot = -1;
+    for (int i = 0; i < kSlotsPerBucket; ++i) {
+      const uint64_t data = bucket.slots[i].data;
+      if ((bucket.slots[i].check ^ data) == key && data != 0) {
+        slot = i;
+        break;
+      }
+    }
+    if (slot == -1) {
+      int shallowest = 0;
+      for (int i = 1; i < kDepthPreferredSlots; ++i) {
+        if (GetSlotDepth(bucket.slots[i]) <
+            GetSlotDepth(bucket.slots[shallowest])) {
+          shallowest = i;
+        }
+      }
+      if (GetSlotDepth(bucket.slots[shallowest]) <= entry.depth) {
+        slot = shallowest;
+      } else {
+        slot = kDepthPreferredSlots;
+      }
+    }
+    const uint64_t data = Pack(entry) |
+        (static_cast<uint64_t>(generation_) << kGenerationShift);
+    bucket.slots[slot].data = data;
+    bucket.slots[slot].check = key ^ data;
+  }
+
+ private:
+  static const int kCacheLineSize = 64;
+  static const int kSlotsPerBucket = 4;
+  static const int kDepthPreferredSlots = kSlotsPerBucket - 1;
+
+  // Layout of the 64-bit word that stores an entry. The lowest 32 bits store
+  // the score. The word is never zero for a valid entry, since the eval type is
+  // stored off by one.
+  static const int kDepthShift = 32;
+  static const int kEvalTypeShift = 40;
+  static const int kBestMoveShift = 42;
+  static const int kGenerationShift = 58;
+  static const int kMaxGeneration = 0x3f;
+
+  struct Slot {
+    volatile uint64_t check;
+    volatile uint64_t data;
+  };
+
+  struct Bucket {
+    Slot slots[kSlotsPerBucket];
+  } __attribute__((aligned(kCacheLineSize)));
+
+  static uint64_t Pack(const Entry& entry) {
+    DCHECK(entry.depth >= 0);
+    DCHECK(entry.best_move >= 0 && entry.best_move <= kNoBestMove);
+    const uint64_t depth = std::min(entry.depth, static_cast<int>(kMaxDepth));
+    return static_cast<uint32_t>(static_cast<int32_t>(entry.score)) |
+           (depth << kDepthShift) |
+           (static_cast<uint64_t>(entry.eval_type + 1) << kEvalTypeShift) |
+           (static_cast<uint64_t>(entry.best_move) << kBestMoveShift);
+  }
+
+  static void Unpack(uint64_t data, Entry* entry) {
+    entry->score = Score(static_cast<int32_t>(data & 0xffffffffULL));
+    entry->depth = GetDepth(data);
+    const int eval_type = (data >> kEvalTypeShift) & 3;
+    entry->eval_type = static_cast<EvalType>(eval_type - 1);
+    entry->best_move = (data >> kBestMoveShift) & kNoBestMove;
+  }
+
+  static int GetDepth(uint64_t data) {
+    return (data >> kDepthShift) & kMaxDepth;
+  }
+
+  // Empty slots and stale entries are considered shallower than any entry
+  // stored by the current search.
+  int GetSlotDepth(const Slot& slot) const {
+    const uint64_t data = slot.data;
+    if (!data || static_cast<int>(data >> kGenerationShift) != generation_) {
+      return -1;
+    }
+    return GetDepth(data);
+  }
+
+  const Bucket& GetBucket(uint64_t key) const {
+    return Get(buckets_)[key & (bucket_count_ - 1)];
+  }
+
+  Bucket& GetBucket(uint64_t key) {
+    return Get(buckets_)[key & (bucket_count_ - 1)];
+  }
+
+  base::ptr::scoped_malloc_ptr<Bucket> buckets_;
+  size_t bucket_count_;
+  int generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(TranspositionTable);
+};
+
+}  // namespace alphabeta
+}  // namespace ai
+
+#endif  // AI_ALPHABETA_TRANSPOSITION_TABLE_H_
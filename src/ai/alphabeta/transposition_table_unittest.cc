@@ -0,0 +1,187 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <limits>
+
+#include "ai/alphabeta/transposition_table.h"
+#include "base/bind.h"
+#include "base/function.h"
+#include "base/location.h"
+#include "base/threading/thread_pool_for_unittests.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace alphabeta {
+namespace {
+
+typedef TranspositionTable<int> Table;
+
+Table::Entry CreateEntry(int depth, int score, EvalType eval_type,
+                         int best_move) {
+  Table::Entry entry;
+  entry.depth = depth;
+  entry.score = score;
+  entry.eval_type = eval_type;
+  entry.best_move = best_move;
+  return entry;
+}
+
+void ExpectEntriesEqual(const Table::Entry& expected,
+                        const Table::Entry& actual) {
+  EXPECT_EQ(expected.depth, actual.depth);
+  EXPECT_EQ(expected.score, actual.score);
+  EXPECT_EQ(expected.eval_type, actual.eval_type);
+  EXPECT_EQ(expected.best_move, actual.best_move);
+}
+
+TEST(TranspositionTable, Size) {
+  Table table(1 << 20);
+  EXPECT_EQ(1U << 20, table.size());
+  table.Resize((1 << 16) + 100);
+  EXPECT_EQ(1U << 16, table.size());
+  table.Resize(0);
+  EXPECT_LT(0U, table.size());
+}
+
+TEST(TranspositionTable, StoreAndProbe) {
+  Table table(1 << 16);
+  Table::Entry entry;
+  EXPECT_FALSE(table.Probe(0, &entry));
+  EXPECT_FALSE(table.Probe(12345, &entry));
+  const Table::Entry entries[] = {
+    CreateEntry(0, 0, EXACT, Table::kNoBestMove),
+    CreateEntry(1, -7, ALPHA, 3),
+    CreateEntry(Table::kMaxDepth, std::numeric_limits<int>::min(), BETA, 0),
+    CreateEntry(5, std::numeric_limits<int>::max(), EXACT, 100),
+  };
+  const uint64_t keys[] = { 0, 12345, 0xffffffffffffffffULL, 1ULL << 63 };
+  for (int i = 0; i < 4; ++i) {
+    table.Store(keys[i], entries[i]);
+  }
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(table.Probe(keys[i], &entry));
+    ExpectEntriesEqual(entries[i], entry);
+  }
+  // Overwrite an existing entry with a shallower one.
+  table.Store(keys[1], entries[0]);
+  ASSERT_TRUE(table.Probe(keys[1], &entry));
+  ExpectEntriesEqual(entries[0], entry);
+  table.Clear();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(table.Probe(keys[i], &entry));
+  }
+}
+
+TEST(TranspositionTable, Replacement) {
+  // A table with a single bucket, so all the keys collide.
+  Table table(0);
+  Table::Entry entry;
+  for (int i = 1; i <= 3; ++i) {
+    table.Store(i, CreateEntry(10 + i, i, EXACT, 0));
+  }
+  // Shallower entries only go to the always-replace slot.
+  table.Store(4, CreateEntry(1, 4, EXACT, 0));
+  table.Store(5, CreateEntry(2, 5, EXACT, 0));
+  EXPECT_FALSE(table.Probe(4, &entry));
+  ASSERT_TRUE(table.Probe(5, &entry));
+  for (int i = 1; i <= 3; ++i) {
+    EXPECT_TRUE(table.Probe(i, &entry));
+  }
+  // Deeper entries replace the shallowest depth-preferred entry.
+  table.Store(6, CreateEntry(20, 6, EXACT, 0));
+  EXPECT_FALSE(table.Probe(1, &entry));
+  EXPECT_TRUE(table.Probe(2, &entry));
+  EXPECT_TRUE(table.Probe(3, &entry));
+  EXPECT_TRUE(table.Probe(5, &entry));
+  EXPECT_TRUE(table.Probe(6, &entry));
+}
+
+TEST(TranspositionTable, ZeroKey) {
+  // The empty slots match the zero key, so they must not be overwritten as if
+  // they stored its entry. The zero key is replaced like any other key.
+  const uint64_t keys[] = { 0, 4 };
+  for (int k = 0; k < 2; ++k) {
+    Table table(0);
+    Table::Entry entry;
+    EXPECT_FALSE(table.Probe(keys[k], &entry));
+    for (int i = 1; i <= 3; ++i) {
+      table.Store(i, CreateEntry(5, i, EXACT, 0));
+    }
+    table.Store(keys[k], CreateEntry(5, 7, EXACT, 0));
+    ASSERT_TRUE(table.Probe(keys[k], &entry));
+    EXPECT_EQ(7, entry.score);
+    EXPECT_FALSE(table.Probe(1, &entry)) << keys[k];
+    EXPECT_TRUE(table.Probe(2, &entry)) << keys[k];
+    EXPECT_TRUE(table.Probe(3, &entry)) << keys[k];
+  }
+}
+
+TEST(TranspositionTable, StaleEntries) {
+  Table table(0);
+  Table::Entry entry;
+  for (int i = 1; i <= 3; ++i) {
+    table.Store(i, CreateEntry(10 + i, i, EXACT, 0));
+  }
+  table.NewSearch();
+  // Stale entries can still be found, but they are replaced first.
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_TRUE(table.Probe(i, &entry));
+    EXPECT_EQ(10 + i, entry.depth);
+  }
+  table.Store(4, CreateEntry(1, 4, EXACT, 0));
+  table.Store(5, CreateEntry(1, 5, EXACT, 0));
+  EXPECT_TRUE(table.Probe(4, &entry));
+  EXPECT_TRUE(table.Probe(5, &entry));
+  EXPECT_FALSE(table.Probe(1, &entry));
+  EXPECT_FALSE(table.Probe(2, &entry));
+  EXPECT_TRUE(table.Probe(3, &entry));
+  // Entries from the current search are preferred over the stale ones.
+  table.Store(6, CreateEntry(0, 6, EXACT, 0));
+  EXPECT_FALSE(table.Probe(3, &entry));
+  EXPECT_TRUE(table.Probe(4, &entry));
+  EXPECT_TRUE(table.Probe(5, &entry));
+  EXPECT_TRUE(table.Probe(6, &entry));
+}
+
+// The score and the best move of each entry are derived from its key, so the
+// readers can check that they never get entries written partially.
+void StoreAndProbeEntries(Table* table, int thread_index, int* errors) {
+  Table::Entry entry;
+  for (uint64_t i = 0; i < 200000; ++i) {
+    const uint64_t key = (i * 0x9e3779b97f4a7c15ULL) ^ thread_index;
+    table->Store(key, CreateEntry(i % 20, static_cast<int>(key), EXACT,
+                                  key % Table::kNoBestMove));
+    const uint64_t other_key = key ^ 1;
+    const int other_best_move = other_key % Table::kNoBestMove;
+    if (table->Probe(other_key, &entry)) {
+      if (entry.score != static_cast<int>(other_key) ||
+          entry.best_move != other_best_move) {
+        ++errors[thread_index];
+      }
+    }
+  }
+}
+
+TEST(TranspositionTable, ConcurrentAccess) {
+  Table table(1 << 12);
+  base::threading::ThreadPoolForUnittests thread_pool(4);
+  int errors[4] = { 0, 0, 0, 0 };
+  thread_pool.CreateThreads();
+  for (int i = 0; i < thread_pool.thread_count(); ++i) {
+    thread_pool.SubmitTask(i, FROM_HERE,
+        base::Bind(new base::Function<void(Table*, int, int*)>(
+            &StoreAndProbeEntries), &table, i, errors));
+  }
+  thread_pool.StartThreads();
+  thread_pool.StopAndJoinThreads();
+  for (int i = 0; i < thread_pool.thread_count(); ++i) {
+    EXPECT_EQ(0, errors[i]);
+  }
+}
+
+}  // anonymous namespace
+}  // namespace alphabeta
+}  // namespace ai
@@ -0,0 +1,206 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/bitboard.h"
+
+#include "base/basic_macros.h"
+#include "base/log.h"
+#include "game/game_type.h"
+
+namespace ai {
+
+namespace {
+
+// The bit index of each location is given by the order in which the locations
+// are visited by a BFS traversal of the board, starting from (0, 0) and
+// following the adjacent locations in the order returned by
+// game::Board::GetAdjacentLocations(). This is the encoding that was used by
+// GameState before the tables were precomputed, so it must not be changed.
+const BitboardLayout kLayouts[] = {
+  {
+    game::THREE_MEN_MORRIS,
+    3,
+    9,
+    0x0001ffU,
+    { 0, 1, 0, 2, 1, 0, 2, 1, 2 },
+    { 0, 0, 1, 0, 1, 2, 1, 2, 2 },
+    {
+       0,  2,  5, -1, -1, -1, -1,
+       1,  4,  7, -1, -1, -1, -1,
+       3,  6,  8, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+    },
+    {
+      0x000006U, 0x000019U, 0x000031U, 0x000042U, 0x0000c6U, 0x000084U,
+      0x000118U, 0x000130U, 0x0000c0U,
+    },
+    6,
+    {
+      0x00000bU, 0x000025U, 0x000092U, 0x000054U, 0x000148U, 0x0001a0U,
+    },
+    {
+      { 0x00000bU, 0x000025U },
+      { 0x00000bU, 0x000092U },
+      { 0x000025U, 0x000054U },
+      { 0x00000bU, 0x000148U },
+      { 0x000092U, 0x000054U },
+      { 0x000025U, 0x0001a0U },
+      { 0x000054U, 0x000148U },
+      { 0x000092U, 0x0001a0U },
+      { 0x000148U, 0x0001a0U },
+    }
+  },
+  {
+    game::SIX_MEN_MORRIS,
+    5,
+    16,
+    0x00ffffU,
+    { 0, 2, 0, 4, 2, 1, 0, 4, 3, 1, 1, 2, 3, 4, 2, 3 },
+    { 0, 0, 2, 0, 1, 2, 4, 2, 1, 1, 3, 4, 2, 4, 3, 3 },
+    {
+       0, -1,  2, -1,  6, -1, -1,
+      -1,  9,  5, 10, -1, -1, -1,
+       1,  4, -1, 14, 11, -1, -1,
+      -1,  8, 12, 15, -1, -1, -1,
+       3, -1,  7, -1, 13, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1,
+    },
+    {
+      0x000006U, 0x000019U, 0x000061U, 0x000082U, 0x000302U, 0x000604U,
+      0x000804U, 0x003008U, 0x001010U, 0x000030U, 0x004020U, 0x006040U,
+      0x008180U, 0x000880U, 0x008c00U, 0x005000U,
+    },
+    8,
+    {
+      0x00000bU, 0x000045U, 0x002088U, 0x000310U, 0x000620U, 0x002840U,
+      0x009100U, 0x00c400U,
+    },
+    {
+      { 0x00000bU, 0x000045U },
+      { 0x00000bU, 0x000000U },
+      { 0x000045U, 0x000000U },
+      { 0x00000bU, 0x002088U },
+      { 0x000310U, 0x000000U },
+      { 0x000620U, 0x000000U },
+      { 0x000045U, 0x002840U },
+      { 0x002088U, 0x000000U },
+      { 0x000310U, 0x009100U },
+      { 0x000310U, 0x000620U },
+      { 0x000620U, 0x00c400U },
+      { 0x002840U, 0x000000U },
+      { 0x009100U, 0x000000U },
+      { 0x002088U, 0x002840U },
+      { 0x00c400U, 0x000000U },
+      { 0x009100U, 0x00c400U },
+    }
+  },
+  {
+    game::NINE_MEN_MORRIS,
+    7,
+    24,
+    0xffffffU,
+    { 0, 3, 0, 6, 3, 1, 0, 6, 5, 1, 3, 2, 1, 3, 5, 6, 4, 2, 2, 3, 4, 5, 3, 4 },
+    { 0, 0, 3, 0, 1, 3, 6, 3, 1, 1, 2, 3, 5, 6, 3, 6, 2, 2, 4, 5, 3, 5, 4, 4 },
+    {
+       0, -1, -1,  2, -1, -1,  6,
+      -1,  9, -1,  5, -1, 12, -1,
+      -1, -1, 17, 11, 18, -1, -1,
+       1,  4, 10, -1, 22, 19, 13,
+      -1, -1, 16, 20, 23, -1, -1,
+      -1,  8, -1, 14, -1, 21, -1,
+       3, -1, -1,  7, -1, -1, 15,
+    },
+    {
+      0x000006U, 0x000019U, 0x000061U, 0x000082U, 0x000702U, 0x001a04U,
+      0x002004U, 0x00c008U, 0x004010U, 0x000030U, 0x030010U, 0x060020U,
+      0x080020U, 0x088040U, 0x300180U, 0x002080U, 0x100400U, 0x000c00U,
+      0x400800U, 0x603000U, 0x814000U, 0x084000U, 0x8c0000U, 0x500000U,
+    },
+    16,
+    {
+      0x00000bU, 0x000045U, 0x000412U, 0x000824U, 0x008088U, 0x000310U,
+      0x001220U, 0x00a040U, 0x104080U, 0x204100U, 0x030400U, 0x060800U,
+      0x281000U, 0x482000U, 0x910000U, 0xc40000U,
+    },
+    {
+      { 0x00000bU, 0x000045U },
+      { 0x00000bU, 0x000412U },
+      { 0x000045U, 0x000824U },
+      { 0x00000bU, 0x008088U },
+      { 0x000412U, 0x000310U },
+      { 0x000824U, 0x001220U },
+      { 0x000045U, 0x00a040U },
+      { 0x008088U, 0x104080U },
+      { 0x000310U, 0x204100U },
+      { 0x000310U, 0x001220U },
+      { 0x000412U, 0x030400U },
+      { 0x000824U, 0x060800U },
+      { 0x001220U, 0x281000U },
+      { 0x00a040U, 0x482000U },
+      { 0x104080U, 0x204100U },
+      { 0x008088U, 0x00a040U },
+      { 0x030400U, 0x910000U },
+      { 0x030400U, 0x060800U },
+      { 0x060800U, 0xc40000U },
+      { 0x281000U, 0x482000U },
+      { 0x104080U, 0x910000U },
+      { 0x204100U, 0x281000U },
+      { 0x482000U, 0xc40000U },
+      { 0x910000U, 0xc40000U },
+    }
+  },
+};
+
+}  // anonymous namespace
+
+const BitboardLayout& GetBitboardLayout(game::GameType game_type) {
+  DCHECK_LT(static_cast<size_t>(game_type), arraysize(kLayouts));
+  DCHECK_EQ(kLayouts[game_type].game_type, game_type);
+  return kLayouts[game_type];
+}
+
+Bitboard GetPiecesInMills(const BitboardLayout& layout, Bitboard pieces) {
+  Bitboard result = 0;
+  for (int i = 0; i < layout.mill_count; ++i) {
+    if ((pieces & layout.mills[i]) == layout.mills[i]) {
+      result |= layout.mills[i];
+    }
+  }
+  return result;
+}
+
+Bitboard GetRemovablePieces(const BitboardLayout& layout, Bitboard opponent) {
+  const Bitboard removable = opponent & ~GetPiecesInMills(layout, opponent);
+  return removable ? removable : opponent;
+}
+
+Bitboard GetAdjacentLocations(const BitboardLayout& layout,
+                              Bitboard pieces,
+                              Bitboard empty) {
+  Bitboard result = 0;
+  while (pieces) {
+    const int index = LowestBitIndex(pieces);
+    pieces &= pieces - 1;
+    result |= layout.adjacency[index];
+  }
+  return result & empty;
+}
+
+int CountAdjacentMoves(const BitboardLayout& layout,
+                       Bitboard pieces,
+                       Bitboard empty) {
+  int result = 0;
+  while (pieces) {
+    const int index = LowestBitIndex(pieces);
+    pieces &= pieces - 1;
+    result += PopCount(layout.adjacency[index] & empty);
+  }
+  return result;
+}
+
+}  // namespace ai
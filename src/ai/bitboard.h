@@ -0,0 +1,175 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_BITBOARD_H_
+#define AI_BITBOARD_H_
+
+#include <stdint.h>
+
+#include "ai/ai_export.h"
+#include "base/log.h"
+#include "game/board_location.h"
+#include "game/game_type.h"
+
+namespace ai {
+
+// A bitboard is a set of board locations that stores one bit per valid
+// location. The bit index of a location is the same one that is used by
+// GameState to encode the pieces of each player, so move generation, mill
+// detection and piece counting can be performed using only mask operations.
+typedef uint32_t Bitboard;
+
+// Upper bounds for all the supported game types (NINE_MEN_MORRIS).
+const int kMaxBitboardLocations = 24;
+const int kMaxBitboardMills = 16;
+const int kMaxBitboardBoardSize = 7;
+
+// Precomputed, read-only description of the board topology for a given game
+// type. The tables are statically initialized, so they can be used without
+// any locking or lazy initialization.
+struct BitboardLayout {
+  game::GameType game_type;
+  int board_size;
+  int location_count;
+
+  // The set of all valid locations.
+  Bitboard all;
+
+  // The line and the column of each location, indexed by bit index.
+  signed char lines[kMaxBitboardLocations];
+  signed char columns[kMaxBitboardLocations];
+
+  // The bit index of each (line, column) pair, stored in row-major order with
+  // |kMaxBitboardBoardSize| columns per line. Invalid locations store -1.
+  signed char indices[kMaxBitboardBoardSize * kMaxBitboardBoardSize];
+
+  // The set of locations that are adjacent to each location.
+  Bitboard adjacency[kMaxBitboardLocations];
+
+  // All the lines of three locations that form a mill.
+  int mill_count;
+  Bitboard mills[kMaxBitboardMills];
+
+  // The (at most two) mills that contain each location. Unused slots are 0.
+  Bitboard location_mills[kMaxBitboardLocations][2];
+
+  int IndexOf(const game::BoardLocation& location) const {
+    return indices[location.line() * kMaxBitboardBoardSize + location.column()];
+  }
+
+  game::BoardLocation LocationAt(int index) const {
+    return game::BoardLocation(lines[index], columns[index]);
+  }
+};
+
+// Returns the tables corresponding to |game_type|.
+AI_EXPORT const BitboardLayout& GetBitboardLayout(game::GameType game_type);
+
+inline Bitboard BitAt(int index) {
+  return static_cast<Bitboard>(1) << index;
+}
+
+inline int PopCount(Bitboard board) {
+  return __builtin_popcount(board);
+}
+
+// Returns the index of the lowest set bit. |board| must not be empty.
+inline int LowestBitIndex(Bitboard board) {
+  return __builtin_ctz(board);
+}
+
+// Returns the index of the bit of |board| that has |n| set bits before it.
+inline int GetNthBitIndex(Bitboard board, int n) {
+  DCHECK_LT(n, PopCount(board));
+  for (; n > 0; --n) {
+    board &= board - 1;
+  }
+  return LowestBitIndex(board);
+}
+
+// Returns |true| if the piece at |index| is part of a mill formed only by the
+// locations from |pieces|. |pieces| should contain the pieces of one player.
+inline bool IsPartOfMill(const BitboardLayout& layout,
+                         Bitboard pieces,
+                         int index) {
+  const Bitboard first = layout.location_mills[index][0];
+  const Bitboard second = layout.location_mills[index][1];
+  return (first && (pieces & first) == first) ||
+         (second && (pieces & second) == second);
+}
+
+// Returns the subset of |pieces| that are part of a closed mill.
+AI_EXPORT Bitboard GetPiecesInMills(const BitboardLayout& layout,
+                                    Bitboard pieces);
+
+// Returns the pieces from |opponent| that can be removed after closing a mill.
+// Pieces that are part of a mill can only be removed if there is no other
+// option.
+AI_EXPORT Bitboard GetRemovablePieces(const BitboardLayout& layout,
+                                      Bitboard opponent);
+
+// Returns the subset of |empty| locations that are adjacent to at least one of
+// the locations from |pieces|.
+AI_EXPORT Bitboard GetAdjacentLocations(const BitboardLayout& layout,
+                                        Bitboard pieces,
+                                        Bitboard empty);
+
+// Counts the (piece, empty adjacent location) pairs, i.e. the number of
+// MOVE_PIECE actions that can be performed without jumping.
+AI_EXPORT int CountAdjacentMoves(const BitboardLayout& layout,
+                                 Bitboard pieces,
+                                 Bitboard empty);
+
+// Returns |true| if the player that has |pieces| on the board and
+// |pieces_in_hand| lost the game, because it has less than three pieces left.
+// The players that are blocked also lose, but this is only known after their
+// moves are generated.
+inline bool IsLost(Bitboard pieces, int pieces_in_hand) {
+  return PopCount(pieces) + pieces_in_hand <= 2;
+}
+
+// The functions below choose actions uniformly at random, without generating
+// all of them. |Random| can be any generator that has a NextBelow(bound)
+// method, which returns a number from [0, bound) (e.g. base::XorShift64Star).
+
+// Returns the index of a location chosen from |locations|, which must not be
+// empty.
+template <class Random>
+int GetRandomLocation(Bitboard locations, Random* random) {
+  return GetNthBitIndex(locations, random->NextBelow(PopCount(locations)));
+}
+
+// Chooses one of the moves of |pieces| to the adjacent |empty| locations and
+// stores its locations in |source| and |destination|. Returns |false| if there
+// is no such move.
+template <class Random>
+bool GetRandomAdjacentMove(const BitboardLayout& layout,
+                           Bitboard pieces,
+                           Bitboard empty,
+                           Random* random,
+                           int* source,
+                           int* destination) {
+  const int move_count = CountAdjacentMoves(layout, pieces, empty);
+  if (move_count == 0) {
+    return false;
+  }
+  int move = random->NextBelow(move_count);
+  for (; pieces; pieces &= pieces - 1) {
+    const int index = LowestBitIndex(pieces);
+    const Bitboard destinations = layout.adjacency[index] & empty;
+    const int count = PopCount(destinations);
+    if (move < count) {
+      *source = index;
+      *destination = GetNthBitIndex(destinations, move);
+      return true;
+    }
+    move -= count;
+  }
+  NOTREACHED();
+  return false;
+}
+
+}  // namespace ai
+
+#endif  // AI_BITBOARD_H_
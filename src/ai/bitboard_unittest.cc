@@ -0,0 +1,165 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "game/board.h"
+#include "game/board_location.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace {
+
+class BitboardTest : public ::testing::TestWithParam<game::GameType> {
+ public:
+  BitboardTest() : layout_(GetBitboardLayout(GetParam())) {}
+
+ protected:
+  const BitboardLayout& layout() const { return layout_; }
+
+ private:
+  const BitboardLayout& layout_;
+};
+
+TEST_P(BitboardTest, Locations) {
+  game::Board board(GetParam());
+  const std::vector<game::BoardLocation>& locations = board.locations();
+  EXPECT_EQ(GetParam(), layout().game_type);
+  EXPECT_EQ(board.size(), layout().board_size);
+  EXPECT_EQ(static_cast<int>(locations.size()), layout().location_count);
+  EXPECT_EQ(layout().location_count, PopCount(layout().all));
+  Bitboard visited = 0;
+  for (size_t i = 0; i < locations.size(); ++i) {
+    const int index = layout().IndexOf(locations[i]);
+    ASSERT_GT(index, -1) << locations[i];
+    ASSERT_LT(index, layout().location_count) << locations[i];
+    EXPECT_EQ(locations[i], layout().LocationAt(index));
+    EXPECT_FALSE(visited & BitAt(index)) << locations[i];
+    visited |= BitAt(index);
+  }
+  for (int line = 0; line < board.size(); ++line) {
+    for (int column = 0; column < board.size(); ++column) {
+      const game::BoardLocation location(line, column);
+      EXPECT_EQ(board.IsValidLocation(location),
+                layout().IndexOf(location) != -1) << location;
+    }
+  }
+}
+
+TEST_P(BitboardTest, Adjacency) {
+  game::Board board(GetParam());
+  for (int i = 0; i < layout().location_count; ++i) {
+    std::vector<game::BoardLocation> adjacent_locations;
+    board.GetAdjacentLocations(layout().LocationAt(i), &adjacent_locations);
+    Bitboard expected = 0;
+    for (size_t k = 0; k < adjacent_locations.size(); ++k) {
+      expected |= BitAt(layout().IndexOf(adjacent_locations[k]));
+    }
+    EXPECT_EQ(expected, layout().adjacency[i]) << layout().LocationAt(i);
+  }
+}
+
+TEST_P(BitboardTest, Mills) {
+  // Compare the mill tables with game::Board on random boards.
+  std::srand(0);
+  for (int test = 0; test < 200; ++test) {
+    game::Board board(GetParam());
+    GameState state(GetParam());
+    for (int i = 0; i < layout().location_count; ++i) {
+      const int value = std::rand() % 3;
+      if (value == 0) {
+        continue;
+      }
+      const game::PieceColor color =
+          (value == 1) ? game::WHITE_COLOR : game::BLACK_COLOR;
+      board.AddPiece(layout().LocationAt(i), color);
+      state.AddPiece(i, color);
+    }
+    const game::PieceColor colors[] = { game::WHITE_COLOR, game::BLACK_COLOR };
+    for (int c = 0; c < 2; ++c) {
+      const Bitboard pieces = state.pieces(colors[c]);
+      EXPECT_EQ(board.GetPieceCountByColor(colors[c]), PopCount(pieces));
+      const Bitboard in_mills = GetPiecesInMills(layout(), pieces);
+      for (int i = 0; i < layout().location_count; ++i) {
+        const game::BoardLocation location(layout().LocationAt(i));
+        const bool expected =
+            board.GetPieceAt(location) == colors[c] &&
+            board.IsPartOfMill(location);
+        EXPECT_EQ(expected, (in_mills & BitAt(i)) != 0) << location;
+        if (pieces & BitAt(i)) {
+          EXPECT_EQ(expected, IsPartOfMill(layout(), pieces, i)) << location;
+        }
+      }
+    }
+  }
+}
+
+TEST_P(BitboardTest, AdjacentMoves) {
+  const Bitboard pieces = BitAt(0) | BitAt(layout().location_count - 1);
+  const Bitboard empty = layout().all & ~pieces;
+  const Bitboard expected = (layout().adjacency[0] |
+      layout().adjacency[layout().location_count - 1]) & empty;
+  EXPECT_EQ(expected, GetAdjacentLocations(layout(), pieces, empty));
+  EXPECT_EQ(PopCount(layout().adjacency[0] & empty) +
+            PopCount(layout().adjacency[layout().location_count - 1] & empty),
+            CountAdjacentMoves(layout(), pieces, empty));
+  EXPECT_EQ(0, CountAdjacentMoves(layout(), pieces, 0));
+}
+
+// Generator that returns all the numbers below the bound in turn.
+class SequentialRandom {
+ public:
+  SequentialRandom() : next_(0) {}
+
+  uint32_t NextBelow(uint32_t bound) { return next_++ % bound; }
+
+ private:
+  uint32_t next_;
+};
+
+TEST_P(BitboardTest, RandomAdjacentMove) {
+  const Bitboard pieces = BitAt(0) | BitAt(layout().location_count - 1);
+  const Bitboard empty = layout().all & ~pieces;
+  const int move_count = CountAdjacentMoves(layout(), pieces, empty);
+  SequentialRandom random;
+  std::set<std::pair<int, int> > moves;
+  for (int i = 0; i < move_count; ++i) {
+    int source = -1;
+    int destination = -1;
+    ASSERT_TRUE(GetRandomAdjacentMove(layout(), pieces, empty, &random,
+                                      &source, &destination));
+    EXPECT_TRUE(pieces & BitAt(source));
+    EXPECT_TRUE(layout().adjacency[source] & empty & BitAt(destination));
+    moves.insert(std::make_pair(source, destination));
+  }
+  // Each move is chosen by one of the random numbers.
+  EXPECT_EQ(static_cast<size_t>(move_count), moves.size());
+  int source = -1;
+  int destination = -1;
+  EXPECT_FALSE(GetRandomAdjacentMove(layout(), pieces, 0, &random, &source,
+                                     &destination));
+  SequentialRandom location_random;
+  for (int i = 0; i < PopCount(empty); ++i) {
+    EXPECT_EQ(GetNthBitIndex(empty, i),
+              GetRandomLocation(empty, &location_random));
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(BitboardTestInstance,
+                        BitboardTest,
+                        ::testing::Values(game::THREE_MEN_MORRIS,
+                                          game::SIX_MEN_MORRIS,
+                                          game::NINE_MEN_MORRIS));
+
+}  // anonymous namespace
+}  // namespace ai
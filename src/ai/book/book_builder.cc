@@ -0,0 +1,159 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/book/book_builder.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ai/book/opening_book.h"
+#include "ai/game_state.h"
+#include "ai/state_table.h"
+#include "ai/symmetry.h"
+#include "base/file_path.h"
+#include "base/log.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace book {
+namespace {
+
+// A move played in a game: the encodings of the position and of the state
+// reached by the move, and the player who made it.
+struct PlayedMove {
+  uint64_t position;
+  uint64_t successor;
+  game::PieceColor player;
+};
+
+// Returns true if the expected score of the move with |points1| points in
+// |games1| games is better than the one of the other move.
+bool IsBetterMove(uint32_t games1, uint32_t points1,
+                  uint32_t games2, uint32_t points2) {
+  // Compares (points1 + 1) / (2 * games1 + 2) to the similar fraction of the
+  // other move. If they are equal, the move played more often is better.
+  const uint64_t score1 =
+      static_cast<uint64_t>(points1 + 1) * (2 * games2 + 2);
+  const uint64_t score2 =
+      static_cast<uint64_t>(points2 + 1) * (2 * games1 + 2);
+  if (score1 != score2) {
+    return score1 > score2;
+  }
+  return games1 > games2;
+}
+
+// The symmetric positions are stored once, in their canonical form. Returns
+// the encoding of |successor| seen from the canonical form of |position|. If
+// several symmetries move |position| to its canonical form (i.e. the position
+// is symmetric), the smallest image of |successor| is used, so the equivalent
+// moves from a symmetric position are merged.
+uint64_t GetCanonicalSuccessor(const GameState& position,
+                               const GameState& successor) {
+  int symmetry = 0;
+  const GameState canonical_position(position.GetCanonicalState(&symmetry));
+  uint64_t result = successor.GetSymmetricState(symmetry).encoding();
+  for (int i = 0; i < GetSymmetryCount(position.game_type()); ++i) {
+    if (position.GetSymmetricState(i) == canonical_position) {
+      result = std::min(result, successor.GetSymmetricState(i).encoding());
+    }
+  }
+  return result;
+}
+
+}  // anonymous namespace
+
+BookBuilder::BookBuilder(const game::GameOptions& options, int max_plies)
+    : options_(options),
+      max_plies_(max_plies),
+      game_count_(0),
+      positions_() {}
+
+BookBuilder::~BookBuilder() {}
+
+bool BookBuilder::AddGame(const game::Game& game_model) {
+  if (!(game_model.options() == options_)) {
+    return false;
+  }
+  std::vector<game::PlayerAction> actions;
+  game_model.DumpActionList(&actions);
+  game::Game replay(options_);
+  replay.Initialize();
+  GameState position;
+  position.Encode(replay);
+  std::vector<PlayedMove> moves;
+  for (size_t i = 0; i < actions.size() &&
+       static_cast<int>(moves.size()) < max_plies_; ++i) {
+    if (!replay.CanExecutePlayerAction(actions[i])) {
+      return false;
+    }
+    replay.ExecutePlayerAction(actions[i]);
+    if (replay.next_action_type() == game::PlayerAction::REMOVE_PIECE &&
+        !replay.is_game_over()) {
+      // The move continues with the removal of a piece.
+      continue;
+    }
+    const game::PieceColor player = position.current_player();
+    GameState successor;
+    successor.Encode(replay);
+    // The game does not change the player to move when it is over.
+    successor.set_current_player(game::GetOpponent(player));
+    const PlayedMove move = {
+      position.GetCanonicalState(NULL).encoding(),
+      GetCanonicalSuccessor(position, successor),
+      player
+    };
+    moves.push_back(move);
+    position = successor;
+  }
+  for (size_t i = 0; i < moves.size(); ++i) {
+    MoveStatistics& statistics =
+        positions_[moves[i].position][moves[i].successor];
+    ++statistics.games;
+    if (!game_model.is_game_over()) {
+      ++statistics.points;
+    } else if (game_model.winner() == moves[i].player) {
+      statistics.points += 2;
+    }
+  }
+  ++game_count_;
+  return true;
+}
+
+bool BookBuilder::Write(const base::FilePath& path, int min_games) const {
+  StateTableWriter writer(options_.game_type(), GetBookTableKind(options_),
+                          sizeof(BookMove));
+  for (PositionMap::const_iterator it = positions_.begin();
+       it != positions_.end(); ++it) {
+    BookMove best_move = BookMove();
+    for (MoveMap::const_iterator move_it = it->second.begin();
+         move_it != it->second.end(); ++move_it) {
+      const MoveStatistics& statistics = move_it->second;
+      if (static_cast<int>(statistics.games) >= min_games &&
+          (!best_move.games || IsBetterMove(statistics.games,
+                                            statistics.points,
+                                            best_move.games,
+                                            best_move.points))) {
+        best_move.successor = move_it->first;
+        best_move.games = statistics.games;
+        best_move.points = statistics.points;
+      }
+    }
+    if (best_move.games) {
+      writer.Set(it->first, &best_move);
+    }
+  }
+  if (!writer.Write(path)) {
+    ELOG(ERROR) << "Could not write " << path.value();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace book
+}  // namespace ai
@@ -0,0 +1,79 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_BOOK_BOOK_BUILDER_H_
+#define AI_BOOK_BOOK_BUILDER_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <map>
+
+#include "ai/ai_export.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+#include "game/game_options.h"
+
+namespace game {
+class Game;
+}
+
+namespace ai {
+namespace book {
+
+// Collects the moves played in the openings of a set of games and writes them
+// as an OpeningBook. For each position reached in the first moves of the
+// games, the builder counts how many times each move was played and the
+// points it scored: two for a win and one for a draw, for the player who made
+// the move. A game that is not over counts as a draw.
+class AI_EXPORT BookBuilder {
+ public:
+  // Only the first |max_plies| moves of each game are added to the book. A
+  // move that closes a mill and the removal that follows it are one move.
+  BookBuilder(const game::GameOptions& options, int max_plies);
+  ~BookBuilder();
+
+  // Adds the moves of |game_model|. Returns false if the game was played with
+  // other options or if one of its actions is not valid.
+  bool AddGame(const game::Game& game_model);
+
+  int game_count() const { return game_count_; }
+
+  // The number of positions for which at least one move was added.
+  size_t position_count() const { return positions_.size(); }
+
+  // Writes the book to |path|. For each position, the book stores the move
+  // with the best expected score among the moves that were played in at least
+  // |min_games| games. The expected score is computed as if each move had also
+  // been played in one win and one loss, so that the moves played in few games
+  // are not trusted too much. Returns false if the file could not be written.
+  bool Write(const base::FilePath& path, int min_games) const;
+
+ private:
+  struct MoveStatistics {
+    MoveStatistics() : games(0), points(0) {}
+
+    uint32_t games;
+    uint32_t points;
+  };
+
+  // The statistics of the moves from one position, by the encoding of the
+  // states reached by the moves.
+  typedef std::map<uint64_t, MoveStatistics> MoveMap;
+
+  // The moves of all the positions, by the encoding of the positions.
+  typedef std::map<uint64_t, MoveMap> PositionMap;
+
+  const game::GameOptions options_;
+  const int max_plies_;
+  int game_count_;
+  PositionMap positions_;
+
+  DISALLOW_COPY_AND_ASSIGN(BookBuilder);
+};
+
+}  // namespace book
+}  // namespace ai
+
+#endif  // AI_BOOK_BOOK_BUILDER_H_
@@ -0,0 +1,217 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Builds an opening book from saved games and from games played by the
+// alphabeta algorithm against itself. The book can be loaded by
+// ai::book::OpeningBook.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/book/book_builder.h"
+#include "base/command_line.h"
+#include "base/debug/stacktrace.h"
+#include "base/file_path.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_serializer.h"
+#include "game/game_type.h"
+#include "game/player_action.h"
+
+namespace {
+
+const char kGameTypeSwitch[] = "--game-type";
+const char kNoJumpsSwitch[] = "--no-jumps";
+const char kOutputSwitch[] = "--output";
+const char kMaxPliesSwitch[] = "--max-plies";
+const char kMinGamesSwitch[] = "--min-games";
+const char kSelfPlayGamesSwitch[] = "--self-play-games";
+const char kSelfPlayDepthSwitch[] = "--self-play-depth";
+const char kSeedSwitch[] = "--seed";
+const char kHelpSwitch[] = "--help";
+
+const int kDefaultMaxPlies = 12;
+const int kDefaultMinGames = 1;
+const int kDefaultSelfPlayDepth = 4;
+const int kMaxSelfPlayMoves = 250;
+
+const char kStartCommentChar = '#';
+
+void Usage() {
+  std::cout << "Usage: ai_book_builder [options] [saved game files]"
+            << std::endl;
+  std::cout << "The saved games can use the text or the binary format."
+            << std::endl;
+  std::cout << "Possible command line options:" << std::endl;
+  std::cout << "\t" << kGameTypeSwitch << "=3|6|9" << std::endl;
+  std::cout << "\t\t" << "Specifies the game type: three/six/nine men morris."
+            << std::endl;
+  std::cout << "\t" << kNoJumpsSwitch << std::endl;
+  std::cout << "\t\t" << "Builds the book for the game in which the players "
+            << "with three pieces cannot jump." << std::endl;
+  std::cout << "\t" << kOutputSwitch << "=<path>" << std::endl;
+  std::cout << "\t\t" << "The file where the book is written. Required."
+            << std::endl;
+  std::cout << "\t" << kMaxPliesSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The number of moves from the start of each game "
+            << "that are added to the book. Default: " << kDefaultMaxPlies
+            << "." << std::endl;
+  std::cout << "\t" << kMinGamesSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The book only stores the moves played in at least "
+            << "this many games. Default: " << kDefaultMinGames << "."
+            << std::endl;
+  std::cout << "\t" << kSelfPlayGamesSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The number of games played by the alphabeta "
+            << "algorithm against itself. Default: 0." << std::endl;
+  std::cout << "\t" << kSelfPlayDepthSwitch << "=<depth>" << std::endl;
+  std::cout << "\t\t" << "The search depth used by the self-play games. "
+            << "Default: " << kDefaultSelfPlayDepth << "." << std::endl;
+  std::cout << "\t" << kSeedSwitch << "=<seed>" << std::endl;
+  std::cout << "\t\t" << "The seed of the self-play games. The games are the "
+            << "same for a given seed. Default: 0." << std::endl;
+  std::cout << "\t" << kHelpSwitch << std::endl;
+  std::cout << "\t\t" << "Displays this help message and exits." << std::endl;
+}
+
+int GetIntSwitch(const base::CommandLine& cmd_line,
+                 const std::string& switch_name,
+                 int default_value) {
+  if (!cmd_line.HasSwitch(switch_name)) {
+    return default_value;
+  }
+  return std::atoi(cmd_line.GetSwitchValue(switch_name).c_str());
+}
+
+// Loads a game saved by game::GameSerializer. The text files can contain
+// comment lines, which start with '#'.
+std::auto_ptr<game::Game> LoadGame(const base::FilePath& path) {
+  std::ifstream in(path.value().c_str(), std::ios_base::binary);
+  const std::string contents((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+  size_t start = contents.find_first_not_of(" \t\r\n");
+  const bool use_binary = start != std::string::npos &&
+      contents[start] != kStartCommentChar &&
+      !std::isdigit(static_cast<unsigned char>(contents[start]));
+  if (use_binary) {
+    std::istringstream binary_in(contents, std::ios_base::binary);
+    return game::GameSerializer::DeserializeFrom(&binary_in, true);
+  }
+  std::stringstream text_in;
+  std::istringstream lines(contents);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty() || line[0] != kStartCommentChar) {
+      text_in << line << std::endl;
+    }
+  }
+  return game::GameSerializer::DeserializeFrom(&text_in, false);
+}
+
+// Plays a game between two instances of the alphabeta algorithm, which
+// shuffle the moves with equal scores so the games are different. The players
+// are seeded with |seed| and |seed| + 1, and their searches are limited only
+// by |depth|, so the game depends only on these.
+void PlaySelfPlayGame(const game::GameOptions& options, int depth,
+                      uint64_t seed, game::Game* game_model) {
+  ai::alphabeta::MorrisAlphaBeta white(options);
+  ai::alphabeta::MorrisAlphaBeta black(options);
+  ai::alphabeta::MorrisAlphaBeta* const players[] = { &white, &black };
+  for (int i = 0; i < 2; ++i) {
+    players[i]->set_max_search_depth(depth);
+    players[i]->set_max_search_time(0x7fffffffffffffffLL);
+    players[i]->set_shuffling_enabled(true);
+    players[i]->set_seed(seed + i);
+  }
+  game_model->Initialize();
+  for (int i = 0; i < kMaxSelfPlayMoves && !game_model->is_game_over(); ++i) {
+    ai::AIAlgorithm* const player =
+        players[game_model->current_player() == game::WHITE_COLOR ? 0 : 1];
+    game_model->ExecutePlayerAction(player->GetNextAction(*game_model));
+  }
+}
+
+bool RunBookBuilder(const base::CommandLine& cmd_line) {
+  game::GameOptions options;
+  if (cmd_line.HasSwitch(kGameTypeSwitch)) {
+    const std::string game_type(cmd_line.GetSwitchValue(kGameTypeSwitch));
+    if (game_type == "3") {
+      options.set_game_type(game::THREE_MEN_MORRIS);
+    } else if (game_type == "6") {
+      options.set_game_type(game::SIX_MEN_MORRIS);
+    } else if (game_type == "9") {
+      options.set_game_type(game::NINE_MEN_MORRIS);
+    } else {
+      Usage();
+      return false;
+    }
+  }
+  options.set_jumps_allowed(!cmd_line.HasSwitch(kNoJumpsSwitch));
+  const int max_plies = GetIntSwitch(cmd_line, kMaxPliesSwitch,
+                                     kDefaultMaxPlies);
+  const int min_games = GetIntSwitch(cmd_line, kMinGamesSwitch,
+                                     kDefaultMinGames);
+  const int self_play_games = GetIntSwitch(cmd_line, kSelfPlayGamesSwitch, 0);
+  const int self_play_depth = GetIntSwitch(cmd_line, kSelfPlayDepthSwitch,
+                                           kDefaultSelfPlayDepth);
+  const uint32_t seed = GetIntSwitch(cmd_line, kSeedSwitch, 0);
+  if (!cmd_line.HasSwitch(kOutputSwitch) || max_plies < 1 || min_games < 1 ||
+      self_play_games < 0 || self_play_depth < 1) {
+    Usage();
+    return false;
+  }
+  ai::book::BookBuilder builder(options, max_plies);
+  const std::vector<std::string> saved_games(cmd_line.GetArguments());
+  for (size_t i = 0; i < saved_games.size(); ++i) {
+    const std::auto_ptr<game::Game> saved_game(
+        LoadGame(base::FilePath(saved_games[i])));
+    if (!saved_game.get() || !builder.AddGame(*saved_game)) {
+      std::cerr << "Skipped " << saved_games[i] << std::endl;
+    }
+  }
+  for (int i = 0; i < self_play_games; ++i) {
+    game::Game self_play_game(options);
+    PlaySelfPlayGame(options, self_play_depth, seed + 2 * i,
+                     &self_play_game);
+    builder.AddGame(self_play_game);
+    std::cerr.put('.');
+  }
+  if (self_play_games) {
+    std::cerr << std::endl;
+  }
+  std::cout << "Added " << builder.game_count() << " games, "
+            << builder.position_count() << " positions" << std::endl;
+  return builder.Write(base::FilePath(cmd_line.GetSwitchValue(kOutputSwitch)),
+                       min_games);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  cmd_line->Init(argc, argv);
+  bool result = true;
+  if (cmd_line->HasSwitch(kHelpSwitch)) {
+    Usage();
+  } else {
+    result = RunBookBuilder(*cmd_line);
+  }
+  base::CommandLine::DeleteForCurrentProcess();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/book/opening_book.h"
+
+#include <stdint.h>
+
+#include "ai/game_state.h"
+#include "ai/state_table.h"
+#include "base/file_path.h"
+#include "base/log.h"
+#include "game/game_options.h"
+
+namespace ai {
+namespace book {
+namespace {
+
+// The books written before the positions were canonicalized used "BOOK".
+const uint32_t kBookTableKind = 0x324b4f42;  // "BOK2"
+
+}  // anonymous namespace
+
+uint32_t GetBookTableKind(const game::GameOptions& options) {
+  // The moves of the positions reached by the same placements can differ if
+  // the players with three pieces are not allowed to jump.
+  return kBookTableKind ^ (options.jumps_allowed() ? 0 : 1);
+}
+
+OpeningBook::OpeningBook(const game::GameOptions& options)
+    : options_(options), table_() {}
+
+OpeningBook::~OpeningBook() {}
+
+bool OpeningBook::Open(const base::FilePath& path) {
+  DCHECK(!IsOpen());
+  if (!table_.Open(path, GetBookTableKind(options_))) {
+    return false;
+  }
+  if (table_.game_type() != options_.game_type() ||
+      table_.value_size() != sizeof(BookMove)) {
+    ELOG(ERROR) << "Invalid opening book " << path.value();
+    table_.Close();
+    return false;
+  }
+  return true;
+}
+
+const BookMove* OpeningBook::Find(const GameState& state,
+                                  int* symmetry) const {
+  DCHECK(symmetry);
+  if (!IsOpen()) {
+    return NULL;
+  }
+  return static_cast<const BookMove*>(
+      table_.Find(state.GetCanonicalState(symmetry)));
+}
+
+}  // namespace book
+}  // namespace ai
@@ -0,0 +1,80 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_BOOK_OPENING_BOOK_H_
+#define AI_BOOK_OPENING_BOOK_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "ai/state_table.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+#include "game/game_options.h"
+
+namespace ai {
+namespace book {
+
+// The move stored by the opening book for one position, together with the
+// statistics of the games in which it was played.
+struct BookMove {
+  // The encoding of the state reached by the move (see GameState::encoding()),
+  // in the orientation of the canonical position that stores the move.
+  uint64_t successor;
+
+  // The number of games in which the move was played from the position.
+  uint32_t games;
+
+  // The points scored in these games by the player who made the move: two for
+  // each win and one for each draw.
+  uint32_t points;
+};
+
+// Returns the kind of the StateTable that stores an opening book for the
+// given |options|.
+AI_EXPORT uint32_t GetBookTableKind(const game::GameOptions& options);
+
+// An opening book written by the BookBuilder. The book is memory-mapped, so
+// opening it takes the same time for any book size and its moves are read in
+// place. Find() does not change the book, so it can be called from multiple
+// threads.
+class AI_EXPORT OpeningBook {
+ public:
+  explicit OpeningBook(const game::GameOptions& options);
+  ~OpeningBook();
+
+  // Opens the book from |path|. Returns false if it is not a valid book for
+  // the game options of this instance.
+  bool Open(const base::FilePath& path);
+
+  bool IsOpen() const { return table_.IsOpen(); }
+
+  const game::GameOptions& options() const { return options_; }
+
+  // The number of positions from the book.
+  size_t size() const { return table_.size(); }
+
+  // Returns the move stored for |state|, or NULL if |state| is not in the
+  // book. The result points into the mapped book. The book stores the
+  // canonical form of each position (see GameState::GetCanonicalState()), so
+  // the symmetric positions share their move. |symmetry| receives the
+  // symmetry that moves |state| to the stored position: the successor stored
+  // by the move is the image of one of the successors of |state| by this
+  // symmetry.
+  const BookMove* Find(const GameState& state, int* symmetry) const;
+
+ private:
+  const game::GameOptions options_;
+  StateTable table_;
+
+  DISALLOW_COPY_AND_ASSIGN(OpeningBook);
+};
+
+}  // namespace book
+}  // namespace ai
+
+#endif  // AI_BOOK_OPENING_BOOK_H_
@@ -0,0 +1,230 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <sstream>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/book/book_builder.h"
+#include "ai/book/opening_book.h"
+#include "ai/game_state.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "game/board_location.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_serializer.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace book {
+namespace {
+
+void PlacePiece(int line, int column, game::Game* game_model) {
+  game::PlayerAction action(game_model->current_player(),
+                            game::PlayerAction::PLACE_PIECE);
+  action.set_destination(game::BoardLocation(line, column));
+  ASSERT_TRUE(game_model->CanExecutePlayerAction(action));
+  game_model->ExecutePlayerAction(action);
+}
+
+void RemovePiece(int line, int column, game::Game* game_model) {
+  game::PlayerAction action(game_model->current_player(),
+                            game::PlayerAction::REMOVE_PIECE);
+  action.set_source(game::BoardLocation(line, column));
+  ASSERT_TRUE(game_model->CanExecutePlayerAction(action));
+  game_model->ExecutePlayerAction(action);
+}
+
+class OpeningBookTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    options_.set_game_type(game::THREE_MEN_MORRIS);
+    ASSERT_TRUE(temp_dir_.Create());
+    book_path_ = temp_dir_.Get().Append("book.bin");
+  }
+
+  OpeningBookTest() : temp_dir_("opening_book_unittest") {}
+
+  // Adds three games to |builder|. In the first one, white starts in a corner
+  // and wins. In the others, white starts in the center and they are draws.
+  void AddGames(BookBuilder* builder) {
+    game::Game won_game(options_);
+    won_game.Initialize();
+    PlacePiece(0, 0, &won_game);
+    PlacePiece(1, 1, &won_game);
+    PlacePiece(0, 1, &won_game);
+    PlacePiece(2, 2, &won_game);
+    PlacePiece(0, 2, &won_game);
+    RemovePiece(1, 1, &won_game);
+    ASSERT_TRUE(won_game.is_game_over());
+    ASSERT_EQ(game::WHITE_COLOR, won_game.winner());
+    EXPECT_TRUE(builder->AddGame(won_game));
+    for (int column = 0; column < 3; column += 2) {
+      game::Game unfinished_game(options_);
+      unfinished_game.Initialize();
+      PlacePiece(1, 1, &unfinished_game);
+      PlacePiece(0, column, &unfinished_game);
+      EXPECT_TRUE(builder->AddGame(unfinished_game));
+    }
+  }
+
+  game::GameOptions options_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath book_path_;
+};
+
+TEST_F(OpeningBookTest, BestMoves) {
+  BookBuilder builder(options_, 2);
+  AddGames(&builder);
+  EXPECT_EQ(3, builder.game_count());
+  // The start, the corner and the center positions.
+  EXPECT_EQ(3U, builder.position_count());
+  ASSERT_TRUE(builder.Write(book_path_, 1));
+  OpeningBook book(options_);
+  ASSERT_TRUE(book.Open(book_path_));
+  EXPECT_EQ(3U, book.size());
+
+  game::Game test_game(options_);
+  test_game.Initialize();
+  GameState start;
+  start.Encode(test_game);
+  // The win in the corner is better than the two draws in the center.
+  int symmetry = -1;
+  const BookMove* move = book.Find(start, &symmetry);
+  ASSERT_TRUE(move != NULL);
+  EXPECT_EQ(0, symmetry);
+  EXPECT_EQ(1U, move->games);
+  EXPECT_EQ(2U, move->points);
+  PlacePiece(0, 0, &test_game);
+  GameState state;
+  state.Encode(test_game);
+  EXPECT_EQ(state.encoding(), move->successor);
+  move = book.Find(state, &symmetry);
+  ASSERT_TRUE(move != NULL);
+  EXPECT_EQ(0U, move->points);
+  // The move is stored in the orientation of the canonical position.
+  game::Game reply_game(options_);
+  reply_game.Initialize();
+  PlacePiece(0, 0, &reply_game);
+  PlacePiece(1, 1, &reply_game);
+  state.Encode(reply_game);
+  EXPECT_EQ(state.GetSymmetricState(symmetry).encoding(), move->successor);
+  // The other corners share the entry of the first one.
+  game::Game corner_game(options_);
+  corner_game.Initialize();
+  PlacePiece(2, 2, &corner_game);
+  state.Encode(corner_game);
+  EXPECT_EQ(move, book.Find(state, &symmetry));
+  // The moves after the first two are not in the book.
+  PlacePiece(1, 1, &test_game);
+  state.Encode(test_game);
+  EXPECT_TRUE(book.Find(state, &symmetry) == NULL);
+
+  // The center move was played in two games, and the two corner replies to it
+  // are the same move after the symmetries are removed.
+  ASSERT_TRUE(builder.Write(book_path_, 2));
+  OpeningBook min_games_book(options_);
+  ASSERT_TRUE(min_games_book.Open(book_path_));
+  EXPECT_EQ(2U, min_games_book.size());
+  move = min_games_book.Find(start, &symmetry);
+  ASSERT_TRUE(move != NULL);
+  EXPECT_EQ(2U, move->games);
+  EXPECT_EQ(2U, move->points);
+  game::Game center_game(options_);
+  center_game.Initialize();
+  PlacePiece(1, 1, &center_game);
+  state.Encode(center_game);
+  move = min_games_book.Find(state, &symmetry);
+  ASSERT_TRUE(move != NULL);
+  EXPECT_EQ(2U, move->games);
+}
+
+TEST_F(OpeningBookTest, GameOptions) {
+  BookBuilder builder(options_, 2);
+  game::Game six_men_game;
+  six_men_game.Initialize();
+  EXPECT_FALSE(builder.AddGame(six_men_game));
+  EXPECT_EQ(0, builder.game_count());
+  AddGames(&builder);
+  ASSERT_TRUE(builder.Write(book_path_, 1));
+  game::GameOptions no_jumps_options(options_);
+  no_jumps_options.set_jumps_allowed(false);
+  OpeningBook no_jumps_book(no_jumps_options);
+  EXPECT_FALSE(no_jumps_book.Open(book_path_));
+  game::GameOptions six_men_options;
+  six_men_options.set_game_type(game::SIX_MEN_MORRIS);
+  OpeningBook six_men_book(six_men_options);
+  EXPECT_FALSE(six_men_book.Open(book_path_));
+  EXPECT_FALSE(six_men_book.IsOpen());
+  int symmetry = 0;
+  EXPECT_TRUE(six_men_book.Find(GameState(game::SIX_MEN_MORRIS), &symmetry) ==
+              NULL);
+}
+
+TEST_F(OpeningBookTest, SavedGames) {
+  game::Game won_game(options_);
+  won_game.Initialize();
+  PlacePiece(0, 0, &won_game);
+  PlacePiece(1, 1, &won_game);
+  PlacePiece(0, 1, &won_game);
+  PlacePiece(2, 2, &won_game);
+  PlacePiece(0, 2, &won_game);
+  RemovePiece(1, 1, &won_game);
+  BookBuilder builder(options_, 10);
+  for (int use_binary = 0; use_binary < 2; ++use_binary) {
+    std::stringstream saved_game;
+    game::GameSerializer::SerializeTo(won_game, &saved_game, use_binary);
+    const std::auto_ptr<game::Game> loaded_game(
+        game::GameSerializer::DeserializeFrom(&saved_game, use_binary));
+    ASSERT_TRUE(loaded_game.get() != NULL);
+    EXPECT_TRUE(builder.AddGame(*loaded_game));
+  }
+  EXPECT_EQ(2, builder.game_count());
+  // The last move ends the game.
+  EXPECT_EQ(5U, builder.position_count());
+}
+
+TEST_F(OpeningBookTest, MorrisAlphaBeta) {
+  BookBuilder builder(options_, 2);
+  AddGames(&builder);
+  ASSERT_TRUE(builder.Write(book_path_, 1));
+  OpeningBook book(options_);
+  ASSERT_TRUE(book.Open(book_path_));
+  alphabeta::MorrisAlphaBeta alg(options_);
+  alg.set_max_search_depth(4);
+  alg.set_opening_book(&book);
+  AIAlgorithm* const player = &alg;
+  game::Game test_game(options_);
+  test_game.Initialize();
+  game::PlayerAction action(player->GetNextAction(test_game));
+  EXPECT_EQ(0, alg.node_count());
+  EXPECT_EQ(game::PlayerAction::PLACE_PIECE, action.type());
+  EXPECT_EQ(game::BoardLocation(0, 0), action.destination());
+  test_game.ExecutePlayerAction(action);
+  action = player->GetNextAction(test_game);
+  EXPECT_EQ(0, alg.node_count());
+  EXPECT_EQ(game::BoardLocation(1, 1), action.destination());
+  test_game.ExecutePlayerAction(action);
+  // Out of book, the position is searched.
+  action = player->GetNextAction(test_game);
+  EXPECT_LT(0, alg.node_count());
+  EXPECT_TRUE(test_game.CanExecutePlayerAction(action));
+
+  // The book answers the symmetric positions with the symmetric moves.
+  game::Game corner_game(options_);
+  corner_game.Initialize();
+  PlacePiece(2, 0, &corner_game);
+  action = player->GetNextAction(corner_game);
+  EXPECT_EQ(0, alg.node_count());
+  EXPECT_EQ(game::BoardLocation(1, 1), action.destination());
+}
+
+}  // anonymous namespace
+}  // namespace book
+}  // namespace ai
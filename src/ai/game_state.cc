@@ -6,33 +6,109 @@
 
 #include <stdint.h>
 
-#include <bitset>
-#include <map>
-#include <queue>
-#include <utility>
 #include <vector>
 
+#include "ai/bitboard.h"
+#include "ai/symmetry.h"
 #include "base/log.h"
-#include "base/threading/lock.h"
-#include "base/threading/scoped_guard.h"
 #include "game/board.h"
 #include "game/board_location.h"
+#include "game/game.h"
 #include "game/game_type.h"
 #include "game/piece_color.h"
 #include "game/player_action.h"
 
-using game::BoardLocation;
-
-using std::map;
-
 namespace ai {
 
 namespace {
 
 const int kLocationsOffset = 9;
+const uint64_t kCurrentPlayerMask = 0x1ULL;
+const uint64_t kWhitePiecesInHandMask = 0x1eULL;
+const uint64_t kBlackPiecesInHandMask = 0x1e0ULL;
+const uint64_t kHeaderMask = 0x1ffULL;
+
+// Random numbers used to compute the Zobrist key of a game state. There is one
+// number for each (player, location) pair, one for each (player, number of
+// pieces in hand) pair and one that is used if black is the current player.
+// The numbers corresponding to zero pieces in hand are zero, so that the key of
+// a default constructed state is zero.
+const uint64_t kZobristPieces[2][kMaxBitboardLocations] = {
+  {
+    0xc584133ac916ab3cULL, 0x3ee5789041c98ac3ULL, 0xf3b8488c368cb0a6ULL,
+    0x657eecdd3cb13d09ULL, 0xc2d326e0055bdef6ULL, 0x8621a03fe0bbdb7bULL,
+    0x8e1f7555983aa92fULL, 0xb54e0f1600cc4d19ULL, 0x84bb3f97971d80abULL,
+    0x7d29825c75521255ULL, 0xc3cf17102b7f7f86ULL, 0x3466e9a083914f64ULL,
+    0xd81a8d2b5a4485acULL, 0xdb01602b100b9ed7ULL, 0xa9038a921825f10dULL,
+    0xedf5f1d90dca2f6aULL, 0x54496ad67bd2634cULL, 0xdd7c01d4f5407269ULL,
+    0x935e82f1db4c4f7bULL, 0x69b82ebc92233300ULL, 0x40d29eb57de1d510ULL,
+    0xa2f09dabb45c6316ULL, 0xee521d7a0f4d3872ULL, 0xf16952ee72f3454fULL,
+  },
+  {
+    0x377d35dea8e40225ULL, 0x0c7de8064963bab0ULL, 0x05582d37111ac529ULL,
+    0xd254741f599dc6f7ULL, 0x69630f7593d108c3ULL, 0x417ef96181daa383ULL,
+    0x3c3c41a3b43343a1ULL, 0x6e19905dcbe531dfULL, 0x4fa9fa7324851729ULL,
+    0x84eb4454a792922aULL, 0x134f7096918175ceULL, 0x07dc930b302278a8ULL,
+    0x12c015a97019e937ULL, 0xcc06c31652ebf438ULL, 0xecee65630a691e37ULL,
+    0x3e84ecb1763e79adULL, 0x690ed476743aae49ULL, 0x774615d7b1a1f2e1ULL,
+    0x22b353f04f4f52daULL, 0xe3ddd86ba71a5eb1ULL, 0xdf268adeb6513356ULL,
+    0x2098eb73d4367d77ULL, 0x03d6845323ce3c71ULL, 0xc952c5620043c714ULL,
+  }
+};
+
+const uint64_t kZobristPiecesInHand[2][16] = {
+  {
+    0x0000000000000000ULL, 0x30260345dd9e0ec1ULL, 0xcf448a5882bb9698ULL,
+    0xf4a578dccbc87656ULL, 0xbfdeaed9a17b3c8fULL, 0xed79402d1d5c5d7bULL,
+    0x55f070ab1cbbf170ULL, 0x3e00a34929a88f1dULL, 0xe255b237b8bb18fbULL,
+    0x2a7b67af6c6ad50eULL, 0x466d5e7f3e46f143ULL, 0x42375cb399a4fc72ULL,
+    0x8c8a1f148a8bb259ULL, 0x32fcab5daed5bdfcULL, 0x9e60398c8d8553c0ULL,
+    0xee89cceb8c4064c0ULL,
+  },
+  {
+    0x0000000000000000ULL, 0x5ccde78203c367a8ULL, 0xf1bcbc6a1ec11786ULL,
+    0xef054fceee954551ULL, 0xdf82012d0555c6dfULL, 0x292566ff72403c08ULL,
+    0xc4dd302a1bfa1137ULL, 0xd85f219db5c554e1ULL, 0x6a27ff807441bcd2ULL,
+    0x96a573e9b48216e8ULL, 0x46a9fdac40bf0048ULL, 0x3dd12464a0ee15b4ULL,
+    0x451e521296a7eea1ULL, 0x56e4398a98f8a0fdULL, 0x7b7dc2160e3335a7ULL,
+    0xc679ee0bebcb1ccaULL,
+  }
+};
+
+const uint64_t kZobristBlackToMove = 0x928d6f2d7453424eULL;
+
+int GetZobristColorIndex(const game::PieceColor color) {
+  DCHECK(color != game::NO_COLOR);
+  return color == game::WHITE_COLOR ? 0 : 1;
+}
 
-map<game::GameType, map<BoardLocation, int> > g_indices_cache;
-base::threading::Lock g_indices_cache_lock;
+// Returns the part of the Zobrist key that corresponds to the |pieces| of the
+// player given by |color|.
+uint64_t GetPiecesKey(const game::PieceColor color, Bitboard pieces) {
+  const uint64_t* keys = kZobristPieces[GetZobristColorIndex(color)];
+  uint64_t result = 0;
+  while (pieces) {
+    result ^= keys[LowestBitIndex(pieces)];
+    pieces &= pieces - 1;
+  }
+  return result;
+}
+
+// Returns the number of |pieces| that are part of a closed mill, among the
+// pieces that share a mill with the location given by |index|.
+int CountPiecesInMillsAround(const BitboardLayout& layout,
+                             Bitboard pieces,
+                             int index) {
+  Bitboard around =
+      (layout.location_mills[index][0] | layout.location_mills[index][1]) &
+      pieces;
+  int result = 0;
+  while (around) {
+    result += IsPartOfMill(layout, pieces, LowestBitIndex(around));
+    around &= around - 1;
+  }
+  return result;
+}
 
 game::GameType GetGameTypeFromBoardSize(int board_size) {
   switch (board_size) {
@@ -49,86 +125,80 @@ game::GameType GetGameTypeFromBoardSize(int board_size) {
   return game::THREE_MEN_MORRIS;
 }
 
-const map<BoardLocation, int>& GetLocationIndices(game::GameType type) {
-  map<game::GameType, map<BoardLocation, int> >::iterator it =
-      g_indices_cache.find(type);
-  if (it == g_indices_cache.end()) {
-    map<BoardLocation, int> indices;
-    game::Board board(type);
-    std::queue<BoardLocation> bfs_queue;
-    const BoardLocation start(0, 0);
-    int index = 0;
-    indices.insert(std::make_pair(start, index++));
-    bfs_queue.push(start);
-    while (!bfs_queue.empty()) {
-      const BoardLocation current = bfs_queue.front();
-      bfs_queue.pop();
-      std::vector<BoardLocation> adjacent_locations;
-      board.GetAdjacentLocations(current, &adjacent_locations);
-      for (size_t i = 0; i < adjacent_locations.size(); ++i) {
-        if (indices.count(adjacent_locations[i]) == 0) {
-          indices.insert(std::make_pair(adjacent_locations[i], index++));
-          bfs_queue.push(adjacent_locations[i]);
-        }
-      }
-    }
-    {
-      base::threading::ScopedGuard _(&g_indices_cache_lock);
-      it = g_indices_cache.find(type);
-      if (it == g_indices_cache.end()) {
-        it = g_indices_cache.insert(std::make_pair(type, indices)).first;
-      }
-    }
-  }
-  return it->second;
-}
-
 }  // anonymous namespace
 
-GameState::GameState(game::GameType game_type) : game_type_(game_type), s_() {}
+GameState::GameState(game::GameType game_type)
+    : game_type_(game_type), s_(0), key_(0) {
+  mobility_[0] = mobility_[1] = 0;
+  pieces_in_mills_[0] = pieces_in_mills_[1] = 0;
+}
 
 GameState::GameState(const GameState& other)
-    : game_type_(other.game_type_), s_(other.s_) {}
+    : game_type_(other.game_type_), s_(other.s_), key_(other.key_) {
+  mobility_[0] = other.mobility_[0];
+  mobility_[1] = other.mobility_[1];
+  pieces_in_mills_[0] = other.pieces_in_mills_[0];
+  pieces_in_mills_[1] = other.pieces_in_mills_[1];
+}
 
 GameState::~GameState() {}
 
 game::PieceColor GameState::current_player() const {
-  return s_.test(0) ? game::BLACK_COLOR : game::WHITE_COLOR;
+  return (s_ & kCurrentPlayerMask) ? game::BLACK_COLOR : game::WHITE_COLOR;
 }
 
 void GameState::set_current_player(const game::PieceColor player_color) {
-  s_.set(0, player_color == game::BLACK_COLOR);
+  if (player_color != current_player()) {
+    key_ ^= kZobristBlackToMove;
+  }
+  if (player_color == game::BLACK_COLOR) {
+    s_ |= kCurrentPlayerMask;
+  } else {
+    s_ &= ~kCurrentPlayerMask;
+  }
 }
 
 int GameState::pieces_in_hand(const game::PieceColor player_color) const {
   DCHECK(player_color != game::NO_COLOR);
-  const uint64_t state = s_.to_ulong();
   if (player_color == game::WHITE_COLOR) {
-    return ((state & 0x1eULL) >> 1);
+    return ((s_ & kWhitePiecesInHandMask) >> 1);
   }
-  return ((state & 0x1e0ULL) >> 5);
+  return ((s_ & kBlackPiecesInHandMask) >> 5);
 }
 
 void GameState::set_pieces_in_hand(const game::PieceColor player_color,
                                    const int count) {
   DCHECK(player_color != game::NO_COLOR);
-  DCHECK_LT(count, 1 << 5);
+  DCHECK_LT(count, 1 << 4);
+  const int color_index = GetZobristColorIndex(player_color);
+  key_ ^= kZobristPiecesInHand[color_index][pieces_in_hand(player_color)] ^
+          kZobristPiecesInHand[color_index][count];
   uint64_t bitmask = static_cast<uint64_t>(count) << 1;
   if (player_color == game::BLACK_COLOR) {
     bitmask <<= 4;
-    for (int i = 5; i <= 8; ++i) {
-      s_.set(i, false);
-    }
+    s_ &= ~kBlackPiecesInHandMask;
   } else {
-    for (int i = 1; i <= 4; ++i) {
-      s_.set(i, false);
-    }
+    s_ &= ~kWhitePiecesInHandMask;
   }
   s_ |= bitmask;
 }
 
+Bitboard GameState::pieces(const game::PieceColor player_color) const {
+  return static_cast<Bitboard>(s_ >> GetPiecesOffset(player_color)) &
+         layout().all;
+}
+
+Bitboard GameState::empty_locations() const {
+  return layout().all &
+         ~(pieces(game::WHITE_COLOR) | pieces(game::BLACK_COLOR));
+}
+
 void GameState::Encode(const game::Board& board) {
-  s_ &= 0x1ffULL;  // Clear existing pieces
+  key_ ^= GetPiecesKey(game::WHITE_COLOR, pieces(game::WHITE_COLOR)) ^
+          GetPiecesKey(game::BLACK_COLOR, pieces(game::BLACK_COLOR));
+  s_ &= kHeaderMask;  // Clear existing pieces
+  mobility_[0] = mobility_[1] = 0;
+  pieces_in_mills_[0] = pieces_in_mills_[1] = 0;
   game_type_ = GetGameTypeFromBoardSize(board.size());
   const std::vector<game::BoardLocation>& locations = board.locations();
   for (size_t i = 0; i < locations.size(); ++i) {
@@ -139,30 +209,39 @@ void GameState::Encode(const game::Board& board) {
   }
 }
 
+void GameState::Encode(const game::Game& game_model) {
+  set_current_player(game_model.current_player());
+  set_pieces_in_hand(game::WHITE_COLOR,
+                     game_model.GetPiecesInHand(game::WHITE_COLOR));
+  set_pieces_in_hand(game::BLACK_COLOR,
+                     game_model.GetPiecesInHand(game::BLACK_COLOR));
+  Encode(game_model.board());
+}
+
 void GameState::Decode(game::Board* board) const {
   DCHECK(board);
   DCHECK_EQ(game_type_, GetGameTypeFromBoardSize(board->size()));
-  const map<BoardLocation, int>& indices = GetLocationIndices(game_type_);
-  map<BoardLocation, int>::const_iterator it;
-  for (it = indices.begin(); it != indices.end(); ++it) {
-    game::PieceColor color = game::NO_COLOR;
-    const int pos = it->second + kLocationsOffset;
-    if (s_.test(pos)) {
-      color = game::WHITE_COLOR;
-    }
-    if (s_.test(pos + indices.size())) {
-      DCHECK_EQ(color, game::NO_COLOR);
-      color = game::BLACK_COLOR;
-    }
-    if (color != game::NO_COLOR) {
-      board->AddPiece(it->first, color);
+  const BitboardLayout& board_layout = layout();
+  const game::PieceColor colors[] = { game::WHITE_COLOR, game::BLACK_COLOR };
+  for (int i = 0; i < 2; ++i) {
+    Bitboard player_pieces = pieces(colors[i]);
+    while (player_pieces) {
+      const int index = LowestBitIndex(player_pieces);
+      player_pieces &= player_pieces - 1;
+      board->AddPiece(board_layout.LocationAt(index), colors[i]);
     }
   }
 }
 
 GameState& GameState::operator=(const GameState& other) {
   if (this != &other) {
+    game_type_ = other.game_type_;
     s_ = other.s_;
+    key_ = other.key_;
+    mobility_[0] = other.mobility_[0];
+    mobility_[1] = other.mobility_[1];
+    pieces_in_mills_[0] = other.pieces_in_mills_[0];
+    pieces_in_mills_[1] = other.pieces_in_mills_[1];
   }
   return *this;
 }
@@ -172,105 +251,177 @@ bool GameState::operator==(const GameState& other) const {
 }
 
 bool GameState::operator<(const GameState& other) const {
-  return s_.to_ulong() < other.s_.to_ulong();
+  return s_ < other.s_;
 }
 
 void GameState::AddPiece(const game::BoardLocation& destination,
                          game::PieceColor color) {
-  DCHECK(color != game::NO_COLOR);
-  const map<BoardLocation, int>& indices = GetLocationIndices(game_type_);
-  map<BoardLocation, int>::const_iterator it = indices.find(destination);
-  DCHECK(it != indices.end());
-  int pos = it->second + kLocationsOffset;
-  if (color == game::BLACK_COLOR) {
-    pos += indices.size();
-  }
-  s_.set(pos);
+  const int index = layout().IndexOf(destination);
+  DCHECK_GT(index, -1);
+  AddPiece(index, color);
 }
 
 void GameState::MovePiece(const game::BoardLocation& source,
                           const game::BoardLocation& destination) {
-  const map<BoardLocation, int>& indices = GetLocationIndices(game_type_);
-  map<BoardLocation, int>::const_iterator source_it = indices.find(source);
-  map<BoardLocation, int>::const_iterator dest_it = indices.find(destination);
-  int source_pos = source_it->second + kLocationsOffset;
-  int dest_pos = dest_it->second + kLocationsOffset;
-  DCHECK(!s_.test(dest_pos));
-  DCHECK(!s_.test(dest_pos + indices.size()));
-  if (s_.test(source_pos)) {
-    DCHECK(!s_.test(source_pos + indices.size()));
-    s_.reset(source_pos);
-    s_.set(dest_pos);
-    return;
-  }
-  source_pos += indices.size();
-  dest_pos += indices.size();
-  s_.reset(source_pos);
-  s_.set(dest_pos);
+  const BitboardLayout& board_layout = layout();
+  MovePiece(board_layout.IndexOf(source), board_layout.IndexOf(destination));
 }
 
 void GameState::RemovePiece(const game::BoardLocation& source) {
-  const map<BoardLocation, int>& indices = GetLocationIndices(game_type_);
-  map<BoardLocation, int>::const_iterator source_it = indices.find(source);
-  int pos = source_it->second + kLocationsOffset;
-  if (s_.test(pos)) {
-    DCHECK(!s_.test(pos + indices.size()));
-    s_.reset(pos);
-    return;
+  RemovePiece(layout().IndexOf(source));
+}
+
+void GameState::AddPiece(int destination, game::PieceColor color) {
+  DCHECK(color != game::NO_COLOR);
+  DCHECK(empty_locations() & BitAt(destination));
+  UpdateFeatures(destination, color, 1);
+  s_ |= 1ULL << (GetPiecesOffset(color) + destination);
+  key_ ^= kZobristPieces[GetZobristColorIndex(color)][destination];
+}
+
+void GameState::MovePiece(int source, int destination) {
+  DCHECK(empty_locations() & BitAt(destination));
+  const game::PieceColor color = (pieces(game::WHITE_COLOR) & BitAt(source)) ?
+      game::WHITE_COLOR : game::BLACK_COLOR;
+  const int offset = GetPiecesOffset(color);
+  DCHECK((s_ >> (offset + source)) & 1ULL);
+  s_ ^= 1ULL << (offset + source);
+  UpdateFeatures(source, color, -1);
+  UpdateFeatures(destination, color, 1);
+  s_ ^= 1ULL << (offset + destination);
+  const uint64_t* keys = kZobristPieces[GetZobristColorIndex(color)];
+  key_ ^= keys[source] ^ keys[destination];
+}
+
+void GameState::RemovePiece(int source) {
+  const int white_offset = GetPiecesOffset(game::WHITE_COLOR);
+  const int black_offset = GetPiecesOffset(game::BLACK_COLOR);
+  DCHECK(((s_ >> (white_offset + source)) & 1ULL) !=
+         ((s_ >> (black_offset + source)) & 1ULL));
+  const game::PieceColor color = ((s_ >> (white_offset + source)) & 1ULL) ?
+      game::WHITE_COLOR : game::BLACK_COLOR;
+  key_ ^= kZobristPieces[GetZobristColorIndex(color)][source];
+  s_ &= ~((1ULL << (white_offset + source)) |
+           (1ULL << (black_offset + source)));
+  UpdateFeatures(source, color, -1);
+}
+
+GameState GameState::GetSymmetricState(int symmetry) const {
+  GameState result(*this);
+  result.SetPieces(
+      GetSymmetricBitboard(game_type_, symmetry, pieces(game::WHITE_COLOR)),
+      GetSymmetricBitboard(game_type_, symmetry, pieces(game::BLACK_COLOR)));
+  return result;
+}
+
+GameState GameState::GetCanonicalState(int* symmetry) const {
+  const Bitboard white_pieces = pieces(game::WHITE_COLOR);
+  const Bitboard black_pieces = pieces(game::BLACK_COLOR);
+  const int location_count = layout().location_count;
+  // The states only differ by their pieces, and the black pieces are stored
+  // in the higher bits of the encoding.
+  int best_symmetry = 0;
+  uint64_t best_pieces =
+      (static_cast<uint64_t>(black_pieces) << location_count) | white_pieces;
+  const int symmetry_count = GetSymmetryCount(game_type_);
+  for (int i = 1; i < symmetry_count; ++i) {
+    const uint64_t symmetric_pieces =
+        (static_cast<uint64_t>(
+            GetSymmetricBitboard(game_type_, i, black_pieces))
+         << location_count) |
+        GetSymmetricBitboard(game_type_, i, white_pieces);
+    if (symmetric_pieces < best_pieces) {
+      best_pieces = symmetric_pieces;
+      best_symmetry = i;
+    }
+  }
+  if (symmetry) {
+    *symmetry = best_symmetry;
+  }
+  if (!best_symmetry) {
+    return *this;
   }
-  s_.reset(pos + indices.size());
+  GameState result(*this);
+  result.SetPieces(best_pieces & layout().all,
+                   static_cast<Bitboard>(best_pieces >> location_count));
+  return result;
+}
+
+int GameState::GetPiecesOffset(const game::PieceColor player_color) const {
+  DCHECK(player_color != game::NO_COLOR);
+  if (player_color == game::WHITE_COLOR) {
+    return kLocationsOffset;
+  }
+  return kLocationsOffset + layout().location_count;
+}
+
+void GameState::SetPieces(Bitboard white_pieces, Bitboard black_pieces) {
+  key_ ^= GetPiecesKey(game::WHITE_COLOR, pieces(game::WHITE_COLOR)) ^
+          GetPiecesKey(game::BLACK_COLOR, pieces(game::BLACK_COLOR)) ^
+          GetPiecesKey(game::WHITE_COLOR, white_pieces) ^
+          GetPiecesKey(game::BLACK_COLOR, black_pieces);
+  s_ = (s_ & kHeaderMask) |
+       (static_cast<uint64_t>(white_pieces) <<
+        GetPiecesOffset(game::WHITE_COLOR)) |
+       (static_cast<uint64_t>(black_pieces) <<
+        GetPiecesOffset(game::BLACK_COLOR));
+}
+
+void GameState::UpdateFeatures(int index, game::PieceColor color, int sign) {
+  const BitboardLayout& board_layout = layout();
+  const Bitboard player_pieces = pieces(color);
+  const Bitboard opponent_pieces = pieces(game::GetOpponent(color));
+  const Bitboard adjacency = board_layout.adjacency[index];
+  const int player = GetColorIndex(color);
+  // The piece can move to its empty neighbors, and its neighbors can no longer
+  // move to its location.
+  mobility_[player] += sign * (
+      PopCount(adjacency & empty_locations()) -
+      PopCount(adjacency & player_pieces));
+  mobility_[1 - player] -= sign * PopCount(adjacency & opponent_pieces);
+  // Only the pieces that share a mill with the location can enter or leave
+  // a mill.
+  pieces_in_mills_[player] += sign * (
+      CountPiecesInMillsAround(board_layout, player_pieces | BitAt(index),
+                               index) -
+      CountPiecesInMillsAround(board_layout, player_pieces, index));
 }
 
 // static
 std::vector<game::PlayerAction> GameState::GetTransition(
     const GameState& from, const GameState& to) {
   const game::PieceColor player = from.current_player();
+  const game::PieceColor opponent = game::GetOpponent(player);
   DCHECK_EQ(player, game::GetOpponent(to.current_player()));
-  DCHECK_EQ(from.pieces_in_hand(game::GetOpponent(player)),
-            to.pieces_in_hand(game::GetOpponent(player)));
+  DCHECK_EQ(from.pieces_in_hand(opponent), to.pieces_in_hand(opponent));
   DCHECK_EQ(from.game_type_, to.game_type_);
-  const map<BoardLocation, int>& indices = GetLocationIndices(from.game_type_);
-  const int offset = (player == game::WHITE_COLOR ?
-      kLocationsOffset : kLocationsOffset + indices.size());
-  const int opp_offset = (player == game::WHITE_COLOR ?
-      kLocationsOffset + indices.size() : kLocationsOffset);
-  game::BoardLocation source(-1, -1);
-  game::BoardLocation destination(-1, -1);
-  game::BoardLocation remove(-1, -1);
-  // TODO(game_state): define a typedef for this.
-  map<BoardLocation, int>::const_iterator it;
-  for (it = indices.begin(); it != indices.end(); ++it) {
-    const int pos = it->second + offset;
-    const int opp_pos = it->second + opp_offset;
-    if (!from.s_.test(pos) && to.s_.test(pos)) {
-      DCHECK_EQ(destination.line(), -1);
-      destination = it->first;
-    } else if (from.s_.test(pos) && !to.s_.test(pos)) {
-      DCHECK_EQ(source.line(), -1);
-      source = it->first;
-    } else if (from.s_.test(opp_pos) && !to.s_.test(opp_pos)) {
-      DCHECK_EQ(remove.line(), -1);
-      remove = it->first;
-    }
-  }
+  const BitboardLayout& layout = from.layout();
+  const Bitboard from_pieces = from.pieces(player);
+  const Bitboard to_pieces = to.pieces(player);
+  const Bitboard added = to_pieces & ~from_pieces;
+  const Bitboard moved = from_pieces & ~to_pieces;
+  const Bitboard removed = from.pieces(opponent) & ~to.pieces(opponent);
+  DCHECK_EQ(PopCount(added), 1);
+  DCHECK_LT(PopCount(moved), 2);
+  DCHECK_LT(PopCount(removed), 2);
   std::vector<game::PlayerAction> result;
-  if (source.line() == -1) {
+  if (!moved) {
     DCHECK_GT(from.pieces_in_hand(player), 0);
     DCHECK_EQ(from.pieces_in_hand(player), to.pieces_in_hand(player) + 1);
     game::PlayerAction place_action(player, game::PlayerAction::PLACE_PIECE);
-    place_action.set_destination(destination);
+    place_action.set_destination(layout.LocationAt(LowestBitIndex(added)));
     result.push_back(place_action);
   } else {
     DCHECK_EQ(from.pieces_in_hand(player), 0);
     DCHECK_EQ(to.pieces_in_hand(player), 0);
     game::PlayerAction move_action(player, game::PlayerAction::MOVE_PIECE);
-    move_action.set_source(source);
-    move_action.set_destination(destination);
+    move_action.set_source(layout.LocationAt(LowestBitIndex(moved)));
+    move_action.set_destination(layout.LocationAt(LowestBitIndex(added)));
     result.push_back(move_action);
   }
-  if (remove.line() != -1) {
+  if (removed) {
     game::PlayerAction remove_action(player, game::PlayerAction::REMOVE_PIECE);
-    remove_action.set_source(remove);
+    remove_action.set_source(layout.LocationAt(LowestBitIndex(removed)));
     result.push_back(remove_action);
   }
   return result;
@@ -5,10 +5,12 @@
 #ifndef AI_GAME_STATE_H_
 #define AI_GAME_STATE_H_
 
-#include <bitset>
+#include <stdint.h>
+
 #include <vector>
 
 #include "ai/ai_export.h"
+#include "ai/bitboard.h"
 #include "game/game_type.h"
 #include "game/piece_color.h"
 #include "game/player_action.h"
@@ -16,6 +18,7 @@
 namespace game {
 class Board;
 class BoardLocation;
+class Game;
 }
 
 namespace ai {
@@ -29,6 +32,11 @@ class AI_EXPORT GameState {
 
   game::GameType game_type() const { return game_type_; }
 
+  // The precomputed board tables corresponding to |game_type_|.
+  const BitboardLayout& layout() const {
+    return GetBitboardLayout(game_type_);
+  }
+
   game::PieceColor current_player() const;
   void set_current_player(const game::PieceColor player_color);
 
@@ -38,18 +46,45 @@ class AI_EXPORT GameState {
   void Encode(const game::Board& board);
   void Decode(game::Board* board) const;
 
+  // Encodes the board of |game_model|, the player to move and the pieces that
+  // are still in hand.
+  void Encode(const game::Game& game_model);
+
   GameState& operator=(const GameState& other);
   bool operator==(const GameState& other) const;
 
   // This must be declared so one can use GameState objects as std::map keys.
   bool operator<(const GameState& other) const;
 
+  // Returns the set of locations occupied by the pieces of |player_color|.
+  Bitboard pieces(const game::PieceColor player_color) const;
+
+  // Returns the set of empty locations.
+  Bitboard empty_locations() const;
+
   // Methods that make changes to the current board configuration.
   void AddPiece(const game::BoardLocation& destination, game::PieceColor color);
   void MovePiece(const game::BoardLocation& source,
                  const game::BoardLocation& destination);
   void RemovePiece(const game::BoardLocation& source);
 
+  // Equivalent methods that receive the bit indices of the locations, as given
+  // by the BitboardLayout of this state's game type.
+  void AddPiece(int destination, game::PieceColor color);
+  void MovePiece(int source, int destination);
+  void RemovePiece(int source);
+
+  // Returns the state obtained by moving the pieces of this state with the
+  // given |symmetry| (see symmetry.h). The player to move and the pieces in
+  // hand are not changed.
+  GameState GetSymmetricState(int symmetry) const;
+
+  // Returns the canonical form of this state, which is the symmetric state with
+  // the smallest encoding, so all the symmetric states have the same canonical
+  // form. If |symmetry| is not NULL, it receives a symmetry that moves this
+  // state to its canonical form.
+  GameState GetCanonicalState(int* symmetry) const;
+
   // Utility method that determines the actions that must be played in order to
   // reach the game state encoded by |to| from the game state encoded by |from|.
   // The first element of the result is the MOVE or PLACE action that the player
@@ -60,12 +95,59 @@ class AI_EXPORT GameState {
   static std::vector<game::PlayerAction> GetTransition(const GameState& from,
                                                        const GameState& to);
 
+  // The Zobrist key of the state. It is updated incrementally by all the
+  // methods that modify the state, so it is never recomputed from scratch
+  // (except for Encode()). Two equal states always have the same key.
+  uint64_t key() const { return key_; }
+
+  // The raw encoding of the state (see |s_| below).
+  uint64_t encoding() const { return s_; }
+
+  // The features of the pieces of |player_color| used by the evaluators from
+  // ai/alphabeta/evaluators.h, which are updated incrementally like the key.
+  // mobility() is the number of moves to adjacent empty locations and
+  // pieces_in_mills() is the number of pieces that are part of a closed mill.
+  // The number of pieces on the board is given by PopCount(pieces()).
+  int mobility(const game::PieceColor player_color) const {
+    return mobility_[GetColorIndex(player_color)];
+  }
+  int pieces_in_mills(const game::PieceColor player_color) const {
+    return pieces_in_mills_[GetColorIndex(player_color)];
+  }
+
   // Utility function used to store GameState instances in hash maps.
-  static size_t Hash(const GameState& state) { return state.s_.to_ulong(); }
+  static size_t Hash(const GameState& state) { return state.key_; }
 
  private:
+  // Returns the bit offset at which the pieces of |player_color| are stored.
+  int GetPiecesOffset(const game::PieceColor player_color) const;
+
+  static int GetColorIndex(const game::PieceColor player_color) {
+    return player_color == game::WHITE_COLOR ? 0 : 1;
+  }
+
+  // Replaces the pieces of both players with their image by a symmetry. The
+  // features do not depend on the orientation of the board, so they are kept.
+  void SetPieces(Bitboard white_pieces, Bitboard black_pieces);
+
+  // Updates the features when a piece of |color| is added to (|sign| = 1) or
+  // removed from (|sign| = -1) the location given by |index|. It must be
+  // called while the location is empty.
+  void UpdateFeatures(int index, game::PieceColor color, int sign);
+
   game::GameType game_type_;
-  std::bitset<64> s_;
+
+  // The encoding of the state. Bit 0 stores the current player, bits 1-4 and
+  // 5-8 store the number of pieces in hand for white and black. They are
+  // followed by one bitboard for the white pieces and one for the black pieces.
+  uint64_t s_;
+
+  // The Zobrist key corresponding to |s_|.
+  uint64_t key_;
+
+  // The features of the white and of the black pieces.
+  int16_t mobility_[2];
+  int16_t pieces_in_mills_[2];
 };
 
 // Convenience class used to declare hash maps that are able to store GameState
@@ -0,0 +1,151 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the hash function that uses the raw GameState encoding with the one
+// that uses the Zobrist key, by measuring bucket collision rates and the time
+// required to probe a hash map that contains the states reached during random
+// games.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "base/debug/stacktrace.h"
+#include "base/hash_map.h"
+#include "base/time_util.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+
+namespace {
+
+using ai::GameState;
+using ai::GameStateTree;
+using ai::SuccessorBuffer;
+
+const int kMaxStates = 500000;
+const int kMaxMoves = 200;
+const int kProbeRounds = 10;
+
+struct RawEncodingHasher {
+  size_t operator()(const GameState& state) const {
+    return state.encoding();
+  }
+};
+
+struct ZobristHasher {
+  size_t operator()(const GameState& state) const {
+    return GameState::Hash(state);
+  }
+};
+
+void CollectStates(const game::GameOptions& options,
+                   std::vector<GameState>* states) {
+  GameStateTree tree(options);
+  SuccessorBuffer successors;
+  const int pieces =
+      game::Game::GetInitialPieceCountByGameType(options.game_type());
+  std::srand(0);
+  while (static_cast<int>(states->size()) < kMaxStates) {
+    GameState state(options.game_type());
+    state.set_pieces_in_hand(game::WHITE_COLOR, pieces);
+    state.set_pieces_in_hand(game::BLACK_COLOR, pieces);
+    for (int move = 0; move < kMaxMoves; ++move) {
+      successors.clear();
+      tree.GenerateSuccessors(state, &successors);
+      if (successors.empty()) {
+        break;
+      }
+      states->insert(states->end(), successors.begin(), successors.end());
+      state = successors[std::rand() % successors.size()];
+    }
+  }
+  std::sort(states->begin(), states->end());
+  states->erase(std::unique(states->begin(), states->end()), states->end());
+}
+
+// Returns the percentage of |states| that are mapped to a bucket that is
+// already used by another state, if there are |bucket_count| buckets.
+template <class Hasher>
+double GetCollisionRate(const std::vector<GameState>& states,
+                        size_t bucket_count) {
+  std::vector<bool> used(bucket_count, false);
+  Hasher hasher;
+  int collisions = 0;
+  for (size_t i = 0; i < states.size(); ++i) {
+    const size_t bucket = hasher(states[i]) % bucket_count;
+    if (used[bucket]) {
+      ++collisions;
+    }
+    used[bucket] = true;
+  }
+  return 100.0 * collisions / states.size();
+}
+
+// Returns the average time, in nanoseconds, required to find one of the
+// |states| in a hash map that contains all of them.
+template <class Hasher>
+double GetProbeTime(const std::vector<GameState>& states) {
+  base::hash_map<GameState, int, Hasher> map;
+  for (size_t i = 0; i < states.size(); ++i) {
+    map[states[i]] = i;
+  }
+  std::vector<GameState> probes(states);
+  std::random_shuffle(probes.begin(), probes.end());
+  int found = 0;
+  const int64_t start_time = base::GetMonotonicTime();
+  for (int round = 0; round < kProbeRounds; ++round) {
+    for (size_t i = 0; i < probes.size(); ++i) {
+      found += map.count(probes[i]);
+    }
+  }
+  const int64_t duration = base::GetMonotonicTime() - start_time;
+  if (found != kProbeRounds * static_cast<int>(probes.size())) {
+    std::cerr << "Hash map lookup failed." << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  return static_cast<double>(duration) / found;
+}
+
+template <class Hasher>
+void RunBenchmark(const char* name, const std::vector<GameState>& states) {
+  // A prime bucket count, like the ones used by base::hash_map, and a power of
+  // two, like the ones used by fixed-size transposition tables.
+  const size_t prime_buckets = 786433;
+  const size_t power_of_two_buckets = 1 << 20;
+  std::cout << name << std::endl
+            << "  collisions (prime buckets): "
+            << GetCollisionRate<Hasher>(states, prime_buckets) << "%"
+            << std::endl
+            << "  collisions (power of two buckets): "
+            << GetCollisionRate<Hasher>(states, power_of_two_buckets) << "%"
+            << std::endl
+            << "  probe time: " << GetProbeTime<Hasher>(states) << " ns"
+            << std::endl;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  std::vector<GameState> states;
+  CollectStates(options, &states);
+  std::cout << "Collected " << states.size() << " distinct states."
+            << std::endl;
+  RunBenchmark<RawEncodingHasher>("Raw encoding", states);
+  RunBenchmark<ZobristHasher>("Zobrist key", states);
+  return EXIT_SUCCESS;
+}
@@ -7,9 +7,10 @@
 #include <utility>
 #include <vector>
 
+#include "ai/bitboard.h"
 #include "ai/game_state.h"
+#include "ai/symmetry.h"
 #include "base/log.h"
-#include "game/board.h"
 #include "game/game_options.h"
 #include "game/piece_color.h"
 
@@ -17,120 +18,121 @@ namespace ai {
 
 namespace {
 
-void FilterBoardLocations(const game::Board& board,
-                          const game::PieceColor player_color,
-                          std::vector<game::BoardLocation>* player,
-                          std::vector<game::BoardLocation>* removable,
-                          std::vector<game::BoardLocation>* empty) {
-  std::vector<game::BoardLocation> opponent;
-  std::vector<game::BoardLocation> mills;
-  const std::vector<game::BoardLocation>& locations = board.locations();
-  for (size_t i = 0; i < locations.size(); ++i) {
-    const game::PieceColor loc_color = board.GetPieceAt(locations[i]);
-    if (loc_color == game::NO_COLOR) {
-      empty->push_back(locations[i]);
-    } else if (loc_color == player_color) {
-      player->push_back(locations[i]);
-    } else if (board.IsPartOfMill(locations[i])) {
-      mills.push_back(locations[i]);
-    } else {
-      opponent.push_back(locations[i]);
-    }
-  }
-  if (opponent.empty()) {
-    removable->insert(removable->end(), mills.begin(), mills.end());
-  } else {
-    removable->insert(removable->end(), opponent.begin(), opponent.end());
+// Appends to |successors| one state for each piece from |removable| that can be
+// removed from |state|.
+void AddRemoveSuccessors(const GameState& state,
+                         Bitboard removable,
+                         SuccessorBuffer* successors) {
+  while (removable) {
+    const int index = LowestBitIndex(removable);
+    removable &= removable - 1;
+    GameState remove_successor(state);
+    remove_successor.RemovePiece(index);
+    successors->push_back(remove_successor);
   }
 }
 
 }  // anonymous namespace
 
 GameStateTree::GameStateTree(const game::GameOptions& game_options)
-    : game_options_(game_options), tree_() {}
+    : game_options_(game_options), canonical_keys_(false), tree_() {}
+
+void GameStateTree::set_canonical_keys_enabled(bool enable) {
+  canonical_keys_ = enable;
+  tree_.clear();
+}
 
 void GameStateTree::GetSuccessors(const GameState& state,
                                   std::vector<GameState>* successors) {
-  SuccessorMap::const_iterator it = tree_.find(state);
+  int symmetry = 0;
+  const GameState key(
+      canonical_keys_ ? state.GetCanonicalState(&symmetry) : state);
+  SuccessorMap::const_iterator it = tree_.find(key);
   if (it == tree_.end()) {
-    std::vector<GameState> temp;
-    if (state.pieces_in_hand(state.current_player()) > 0) {
-      GetPlaceSuccessors(state, &temp);
-    } else {
-      GetMoveSuccessors(state, &temp);
-    }
-    it = tree_.insert(std::make_pair(state, temp)).first;
+    buffer_.clear();
+    GenerateSuccessors(key, &buffer_);
+    it = tree_.insert(std::make_pair(key,
+        std::vector<GameState>(buffer_.begin(), buffer_.end()))).first;
+  }
+  if (!symmetry) {
+    successors->insert(successors->end(), it->second.begin(),
+                       it->second.end());
+    return;
+  }
+  const int inverse = GetInverseSymmetry(state.game_type(), symmetry);
+  for (size_t i = 0; i < it->second.size(); ++i) {
+    successors->push_back(it->second[i].GetSymmetricState(inverse));
+  }
+}
+
+void GameStateTree::GenerateSuccessors(const GameState& state,
+                                       SuccessorBuffer* successors) const {
+  DCHECK_EQ(state.game_type(), game_options_.game_type());
+  if (state.pieces_in_hand(state.current_player()) > 0) {
+    GetPlaceSuccessors(state, successors);
+  } else {
+    GetMoveSuccessors(state, successors);
   }
-  successors->insert(successors->end(), it->second.begin(), it->second.end());
 }
 
 void GameStateTree::GetPlaceSuccessors(const GameState& state,
-                                       std::vector<GameState>* successors) {
-  game::Board board(game_options_.game_type());
-  state.Decode(&board);
+                                       SuccessorBuffer* successors) const {
+  const BitboardLayout& layout = state.layout();
   const game::PieceColor player = state.current_player();
   const game::PieceColor opponent = game::GetOpponent(player);
-  std::vector<game::BoardLocation> player_loc;
-  std::vector<game::BoardLocation> empty_loc;
-  std::vector<game::BoardLocation> opponent_loc;
-  FilterBoardLocations(board, player, &player_loc, &opponent_loc, &empty_loc);
-  for (size_t i = 0; i < empty_loc.size(); ++i) {
-    bool result = board.AddPiece(empty_loc[i], player);
-    if (result) {
-      GameState successor(state);
-      successor.set_current_player(opponent);
-      successor.set_pieces_in_hand(player, state.pieces_in_hand(player) - 1);
-      successor.AddPiece(empty_loc[i], player);
-      if (board.IsPartOfMill(empty_loc[i])) {
-        for (size_t k = 0; k < opponent_loc.size(); ++k) {
-          GameState remove_successor(successor);
-          remove_successor.RemovePiece(opponent_loc[k]);
-          successors->push_back(remove_successor);
-        }
-      } else {
-        successors->push_back(successor);
-      }
+  const Bitboard player_pieces = state.pieces(player);
+  const Bitboard removable =
+      GetRemovablePieces(layout, state.pieces(opponent));
+  GameState base_successor(state);
+  base_successor.set_current_player(opponent);
+  base_successor.set_pieces_in_hand(player, state.pieces_in_hand(player) - 1);
+  Bitboard empty = state.empty_locations();
+  while (empty) {
+    const int index = LowestBitIndex(empty);
+    empty &= empty - 1;
+    GameState successor(base_successor);
+    successor.AddPiece(index, player);
+    if (IsPartOfMill(layout, player_pieces | BitAt(index), index)) {
+      AddRemoveSuccessors(successor, removable, successors);
     } else {
-      NOTREACHED();
+      successors->push_back(successor);
     }
-    result = board.RemovePiece(empty_loc[i]);
-    DCHECK(result);
   }
 }
 
 void GameStateTree::GetMoveSuccessors(const GameState& state,
-                                      std::vector<GameState>* successors) {
-  game::Board board(game_options_.game_type());
-  state.Decode(&board);
-  std::vector<game::BoardLocation> player_loc;
-  std::vector<game::BoardLocation> empty_loc;
-  std::vector<game::BoardLocation> opponent_loc;
+                                      SuccessorBuffer* successors) const {
+  const BitboardLayout& layout = state.layout();
   const game::PieceColor player = state.current_player();
   const game::PieceColor opponent = game::GetOpponent(player);
-  FilterBoardLocations(board, player, &player_loc, &opponent_loc, &empty_loc);
-  for (size_t i = 0; i < player_loc.size(); ++i) {
-    for (size_t j = 0; j < empty_loc.size(); ++j) {
-      if (!board.IsAdjacent(player_loc[i], empty_loc[j])) {
-        if (player_loc.size() > 3 || !game_options_.jumps_allowed()) {
-          continue;
-        }
-      }
-      board.MovePiece(player_loc[i], empty_loc[j]);
-      if (board.IsPartOfMill(empty_loc[j])) {
-        for (size_t k = 0; k < opponent_loc.size(); ++k) {
-          GameState successor(state);
-          successor.set_current_player(opponent);
-          successor.MovePiece(player_loc[i], empty_loc[j]);
-          successor.RemovePiece(opponent_loc[k]);
-          successors->push_back(successor);
-        }
+  const Bitboard player_pieces = state.pieces(player);
+  const Bitboard removable =
+      GetRemovablePieces(layout, state.pieces(opponent));
+  const Bitboard empty = state.empty_locations();
+  const bool can_jump =
+      game_options_.jumps_allowed() && PopCount(player_pieces) <= 3;
+  GameState base_successor(state);
+  base_successor.set_current_player(opponent);
+  Bitboard sources = player_pieces;
+  while (sources) {
+    const int source = LowestBitIndex(sources);
+    sources &= sources - 1;
+    Bitboard destinations = empty;
+    if (!can_jump) {
+      destinations &= layout.adjacency[source];
+    }
+    while (destinations) {
+      const int destination = LowestBitIndex(destinations);
+      destinations &= destinations - 1;
+      GameState successor(base_successor);
+      successor.MovePiece(source, destination);
+      const Bitboard moved_pieces =
+          (player_pieces & ~BitAt(source)) | BitAt(destination);
+      if (IsPartOfMill(layout, moved_pieces, destination)) {
+        AddRemoveSuccessors(successor, removable, successors);
       } else {
-        GameState successor(state);
-        successor.set_current_player(opponent);
-        successor.MovePiece(player_loc[i], empty_loc[j]);
         successors->push_back(successor);
       }
-      board.MovePiece(empty_loc[j], player_loc[i]);
     }
   }
 }
@@ -11,6 +11,7 @@
 #include "ai/game_state.h"
 #include "base/basic_macros.h"
 #include "base/hash_map.h"
+#include "base/log.h"
 
 namespace game {
 class GameOptions;
@@ -18,6 +19,49 @@ class GameOptions;
 
 namespace ai {
 
+// Fixed-capacity container used to store the successors of a single game state
+// without allocating memory on the heap. The capacity must cover the number of
+// successors of any NINE_MEN_MORRIS state, which is at most 324. Each move can
+// close a mill that is followed by the removal of one of the opponent's o
+// pieces, and o is at most 9:
+// - A player with three pieces jumps to one of the 21 - o empty locations, so
+//   there are at most 3 * (21 - o) * o successors, which is 324 for o = 9.
+// - A sliding piece moves along one of the 32 lines that join two adjacent
+//   locations, and each line can be used by only one move, so there are at most
+//   32 * 9 = 288 successors.
+// - A placement uses one of the e empty locations, with e + o <= 24, so there
+//   are at most e * o <= 144 successors.
+class AI_EXPORT SuccessorBuffer {
+ public:
+  static const int kCapacity = 384;
+
+  SuccessorBuffer() : size_(0) {}
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const GameState& operator[](int index) const {
+    DCHECK_LT(index, size_);
+    return states_[index];
+  }
+
+  const GameState* begin() const { return states_; }
+  const GameState* end() const { return states_ + size_; }
+
+  void clear() { size_ = 0; }
+
+  void push_back(const GameState& state) {
+    DCHECK_LT(size_, kCapacity);
+    states_[size_++] = state;
+  }
+
+ private:
+  GameState states_[kCapacity];
+  int size_;
+
+  DISALLOW_COPY_AND_ASSIGN(SuccessorBuffer);
+};
+
 // This class stores a partially constructed game tree. It allows the client to
 // obtain the list of successors for a given game state and caches the result
 // for subsequent calls.
@@ -25,6 +69,19 @@ class AI_EXPORT GameStateTree {
  public:
   explicit GameStateTree(const game::GameOptions& game_options);
 
+  // If enabled, GetSuccessors() caches the successors of the canonical form of
+  // each state (see GameState::GetCanonicalState()), so the symmetric states
+  // share one cache entry. The successors are moved back to the orientation of
+  // the requested state, so they are still real successors of it that can be
+  // passed to GameState::GetTransition(). They are returned in the order of
+  // the successors of the canonical state. Changing this setting clears the
+  // cache. By default, it is disabled.
+  bool is_canonical_keys_enabled() const { return canonical_keys_; }
+  void set_canonical_keys_enabled(bool enable);
+
+  // The number of states whose successors are cached by GetSuccessors().
+  size_t cache_size() const { return tree_.size(); }
+
   // Appends to the |succ| vector all the successors states of |state|. A state
   // |s| is considered a successor of |state| if |s| can be reached from
   // |state| by performing one or two valid moves (as the current player) under
@@ -36,6 +93,14 @@ class AI_EXPORT GameStateTree {
   // NOTE: If |succ| is not empty, its content won't be deleted.
   void GetSuccessors(const GameState& state, std::vector<GameState>* succ);
 
+  // Appends to |succ| the same successors that are returned by GetSuccessors(),
+  // but computes them directly from the bit encoding of |state|, without using
+  // a game::Board, and does not cache the result. The method does not allocate
+  // any memory on the heap, so the caller can reuse the same buffer when
+  // expanding multiple states.
+  // NOTE: If |succ| is not empty, its content won't be deleted.
+  void GenerateSuccessors(const GameState& state, SuccessorBuffer* succ) const;
+
  private:
   typedef base::hash_map<GameState,  // NOLINT(build/include_what_you_use)
                          std::vector<GameState>,
@@ -44,16 +109,21 @@ class AI_EXPORT GameStateTree {
   // Get successor states that are obtained by performing a valid PLACE_PIECE
   // action in |state|. If a PLACE_PIECE action closes a mill, all the valid
   // PLACE_PIECE + REMOVE_PIECE combinations are appended to |succ|.
-  void GetPlaceSuccessors(const GameState& state, std::vector<GameState>* succ);
+  void GetPlaceSuccessors(const GameState& state, SuccessorBuffer* succ) const;
 
   // Get successor states that are obtained by performing a valid MOVE_PIECE
   // action in |state|. If one MOVE_PIECE action closes a mill, all the valid
   // MOVE_PIECE + REMOVE_PIECE combinations are appended to |succ|.
-  void GetMoveSuccessors(const GameState& state, std::vector<GameState>* succ);
+  void GetMoveSuccessors(const GameState& state, SuccessorBuffer* succ) const;
 
   const game::GameOptions& game_options_;
+  bool canonical_keys_;
   SuccessorMap tree_;
 
+  // Scratch buffer used by GetSuccessors() when a state is expanded for the
+  // first time.
+  SuccessorBuffer buffer_;
+
   DISALLOW_COPY_AND_ASSIGN(GameStateTree);
 };
 
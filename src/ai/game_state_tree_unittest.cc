@@ -2,15 +2,20 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <cstdlib>
 #include <vector>
 
 #include "ai/game_state.h"
 #include "ai/game_state_tree.h"
+#include "ai/symmetry.h"
 #include "base/basic_macros.h"
 #include "game/board.h"
 #include "game/board_location.h"
+#include "game/game.h"
 #include "game/game_options.h"
 #include "game/game_type.h"
+#include "game/piece_color.h"
 #include "gtest/gtest.h"
 
 namespace ai {
@@ -214,6 +219,134 @@ TEST_P(GameStateTreeTest, MovesWithMill) {
   }
 }
 
+TEST_P(GameStateTreeTest, CanonicalKeys) {
+  GameState state(game_options().game_type());
+  state.set_current_player(game::WHITE_COLOR);
+  state.set_pieces_in_hand(game::WHITE_COLOR, 2);
+  state.set_pieces_in_hand(game::BLACK_COLOR, 2);
+  state.AddPiece(0, game::WHITE_COLOR);
+  state.AddPiece(1, game::BLACK_COLOR);
+  game_state_tree().set_canonical_keys_enabled(true);
+  for (int s = 0; s < GetSymmetryCount(state.game_type()); ++s) {
+    const GameState symmetric_state(state.GetSymmetricState(s));
+    std::vector<GameState> successors;
+    game_state_tree().GetSuccessors(symmetric_state, &successors);
+    // The symmetric states share one cache entry, but their successors are
+    // still the real ones.
+    EXPECT_EQ(1U, game_state_tree().cache_size());
+    SuccessorBuffer expected_successors;
+    game_state_tree().GenerateSuccessors(symmetric_state,
+                                         &expected_successors);
+    ASSERT_EQ(expected_successors.size(), static_cast<int>(successors.size()));
+    for (size_t i = 0; i < successors.size(); ++i) {
+      EXPECT_TRUE(std::find(expected_successors.begin(),
+                            expected_successors.end(),
+                            successors[i]) != expected_successors.end());
+      EXPECT_FALSE(
+          GameState::GetTransition(symmetric_state, successors[i]).empty());
+    }
+  }
+  game_state_tree().set_canonical_keys_enabled(false);
+  EXPECT_EQ(0U, game_state_tree().cache_size());
+}
+
+// Reference implementation of the successor generation, based on game::Board.
+void GetSuccessorsUsingBoard(const game::GameOptions& options,
+                             const GameState& state,
+                             std::vector<GameState>* successors) {
+  game::Board board(options.game_type());
+  state.Decode(&board);
+  const game::PieceColor player = state.current_player();
+  const game::PieceColor opponent = game::GetOpponent(player);
+  const std::vector<game::BoardLocation>& locations = board.locations();
+  std::vector<game::BoardLocation> player_loc;
+  std::vector<game::BoardLocation> empty_loc;
+  std::vector<game::BoardLocation> removable_loc;
+  std::vector<game::BoardLocation> mill_loc;
+  for (size_t i = 0; i < locations.size(); ++i) {
+    const game::PieceColor color = board.GetPieceAt(locations[i]);
+    if (color == game::NO_COLOR) {
+      empty_loc.push_back(locations[i]);
+    } else if (color == player) {
+      player_loc.push_back(locations[i]);
+    } else if (board.IsPartOfMill(locations[i])) {
+      mill_loc.push_back(locations[i]);
+    } else {
+      removable_loc.push_back(locations[i]);
+    }
+  }
+  if (removable_loc.empty()) {
+    removable_loc = mill_loc;
+  }
+  const bool place = state.pieces_in_hand(player) > 0;
+  const size_t source_count = place ? 1 : player_loc.size();
+  for (size_t i = 0; i < source_count; ++i) {
+    for (size_t j = 0; j < empty_loc.size(); ++j) {
+      GameState successor(state);
+      successor.set_current_player(opponent);
+      if (place) {
+        successor.set_pieces_in_hand(player, state.pieces_in_hand(player) - 1);
+        successor.AddPiece(empty_loc[j], player);
+        board.AddPiece(empty_loc[j], player);
+      } else {
+        if (!board.IsAdjacent(player_loc[i], empty_loc[j]) &&
+            (player_loc.size() > 3 || !options.jumps_allowed())) {
+          continue;
+        }
+        successor.MovePiece(player_loc[i], empty_loc[j]);
+        board.MovePiece(player_loc[i], empty_loc[j]);
+      }
+      if (board.IsPartOfMill(empty_loc[j])) {
+        for (size_t k = 0; k < removable_loc.size(); ++k) {
+          GameState remove_successor(successor);
+          remove_successor.RemovePiece(removable_loc[k]);
+          successors->push_back(remove_successor);
+        }
+      } else {
+        successors->push_back(successor);
+      }
+      if (place) {
+        board.RemovePiece(empty_loc[j]);
+      } else {
+        board.MovePiece(empty_loc[j], player_loc[i]);
+      }
+    }
+  }
+}
+
+TEST_P(GameStateTreeTest, GenerateSuccessorsRandomGames) {
+  std::srand(0);
+  SuccessorBuffer buffer;
+  for (int game = 0; game < 20; ++game) {
+    GameState state(game_options().game_type());
+    state.Encode(board());
+    state.set_current_player(game::WHITE_COLOR);
+    const int pieces =
+        game::Game::GetInitialPieceCountByGameType(game_options().game_type());
+    state.set_pieces_in_hand(game::WHITE_COLOR, pieces);
+    state.set_pieces_in_hand(game::BLACK_COLOR, pieces);
+    for (int move = 0; move < 100; ++move) {
+      std::vector<GameState> expected;
+      GetSuccessorsUsingBoard(game_options(), state, &expected);
+      buffer.clear();
+      game_state_tree().GenerateSuccessors(state, &buffer);
+      std::vector<GameState> actual(buffer.begin(), buffer.end());
+      std::sort(expected.begin(), expected.end());
+      std::sort(actual.begin(), actual.end());
+      ASSERT_EQ(expected.size(), actual.size());
+      EXPECT_TRUE(expected == actual);
+      if (actual.empty()) {
+        break;
+      }
+      state = actual[std::rand() % actual.size()];
+      const game::PieceColor player = state.current_player();
+      if (PopCount(state.pieces(player)) + state.pieces_in_hand(player) < 3) {
+        break;
+      }
+    }
+  }
+}
+
 game::GameOptions ConstructGameOptions(game::GameType type, bool allow_jumps) {
   game::GameOptions result;
   result.set_game_type(type);
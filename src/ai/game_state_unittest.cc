@@ -4,10 +4,15 @@
 
 #include <vector>
 
+#include "ai/alphabeta/evaluators.h"
+#include "ai/bitboard.h"
 #include "ai/game_state.h"
+#include "ai/game_state_tree.h"
 #include "base/basic_macros.h"
 #include "game/board.h"
 #include "game/board_location.h"
+#include "game/game.h"
+#include "game/game_options.h"
 #include "game/game_type.h"
 #include "game/piece_color.h"
 #include "game/player_action.h"
@@ -191,6 +196,124 @@ TEST_P(GameStateTest, GetPlayerActionsMoveWithMill) {
   EXPECT_EQ(game::WHITE_COLOR, actions[1].player_color());
 }
 
+TEST_P(GameStateTest, Bitboards) {
+  const game::GameType game_type = GetParam();
+  game::Board board(game_type);
+  SetUpTestBoard(&board);
+  GameState state(game_type);
+  state.Encode(board);
+  const BitboardLayout& layout = state.layout();
+  const Bitboard white = state.pieces(game::WHITE_COLOR);
+  const Bitboard black = state.pieces(game::BLACK_COLOR);
+  EXPECT_EQ(2, PopCount(white));
+  EXPECT_EQ(2, PopCount(black));
+  EXPECT_EQ(0U, white & black);
+  EXPECT_EQ(layout.all & ~(white | black), state.empty_locations());
+  EXPECT_TRUE(white & BitAt(layout.IndexOf(game::BoardLocation(0, 0))));
+  const int source = LowestBitIndex(black);
+  const int destination = LowestBitIndex(state.empty_locations());
+  GameState moved(state);
+  moved.MovePiece(source, destination);
+  EXPECT_EQ(white, moved.pieces(game::WHITE_COLOR));
+  EXPECT_EQ((black & ~BitAt(source)) | BitAt(destination),
+            moved.pieces(game::BLACK_COLOR));
+  moved.RemovePiece(destination);
+  moved.AddPiece(source, game::BLACK_COLOR);
+  EXPECT_TRUE(state == moved);
+}
+
+TEST_P(GameStateTest, ZobristKey) {
+  const game::GameType game_type = GetParam();
+  GameState empty(game_type);
+  EXPECT_EQ(0U, empty.key());
+  game::Board board(game_type);
+  SetUpTestBoard(&board);
+  GameState encoded(game_type);
+  encoded.set_current_player(game::BLACK_COLOR);
+  encoded.set_pieces_in_hand(game::WHITE_COLOR, 2);
+  encoded.Encode(board);
+  // Build the same state in a different order, going through other states.
+  GameState incremental(game_type);
+  const std::vector<game::BoardLocation>& locations = board.locations();
+  for (size_t i = 0; i < locations.size(); ++i) {
+    const game::PieceColor color = board.GetPieceAt(locations[i]);
+    if (color != game::NO_COLOR) {
+      incremental.AddPiece(locations[i], game::GetOpponent(color));
+      EXPECT_NE(empty.key(), incremental.key());
+      incremental.RemovePiece(locations[i]);
+      incremental.AddPiece(locations[i], color);
+    }
+  }
+  incremental.set_pieces_in_hand(game::WHITE_COLOR, 7);
+  incremental.set_pieces_in_hand(game::WHITE_COLOR, 2);
+  incremental.set_current_player(game::BLACK_COLOR);
+  EXPECT_TRUE(encoded == incremental);
+  EXPECT_EQ(encoded.key(), incremental.key());
+  EXPECT_EQ(GameState::Hash(encoded), GameState::Hash(incremental));
+  incremental.set_current_player(game::WHITE_COLOR);
+  EXPECT_NE(encoded.key(), incremental.key());
+  incremental.set_current_player(game::BLACK_COLOR);
+  const int source = LowestBitIndex(incremental.pieces(game::WHITE_COLOR));
+  const int destination = LowestBitIndex(incremental.empty_locations());
+  incremental.MovePiece(source, destination);
+  EXPECT_NE(encoded.key(), incremental.key());
+  incremental.MovePiece(destination, source);
+  EXPECT_EQ(encoded.key(), incremental.key());
+  // Encoding the same board again must not change the key.
+  encoded.Encode(board);
+  EXPECT_EQ(incremental.key(), encoded.key());
+}
+
+TEST_P(GameStateTest, Features) {
+  const game::GameType game_type = GetParam();
+  game::GameOptions options;
+  options.set_game_type(game_type);
+  GameStateTree tree(options);
+  const int piece_count = game::Game::GetInitialPieceCountByGameType(game_type);
+  GameState state(game_type);
+  state.set_pieces_in_hand(game::WHITE_COLOR, piece_count);
+  state.set_pieces_in_hand(game::BLACK_COLOR, piece_count);
+  // Play a deterministic game through placements, moves, jumps and removals,
+  // checking the features against the evaluators at each step.
+  SuccessorBuffer successors;
+  for (int ply = 0; ply < 200; ++ply) {
+    game::Board board(game_type);
+    state.Decode(&board);
+    const game::PieceColor colors[] = { game::WHITE_COLOR, game::BLACK_COLOR };
+    for (size_t i = 0; i < arraysize(colors); ++i) {
+      EXPECT_EQ(alphabeta::Mobility(board, colors[i]),
+                state.mobility(colors[i]));
+      EXPECT_EQ(alphabeta::Material(board, colors[i]),
+                PopCount(state.pieces(colors[i])));
+      EXPECT_EQ(alphabeta::Mills(board, colors[i]),
+                state.pieces_in_mills(colors[i]));
+      // The features do not depend on the orientation of the board.
+      const GameState canonical_state(state.GetCanonicalState(NULL));
+      EXPECT_EQ(state.mobility(colors[i]),
+                canonical_state.mobility(colors[i]));
+      EXPECT_EQ(state.pieces_in_mills(colors[i]),
+                canonical_state.pieces_in_mills(colors[i]));
+    }
+    successors.clear();
+    tree.GenerateSuccessors(state, &successors);
+    if (successors.empty() ||
+        PopCount(state.pieces(state.current_player())) +
+        state.pieces_in_hand(state.current_player()) < 3) {
+      break;
+    }
+    state = successors[(ply * 7) % successors.size()];
+  }
+  // Encoding a board recomputes the features.
+  game::Board board(game_type);
+  state.Decode(&board);
+  GameState encoded(game_type);
+  encoded.Encode(board);
+  EXPECT_EQ(state.mobility(game::WHITE_COLOR),
+            encoded.mobility(game::WHITE_COLOR));
+  EXPECT_EQ(state.pieces_in_mills(game::BLACK_COLOR),
+            encoded.pieces_in_mills(game::BLACK_COLOR));
+}
+
 INSTANTIATE_TEST_CASE_P(GameStateTestInstance,
                         GameStateTest,
                         ::testing::Values(game::THREE_MEN_MORRIS,
@@ -0,0 +1,436 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/mcts/mcts_algorithm.h"
+
+#include <stdint.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "ai/mcts/node_arena.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/log.h"
+#include "base/method.h"
+#include "base/ptr/scoped_ptr.h"
+#include "base/random.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
+#include "base/threading/thread.h"
+#include "game/board_location.h"
+#include "game/game.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace mcts {
+namespace {
+
+const game::BoardLocation kInvalidLocation(-1, -1);
+
+// The playouts that are longer than this are counted as draws.
+const int kMaxPlayoutLength = 200;
+
+// The clock is read once every this many playouts of a worker.
+const int kTimeCheckInterval = 16;
+
+// Returns the index of the descendant of the node given by |index| whose state
+// is |state|, searching at most |depth| levels deep, or -1 if there is none.
+int FindDescendant(const NodeArena& arena,
+                   int index,
+                   const GameState& state,
+                   int depth) {
+  const Node& node = arena[index];
+  if (node.state == state) {
+    return index;
+  }
+  if (depth == 0 || node.expansion.Get() != Node::EXPANDED) {
+    return -1;
+  }
+  for (int i = 0; i < node.child_count; ++i) {
+    const int descendant =
+        FindDescendant(arena, node.first_child + i, state, depth - 1);
+    if (descendant >= 0) {
+      return descendant;
+    }
+  }
+  return -1;
+}
+
+}  // anonymous namespace
+
+// A search tree whose root is always the node at index 0. It owns a second
+// arena, into which the subtree of the next root is moved when the tree is
+// reused.
+class MctsAlgorithm::SearchTree {
+ public:
+  explicit SearchTree(int capacity) : current_(0) {
+    Reset(arenas_[0], new NodeArena(capacity));
+    Reset(arenas_[1], new NodeArena(capacity));
+  }
+
+  NodeArena* arena() { return Get(arenas_[current_]); }
+
+  // Makes |state| the root of the tree. If |reuse| is true and |state| is the
+  // root or one of its descendants from the next two plies, its subtree is
+  // kept. Returns the number of nodes that were kept.
+  int SetRoot(const GameState& state, bool reuse) {
+    NodeArena* const arena = Get(arenas_[current_]);
+    const int root = reuse && arena->size() > 0 ?
+        FindDescendant(*arena, 0, state, 2) : -1;
+    if (root == 0) {
+      return arena->size();
+    }
+    if (root > 0) {
+      NodeArena* const spare = Get(arenas_[1 - current_]);
+      spare->Clear();
+      CopySubtree(*arena, root, spare);
+      arena->Clear();
+      current_ = 1 - current_;
+      return spare->size();
+    }
+    arena->Clear();
+    (*arena)[arena->Allocate(1)].Init(state);
+    return 0;
+  }
+
+ private:
+  base::ptr::scoped_ptr<NodeArena> arenas_[2];
+  int current_;
+
+  DISALLOW_COPY_AND_ASSIGN(SearchTree);
+};
+
+// The data used by one of the threads that perform playouts.
+struct MctsAlgorithm::Worker {
+  explicit Worker(uint32_t seed)
+      : random(seed), playout_count(0), playout_quota(0) {}
+
+  base::XorShift64Star random;
+  SuccessorBuffer successors;
+
+  // The indices of the nodes visited by the current iteration.
+  std::vector<int> path;
+
+  int64_t playout_count;
+  int64_t playout_quota;
+};
+
+MctsAlgorithm::MctsAlgorithm(const game::GameOptions& options)
+    : options_(options),
+      tree_(options_),
+      max_playout_count_(0),
+      max_search_time_(1000000000),  // One second
+      exploration_(1.4),
+      thread_count_(1),
+      parallel_mode_(TREE_PARALLEL),
+      max_tree_size_(1 << 18),
+      tree_reuse_(true),
+      seed_(5489U),
+      stop_(0),
+      start_time_(0),
+      playout_count_(0),
+      node_count_(0),
+      reused_node_count_(0),
+      remove_location_(kInvalidLocation) {}
+
+MctsAlgorithm::~MctsAlgorithm() {
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    delete trees_[i];
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    delete workers_[i];
+  }
+}
+
+void MctsAlgorithm::set_thread_count(int count) {
+  DCHECK_GT(count, 0);
+  thread_count_ = count;
+}
+
+void MctsAlgorithm::set_parallel_mode(ParallelMode mode) {
+  parallel_mode_ = mode;
+}
+
+void MctsAlgorithm::set_max_tree_size(int size) {
+  // The children of the root must fit in the tree.
+  DCHECK_GT(size, SuccessorBuffer::kCapacity);
+  if (size == max_tree_size_) {
+    return;
+  }
+  max_tree_size_ = size;
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    delete trees_[i];
+  }
+  trees_.clear();
+}
+
+void MctsAlgorithm::set_seed(uint32_t seed) {
+  seed_ = seed;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    delete workers_[i];
+  }
+  workers_.clear();
+}
+
+game::PlayerAction MctsAlgorithm::GetNextAction(const game::Game& game_model) {
+  DCHECK_EQ(options_, game_model.options());
+  if (game_model.next_action_type() == game::PlayerAction::REMOVE_PIECE) {
+    game::PlayerAction action(game_model.current_player(),
+                              game::PlayerAction::REMOVE_PIECE);
+    action.set_source(remove_location_);
+    return action;
+  }
+  CreateTrees();
+  CreateWorkers();
+  GameState origin;
+  origin.Encode(game_model);
+  reused_node_count_ = 0;
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    reused_node_count_ += trees_[i]->SetRoot(origin, tree_reuse_);
+    // The children of the root are added before the search starts, so there
+    // is a move to choose even if no playout is performed.
+    const bool expanded = Expand(trees_[i]->arena(), 0, workers_[0]);
+    DCHECK(expanded);
+  }
+
+  // The main thread is the first worker.
+  stop_.BitwiseAnd(0);
+  start_time_ = base::GetMonotonicTime();
+  std::vector<base::threading::Thread*> threads;
+  for (int i = 1; i < thread_count_; ++i) {
+    threads.push_back(
+        new base::threading::Thread("MCTS worker " + base::ToString(i)));
+    threads.back()->Start();
+    threads.back()->SubmitTask(FROM_HERE,
+        base::Bind(new base::Method<void(MctsAlgorithm::*)(int)>(
+            &MctsAlgorithm::RunWorker), this, i));
+  }
+  RunWorker(0);
+  playout_count_ = workers_[0]->playout_count;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i]->SubmitQuitTaskAndJoin();
+    delete threads[i];
+    playout_count_ += workers_[i + 1]->playout_count;
+  }
+
+  // The roots of all the trees have the same children, in the same order.
+  const Node& root = (*trees_[0]->arena())[0];
+  std::vector<int64_t> visits(root.child_count, 0);
+  node_count_ = 0;
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    const NodeArena& arena = *trees_[i]->arena();
+    DCHECK_EQ(arena[0].child_count, root.child_count);
+    for (int k = 0; k < root.child_count; ++k) {
+      visits[k] += arena[arena[0].first_child + k].visits.Get();
+    }
+    node_count_ += arena.size();
+  }
+  int best_child = 0;
+  for (int k = 1; k < root.child_count; ++k) {
+    if (visits[k] > visits[best_child]) {
+      best_child = k;
+    }
+  }
+  const std::vector<game::PlayerAction> actions = GameState::GetTransition(
+      origin, (*trees_[0]->arena())[root.first_child + best_child].state);
+  if (actions.size() > 1) {
+    remove_location_ = actions[1].source();
+  } else {
+#if defined(DEBUG_MODE)
+    remove_location_ = kInvalidLocation;
+#endif
+  }
+  return actions[0];
+}
+
+void MctsAlgorithm::CreateTrees() {
+  const size_t tree_count =
+      parallel_mode_ == ROOT_PARALLEL ? thread_count_ : 1;
+  while (trees_.size() > tree_count) {
+    delete trees_.back();
+    trees_.pop_back();
+  }
+  while (trees_.size() < tree_count) {
+    trees_.push_back(new SearchTree(max_tree_size_));
+  }
+}
+
+void MctsAlgorithm::CreateWorkers() {
+  while (workers_.size() > static_cast<size_t>(thread_count_)) {
+    delete workers_.back();
+    workers_.pop_back();
+  }
+  while (workers_.size() < static_cast<size_t>(thread_count_)) {
+    workers_.push_back(new Worker(seed_ + workers_.size()));
+  }
+}
+
+void MctsAlgorithm::RunWorker(int worker_index) {
+  Worker* const worker = workers_[worker_index];
+  SearchTree* const tree =
+      trees_[parallel_mode_ == ROOT_PARALLEL ? worker_index : 0];
+  worker->playout_count = 0;
+  // The playouts are split between the workers, so the searches performed by
+  // one thread are reproducible.
+  worker->playout_quota =
+      (max_playout_count_ + thread_count_ - 1 - worker_index) / thread_count_;
+  while (!ShouldStop(*worker)) {
+    RunIteration(tree, worker);
+    ++worker->playout_count;
+  }
+}
+
+bool MctsAlgorithm::ShouldStop(const Worker& worker) {
+  if (stop_.Get()) {
+    return true;
+  }
+  if (max_playout_count_ > 0 && worker.playout_count >= worker.playout_quota) {
+    return true;
+  }
+  if (worker.playout_count % kTimeCheckInterval == 0 &&
+      base::GetMonotonicTime() - start_time_ > max_search_time_) {
+    stop_.BitwiseOr(1);
+    return true;
+  }
+  return false;
+}
+
+void MctsAlgorithm::RunIteration(SearchTree* tree, Worker* worker) {
+  NodeArena* const arena = tree->arena();
+  std::vector<int>& path = worker->path;
+  path.clear();
+  int index = 0;
+  path.push_back(index);
+  (*arena)[index].virtual_losses.Increment();
+  // Selection and expansion: the descent stops at the first node that was not
+  // visited yet, or at a node that has no children.
+  while (Expand(arena, index, worker) && (*arena)[index].child_count > 0) {
+    index = SelectChild(*arena, index);
+    path.push_back(index);
+    Node& child = (*arena)[index];
+    const bool visited = child.visits.Get() + child.virtual_losses.Get() > 0;
+    child.virtual_losses.Increment();
+    if (!visited) {
+      break;
+    }
+  }
+  const game::PieceColor winner = Playout((*arena)[index].state, worker);
+  // Backpropagation: each node is rewarded for the player that moved into it.
+  for (size_t i = 0; i < path.size(); ++i) {
+    Node& node = (*arena)[path[i]];
+    const game::PieceColor mover =
+        game::GetOpponent(node.state.current_player());
+    node.reward.Add(winner == mover ? 2 : (winner == game::NO_COLOR ? 1 : 0));
+    node.visits.Increment();
+    node.virtual_losses.Decrement();
+  }
+}
+
+bool MctsAlgorithm::Expand(NodeArena* arena, int index, Worker* worker) const {
+  Node& node = (*arena)[index];
+  if (!node.expansion.CompareAndSwap(Node::NOT_EXPANDED, Node::EXPANDING)) {
+    return node.expansion.Get() == Node::EXPANDED;
+  }
+  SuccessorBuffer& successors = worker->successors;
+  successors.clear();
+  const GameState& state = node.state;
+  const game::PieceColor player = state.current_player();
+  if (!IsLost(state.pieces(player), state.pieces_in_hand(player))) {
+    tree_.GenerateSuccessors(state, &successors);
+  }
+  const int first_child = arena->Allocate(successors.size());
+  if (first_child < 0) {
+    // The tree is full, so the playouts start from this node.
+    node.expansion.CompareAndSwap(Node::EXPANDING, Node::NOT_EXPANDED);
+    return false;
+  }
+  for (int i = 0; i < successors.size(); ++i) {
+    (*arena)[first_child + i].Init(successors[i]);
+  }
+  node.first_child = first_child;
+  node.child_count = successors.size();
+  // The atomic operation publishes the children to the other threads.
+  node.expansion.CompareAndSwap(Node::EXPANDING, Node::EXPANDED);
+  return true;
+}
+
+int MctsAlgorithm::SelectChild(const NodeArena& arena, int parent) const {
+  const Node& node = arena[parent];
+  DCHECK_GT(node.child_count, 0);
+  // The virtual losses count as visits that did not add any reward.
+  const int parent_visits = node.visits.Get() + node.virtual_losses.Get();
+  const double log_visits = std::log(static_cast<double>(
+      parent_visits > 1 ? parent_visits : 1));
+  int best_child = node.first_child;
+  double best_value = -std::numeric_limits<double>::max();
+  for (int i = 0; i < node.child_count; ++i) {
+    const Node& child = arena[node.first_child + i];
+    const int visits = child.visits.Get() + child.virtual_losses.Get();
+    if (visits == 0) {
+      return node.first_child + i;
+    }
+    const double value = child.reward.Get() / (2.0 * visits) +
+                         exploration_ * std::sqrt(log_visits / visits);
+    if (value > best_value) {
+      best_value = value;
+      best_child = node.first_child + i;
+    }
+  }
+  return best_child;
+}
+
+game::PieceColor MctsAlgorithm::Playout(const GameState& state,
+                                        Worker* worker) const {
+  // The game is played on copies of the bitboards, without creating the
+  // successor states. Each move is chosen uniformly among the moves of the
+  // current player, and the removed piece among the removable ones.
+  const BitboardLayout& layout = state.layout();
+  const game::PieceColor colors[] = {
+    state.current_player(), game::GetOpponent(state.current_player())
+  };
+  Bitboard pieces[] = { state.pieces(colors[0]), state.pieces(colors[1]) };
+  int pieces_in_hand[] = {
+    state.pieces_in_hand(colors[0]), state.pieces_in_hand(colors[1])
+  };
+  base::XorShift64Star* const random = &worker->random;
+  for (int ply = 0; ply < kMaxPlayoutLength; ++ply) {
+    const int player = ply % 2;
+    Bitboard& own = pieces[player];
+    Bitboard& other = pieces[1 - player];
+    if (IsLost(own, pieces_in_hand[player])) {
+      return colors[1 - player];
+    }
+    const Bitboard empty = layout.all & ~(own | other);
+    int source = -1;
+    int destination = -1;
+    if (pieces_in_hand[player] > 0) {
+      destination = GetRandomLocation(empty, random);
+      --pieces_in_hand[player];
+    } else if (options_.jumps_allowed() && PopCount(own) <= 3) {
+      source = GetRandomLocation(own, random);
+      destination = GetRandomLocation(empty, random);
+    } else if (!GetRandomAdjacentMove(layout, own, empty, random, &source,
+                                      &destination)) {
+      return colors[1 - player];
+    }
+    if (source >= 0) {
+      own &= ~BitAt(source);
+    }
+    own |= BitAt(destination);
+    if (IsPartOfMill(layout, own, destination)) {
+      other &= ~BitAt(
+          GetRandomLocation(GetRemovablePieces(layout, other), random));
+    }
+  }
+  return game::NO_COLOR;
+}
+
+}  // namespace mcts
+}  // namespace ai
@@ -0,0 +1,174 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_MCTS_MCTS_ALGORITHM_H_
+#define AI_MCTS_MCTS_ALGORITHM_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "base/basic_macros.h"
+#include "base/threading/atomic.h"
+#include "game/board_location.h"
+#include "game/game_options.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace game {
+class Game;
+}
+
+namespace ai {
+namespace mcts {
+
+class NodeArena;
+
+// Monte Carlo Tree Search with the UCT selection rule. Each iteration descends
+// the tree by choosing the child that maximizes the upper confidence bound of
+// its win rate, adds the children of the first node that was already visited
+// once, and plays a random game (playout) from the new node. The result of the
+// playout is propagated back to the root, and the move that leads to the most
+// visited child of the root is played.
+//
+// The nodes are allocated from a fixed-size arena and the playouts move the
+// pieces directly on the bitboards of the states, so the search does not
+// allocate memory. The subtree of the position reached after the
+// opponent's reply is kept for the next search.
+class AI_EXPORT MctsAlgorithm : public AIAlgorithm {
+ public:
+  // The ways in which multiple threads search a position.
+  enum ParallelMode {
+    // Each thread builds its own tree, and the visits of the children of the
+    // roots are added when the move is chosen.
+    ROOT_PARALLEL,
+    // All the threads build the same tree. Each thread adds a virtual loss to
+    // the nodes on its path until its playout is over, so the other threads
+    // prefer different paths.
+    TREE_PARALLEL
+  };
+
+  explicit MctsAlgorithm(const game::GameOptions& options);
+  ~MctsAlgorithm();
+
+  // The search stops when |max_playout_count| playouts were performed by all
+  // the threads, or when it ran for |max_search_time| nanoseconds. A zero
+  // playout count means that only the time is limited. By default, the search
+  // runs for one second.
+  int64_t max_playout_count() const { return max_playout_count_; }
+  void set_max_playout_count(int64_t count) { max_playout_count_ = count; }
+  int64_t max_search_time() const { return max_search_time_; }
+  void set_max_search_time(int64_t max_time) { max_search_time_ = max_time; }
+
+  // The constant that multiplies the exploration term of the UCT formula.
+  // Larger values search more moves, smaller values search the best moves
+  // deeper. By default, it is 1.4.
+  double exploration() const { return exploration_; }
+  void set_exploration(double exploration) { exploration_ = exploration; }
+
+  // The number of threads that perform playouts, including the thread that
+  // calls GetNextAction(). By default, the search is single threaded, in the
+  // TREE_PARALLEL mode.
+  int thread_count() const { return thread_count_; }
+  void set_thread_count(int count);
+  ParallelMode parallel_mode() const { return parallel_mode_; }
+  void set_parallel_mode(ParallelMode mode);
+
+  // The number of nodes that each tree can store. When a tree is full, the
+  // search continues without expanding new nodes. Changing it discards the
+  // trees. By default, it is 2^18.
+  int max_tree_size() const { return max_tree_size_; }
+  void set_max_tree_size(int size);
+
+  // If enabled, the subtree of the current position is kept from the tree
+  // built by the previous search, if it is still there. By default, it is
+  // enabled.
+  bool is_tree_reuse_enabled() const { return tree_reuse_; }
+  void set_tree_reuse_enabled(bool enable) { tree_reuse_ = enable; }
+
+  // Sets the seed of the random number generators used by the playouts. The
+  // searches performed by one thread with a playout limit are reproducible.
+  void set_seed(uint32_t seed);
+
+  // The statistics of the last search: the number of playouts, the number of
+  // nodes of all the trees, and the number of nodes kept from the previous
+  // search.
+  int64_t playout_count() const { return playout_count_; }
+  int64_t node_count() const { return node_count_; }
+  int64_t reused_node_count() const { return reused_node_count_; }
+
+ private:
+  class SearchTree;
+  struct Worker;
+
+  // AIAlgorithm interface
+  virtual game::PlayerAction GetNextAction(const game::Game& game_model);
+
+  // Creates the trees and the workers needed by the current settings.
+  void CreateTrees();
+  void CreateWorkers();
+
+  // Performs playouts on the tree of the worker given by |worker_index| until
+  // the search is stopped. It is run by each thread.
+  void RunWorker(int worker_index);
+
+  // Returns true if the search must stop. The clock is only read every few
+  // playouts.
+  bool ShouldStop(const Worker& worker);
+
+  // Performs one iteration of the search on |tree|: selection, expansion,
+  // playout and backpropagation.
+  void RunIteration(SearchTree* tree, Worker* worker);
+
+  // Adds the children of the node given by |index|, unless another thread is
+  // adding them or the arena is full. Returns true if the node is expanded.
+  bool Expand(NodeArena* arena, int index, Worker* worker) const;
+
+  // Returns the index of the child of |parent| with the highest UCT value.
+  int SelectChild(const NodeArena& arena, int parent) const;
+
+  // Plays random moves from |state| until the game is over and returns the
+  // winner, or game::NO_COLOR if the game is too long and counts as a draw.
+  // It uses the same rules as GameStateTree::GenerateSuccessors().
+  game::PieceColor Playout(const GameState& state, Worker* worker) const;
+
+  const game::GameOptions options_;
+  GameStateTree tree_;
+
+  int64_t max_playout_count_;
+  int64_t max_search_time_;
+  double exploration_;
+  int thread_count_;
+  ParallelMode parallel_mode_;
+  int max_tree_size_;
+  bool tree_reuse_;
+  uint32_t seed_;
+
+  // One tree per thread in the ROOT_PARALLEL mode, or a single tree.
+  std::vector<SearchTree*> trees_;
+  std::vector<Worker*> workers_;
+
+  // The state of the running search.
+  base::threading::Atomic<int> stop_;
+  int64_t start_time_;
+
+  int64_t playout_count_;
+  int64_t node_count_;
+  int64_t reused_node_count_;
+
+  // If the last action returned by GetNextAction() closed a mill, the location
+  // of the piece that must be removed.
+  game::BoardLocation remove_location_;
+
+  DISALLOW_COPY_AND_ASSIGN(MctsAlgorithm);
+};
+
+}  // namespace mcts
+}  // namespace ai
+
+#endif  // AI_MCTS_MCTS_ALGORITHM_H_
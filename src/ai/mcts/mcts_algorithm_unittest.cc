@@ -0,0 +1,122 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/ai_algorithm.h"
+#include "ai/mcts/mcts_algorithm.h"
+#include "ai/random/random_algorithm.h"
+#include "base/basic_macros.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace mcts {
+namespace {
+
+// Executes the next action of |player| in |game_model|.
+void ExecuteNextAction(AIAlgorithm* player, game::Game* game_model) {
+  const game::PlayerAction action = player->GetNextAction(*game_model);
+  ASSERT_TRUE(game_model->CanExecutePlayerAction(action));
+  game_model->ExecutePlayerAction(action);
+}
+
+class MctsAlgorithmTest : public ::testing::TestWithParam<game::GameType> {
+};
+
+TEST_P(MctsAlgorithmTest, SelfPlay) {
+  game::GameOptions options;
+  options.set_game_type(GetParam());
+  MctsAlgorithm algorithm(options);
+  algorithm.set_max_playout_count(200);
+  game::Game test_game(options);
+  test_game.Initialize();
+  for (int i = 0; i < 50 && !test_game.is_game_over(); ++i) {
+    const bool search =
+        test_game.next_action_type() != game::PlayerAction::REMOVE_PIECE;
+    ExecuteNextAction(&algorithm, &test_game);
+    if (search) {
+      EXPECT_EQ(200, algorithm.playout_count());
+      EXPECT_GT(algorithm.node_count(), 1);
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(MctsAlgorithmTestInstance,
+                        MctsAlgorithmTest,
+                        ::testing::Values(game::THREE_MEN_MORRIS,
+                                          game::SIX_MEN_MORRIS,
+                                          game::NINE_MEN_MORRIS));
+
+TEST(MctsAlgorithm, BeatsRandomPlayer) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  MctsAlgorithm algorithm(options);
+  algorithm.set_max_playout_count(1000);
+  random::RandomAlgorithm random_player(12345);
+  game::Game test_game(options);
+  test_game.Initialize();
+  for (int i = 0; i < 300 && !test_game.is_game_over(); ++i) {
+    AIAlgorithm* const player =
+        test_game.current_player() == game::WHITE_COLOR ?
+            static_cast<AIAlgorithm*>(&algorithm) : &random_player;
+    ExecuteNextAction(player, &test_game);
+  }
+  ASSERT_TRUE(test_game.is_game_over());
+  EXPECT_EQ(game::WHITE_COLOR, test_game.winner());
+}
+
+TEST(MctsAlgorithm, TreeReuse) {
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  const bool reuse[] = { true, false };
+  for (size_t i = 0; i < arraysize(reuse); ++i) {
+    MctsAlgorithm algorithm(options);
+    algorithm.set_max_playout_count(2000);
+    algorithm.set_tree_reuse_enabled(reuse[i]);
+    game::Game test_game(options);
+    test_game.Initialize();
+    // No mills can be closed during the first moves.
+    ExecuteNextAction(&algorithm, &test_game);
+    EXPECT_EQ(0, algorithm.reused_node_count());
+    ExecuteNextAction(&algorithm, &test_game);
+    ExecuteNextAction(&algorithm, &test_game);
+    if (reuse[i]) {
+      EXPECT_GT(algorithm.reused_node_count(), 1);
+    } else {
+      EXPECT_EQ(0, algorithm.reused_node_count());
+    }
+  }
+}
+
+TEST(MctsAlgorithm, ParallelModes) {
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  const MctsAlgorithm::ParallelMode modes[] = {
+    MctsAlgorithm::ROOT_PARALLEL, MctsAlgorithm::TREE_PARALLEL
+  };
+  for (size_t i = 0; i < arraysize(modes); ++i) {
+    MctsAlgorithm algorithm(options);
+    algorithm.set_max_playout_count(1001);
+    algorithm.set_thread_count(4);
+    algorithm.set_max_tree_size(1 << 16);
+    algorithm.set_parallel_mode(modes[i]);
+    game::Game test_game(options);
+    test_game.Initialize();
+    for (int j = 0; j < 10 && !test_game.is_game_over(); ++j) {
+      const bool search =
+          test_game.next_action_type() != game::PlayerAction::REMOVE_PIECE;
+      ExecuteNextAction(&algorithm, &test_game);
+      if (search) {
+        EXPECT_EQ(1001, algorithm.playout_count());
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
+}  // namespace mcts
+}  // namespace ai
@@ -0,0 +1,64 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/mcts/node_arena.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/log.h"
+
+namespace ai {
+namespace mcts {
+
+void Node::Init(const GameState& node_state) {
+  state = node_state;
+  first_child = -1;
+  child_count = 0;
+  expansion = base::threading::Atomic<int>(NOT_EXPANDED);
+  visits = base::threading::Atomic<int>(0);
+  virtual_losses = base::threading::Atomic<int>(0);
+  reward = base::threading::Atomic<int64_t>(0);
+}
+
+NodeArena::NodeArena(int capacity) : nodes_(capacity), size_(0) {
+  DCHECK_GT(capacity, 0);
+}
+
+int NodeArena::Allocate(int count) {
+  int begin;
+  do {
+    begin = size_.Get();
+    if (begin + count > capacity()) {
+      return -1;
+    }
+  } while (!size_.CompareAndSwap(begin, begin + count));
+  return begin;
+}
+
+void CopySubtree(const NodeArena& source, int root, NodeArena* destination) {
+  DCHECK_EQ(destination->size(), 0);
+  DCHECK_EQ(source.capacity(), destination->capacity());
+  const int root_copy = destination->Allocate(1);
+  (*destination)[root_copy] = source[root];
+  // The destination nodes are visited in the order in which they are
+  // allocated, so the arena itself is the queue of the breadth-first search.
+  // The first child of each copied node still points into |source|.
+  for (int i = root_copy; i < destination->size(); ++i) {
+    Node& node = (*destination)[i];
+    DCHECK(node.expansion.Get() != Node::EXPANDING);
+    if (node.expansion.Get() != Node::EXPANDED || node.child_count == 0) {
+      continue;
+    }
+    const int first_child = destination->Allocate(node.child_count);
+    DCHECK(first_child >= 0);
+    for (int k = 0; k < node.child_count; ++k) {
+      (*destination)[first_child + k] = source[node.first_child + k];
+    }
+    node.first_child = first_child;
+  }
+}
+
+}  // namespace mcts
+}  // namespace ai
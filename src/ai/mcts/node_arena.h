@@ -0,0 +1,99 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_MCTS_NODE_ARENA_H_
+#define AI_MCTS_NODE_ARENA_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "base/basic_macros.h"
+#include "base/log.h"
+#include "base/threading/atomic.h"
+
+namespace ai {
+namespace mcts {
+
+// A node of the search tree. The statistics are updated with atomic operations,
+// so the same tree can be searched by multiple threads.
+struct AI_EXPORT Node {
+  // The values of |expansion|.
+  enum {
+    NOT_EXPANDED = 0,
+    // A thread is adding the children of the node.
+    EXPANDING,
+    // The children are stored at |first_child|. A node without children is a
+    // terminal state, which is lost by its current player.
+    EXPANDED
+  };
+
+  // Resets the statistics and sets the |state| of an unexpanded node.
+  void Init(const GameState& node_state);
+
+  GameState state;
+
+  // The children of a node are stored in consecutive nodes of the arena,
+  // in the order in which GameStateTree generates the successors.
+  int first_child;
+  int child_count;
+  base::threading::Atomic<int> expansion;
+
+  // The number of playouts that passed through this node, the number of
+  // playouts that are still running through it and the sum of their results
+  // for the player that moved into |state|. The results are counted in half
+  // points: 2 for a win, 1 for a draw and 0 for a loss.
+  base::threading::Atomic<int> visits;
+  base::threading::Atomic<int> virtual_losses;
+  base::threading::Atomic<int64_t> reward;
+};
+
+// Fixed-capacity storage for the nodes of a search tree. The nodes are never
+// freed individually: the whole arena is cleared when the tree is discarded, so
+// the search does not allocate memory on the heap after the arena is created.
+class AI_EXPORT NodeArena {
+ public:
+  explicit NodeArena(int capacity);
+
+  int capacity() const { return nodes_.size(); }
+  int size() const { return size_.Get(); }
+
+  // Reserves |count| consecutive nodes and returns the index of the first one,
+  // or -1 if there is not enough space left. The nodes are not initialized.
+  // This method can be called by multiple threads at the same time.
+  int Allocate(int count);
+
+  // Removes all the nodes from the arena.
+  void Clear() { size_.BitwiseAnd(0); }
+
+  Node& operator[](int index) {
+    DCHECK_LT(index, size_.Get());
+    return nodes_[index];
+  }
+  const Node& operator[](int index) const {
+    DCHECK_LT(index, size_.Get());
+    return nodes_[index];
+  }
+
+ private:
+  std::vector<Node> nodes_;
+  base::threading::Atomic<int> size_;
+
+  DISALLOW_COPY_AND_ASSIGN(NodeArena);
+};
+
+// Copies the subtree rooted at the node |root| from |source| into the empty
+// arena |destination|, which must have the same capacity. The copy of |root| is
+// stored at index 0. The children are copied level by level, so they are still
+// stored in consecutive nodes.
+AI_EXPORT void CopySubtree(const NodeArena& source,
+                           int root,
+                           NodeArena* destination);
+
+}  // namespace mcts
+}  // namespace ai
+
+#endif  // AI_MCTS_NODE_ARENA_H_
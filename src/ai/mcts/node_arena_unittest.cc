@@ -0,0 +1,72 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/game_state.h"
+#include "ai/mcts/node_arena.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace mcts {
+namespace {
+
+// Initializes the |count| nodes that start at |first| with distinct states.
+void InitNodes(NodeArena* arena, int first, int count) {
+  for (int i = first; i < first + count; ++i) {
+    GameState state(game::SIX_MEN_MORRIS);
+    state.AddPiece(i, game::WHITE_COLOR);
+    (*arena)[i].Init(state);
+    (*arena)[i].visits.Add(i);
+  }
+}
+
+// Marks the node given by |index| as expanded with |count| children.
+void SetChildren(NodeArena* arena, int index, int first_child, int count) {
+  Node& node = (*arena)[index];
+  node.first_child = first_child;
+  node.child_count = count;
+  node.expansion.CompareAndSwap(Node::NOT_EXPANDED, Node::EXPANDED);
+}
+
+TEST(NodeArena, Allocate) {
+  NodeArena arena(10);
+  EXPECT_EQ(10, arena.capacity());
+  EXPECT_EQ(0, arena.size());
+  EXPECT_EQ(0, arena.Allocate(4));
+  EXPECT_EQ(4, arena.Allocate(6));
+  EXPECT_EQ(-1, arena.Allocate(1));
+  EXPECT_EQ(10, arena.size());
+  arena.Clear();
+  EXPECT_EQ(0, arena.size());
+  EXPECT_EQ(0, arena.Allocate(1));
+}
+
+TEST(NodeArena, CopySubtree) {
+  // 0 -> {1, 2}, 2 -> {3, 4, 5}, 4 -> {6}
+  NodeArena source(10);
+  ASSERT_EQ(0, source.Allocate(7));
+  InitNodes(&source, 0, 7);
+  SetChildren(&source, 0, 1, 2);
+  SetChildren(&source, 2, 3, 3);
+  SetChildren(&source, 4, 6, 1);
+  NodeArena destination(10);
+  CopySubtree(source, 2, &destination);
+  ASSERT_EQ(5, destination.size());
+  const int expected_sources[] = { 2, 3, 4, 5, 6 };
+  for (int i = 0; i < destination.size(); ++i) {
+    EXPECT_EQ(source[expected_sources[i]].state, destination[i].state);
+    EXPECT_EQ(expected_sources[i], destination[i].visits.Get());
+  }
+  EXPECT_EQ(1, destination[0].first_child);
+  EXPECT_EQ(3, destination[0].child_count);
+  EXPECT_EQ(Node::NOT_EXPANDED, destination[1].expansion.Get());
+  EXPECT_EQ(Node::EXPANDED, destination[2].expansion.Get());
+  EXPECT_EQ(4, destination[2].first_child);
+  EXPECT_EQ(1, destination[2].child_count);
+}
+
+}  // anonymous namespace
+}  // namespace mcts
+}  // namespace ai
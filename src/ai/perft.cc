@@ -0,0 +1,167 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/perft.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "base/log.h"
+#include "game/board.h"
+#include "game/board_location.h"
+#include "game/game.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace {
+
+// Appends to |actions| all the actions that can be executed next in
+// |game_model|. The candidates are checked with the same methods that check the
+// actions of the human players.
+void GetValidActions(const game::Game& game_model,
+                     std::vector<game::PlayerAction>* actions) {
+  const game::Board& board = game_model.board();
+  const std::vector<game::BoardLocation>& locations = board.locations();
+  const game::PieceColor player = game_model.current_player();
+  const game::PlayerAction::ActionType type = game_model.next_action_type();
+  const size_t source_count =
+      type == game::PlayerAction::MOVE_PIECE ? locations.size() : 1;
+  for (size_t i = 0; i < source_count; ++i) {
+    for (size_t j = 0; j < locations.size(); ++j) {
+      game::PlayerAction action(player, type);
+      switch (type) {
+        case game::PlayerAction::MOVE_PIECE:
+          action.set_source(locations[i]);
+          action.set_destination(locations[j]);
+          break;
+        case game::PlayerAction::PLACE_PIECE:
+          action.set_destination(locations[j]);
+          break;
+        case game::PlayerAction::REMOVE_PIECE:
+          action.set_source(locations[j]);
+          break;
+      }
+      if (!action.CanExecuteOn(board)) {
+        continue;
+      }
+      // game::Game leaves the jumps to be checked by its clients.
+      if (action.IsJumpOn(board) && !game_model.CanJump()) {
+        continue;
+      }
+      if (game_model.CanExecutePlayerAction(action)) {
+        actions->push_back(action);
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
+
+Perft::Perft(const game::GameOptions& options)
+    : options_(options), tree_(), buffers_() {}
+
+Perft::~Perft() {
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    delete buffers_[i];
+  }
+}
+
+int64_t Perft::CountLeaves(const game::Game& game_model,
+                           int depth,
+                           Method method) {
+  DCHECK_EQ(options_, game_model.options());
+  DCHECK(depth >= 0);
+  // Each count uses a new tree, so the successors cached by GET_SUCCESSORS do
+  // not speed up the next counts.
+  Reset(tree_, new GameStateTree(options_));
+  while (static_cast<int>(buffers_.size()) <= depth) {
+    buffers_.push_back(new SuccessorBuffer());
+  }
+  // game::Game cannot be copied, so its actions are replayed on a new game.
+  std::vector<game::PlayerAction> actions;
+  game_model.DumpActionList(&actions);
+  game::Game replay(options_);
+  replay.Initialize();
+  for (size_t i = 0; i < actions.size(); ++i) {
+    replay.ExecutePlayerAction(actions[i]);
+  }
+  const int64_t count = CountGameLeaves(&replay, depth, method);
+  Reset(tree_);
+  return count;
+}
+
+int64_t Perft::CountGameLeaves(game::Game* game_model,
+                               int depth,
+                               Method method) {
+  if (depth == 0) {
+    return 1;
+  }
+  if (game_model->is_game_over()) {
+    return 0;
+  }
+  if (method != GAME_RULES &&
+      game_model->next_action_type() != game::PlayerAction::REMOVE_PIECE) {
+    GameState state;
+    state.Encode(*game_model);
+    return CountStateLeaves(state, depth, method);
+  }
+  std::vector<game::PlayerAction> actions;
+  GetValidActions(*game_model, &actions);
+  int64_t count = 0;
+  for (size_t i = 0; i < actions.size(); ++i) {
+    game_model->ExecutePlayerAction(actions[i]);
+    // The ply is over unless the action closed a mill. A removal that ends the
+    // game leaves the next action type unchanged.
+    const bool ply_over =
+        actions[i].type() == game::PlayerAction::REMOVE_PIECE ||
+        game_model->next_action_type() != game::PlayerAction::REMOVE_PIECE;
+    count += CountGameLeaves(game_model, ply_over ? depth - 1 : depth, method);
+    game_model->UndoLastAction();
+  }
+  return count;
+}
+
+int64_t Perft::CountStateLeaves(const GameState& state,
+                                int depth,
+                                Method method) {
+  if (depth == 0) {
+    return 1;
+  }
+  // The current player lost if it has less than three pieces in total. The
+  // positions in which it is blocked also count no leaves, since they have no
+  // successors.
+  const game::PieceColor player = state.current_player();
+  if (IsLost(state.pieces(player), state.pieces_in_hand(player))) {
+    return 0;
+  }
+  int64_t count = 0;
+  if (method == GENERATE_SUCCESSORS) {
+    SuccessorBuffer* const successors = buffers_[depth];
+    successors->clear();
+    tree_->GenerateSuccessors(state, successors);
+    if (depth == 1) {
+      return successors->size();
+    }
+    for (int i = 0; i < successors->size(); ++i) {
+      count += CountStateLeaves((*successors)[i], depth - 1, method);
+    }
+  } else {
+    std::vector<GameState> successors;
+    tree_->GetSuccessors(state, &successors);
+    if (depth == 1) {
+      return successors.size();
+    }
+    for (size_t i = 0; i < successors.size(); ++i) {
+      count += CountStateLeaves(successors[i], depth - 1, method);
+    }
+  }
+  return count;
+}
+
+}  // namespace ai
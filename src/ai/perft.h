@@ -0,0 +1,81 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_PERFT_H_
+#define AI_PERFT_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "base/basic_macros.h"
+#include "base/ptr/scoped_ptr.h"
+#include "game/game_options.h"
+
+namespace game {
+class Game;
+}
+
+namespace ai {
+
+class GameStateTree;
+class SuccessorBuffer;
+
+// Counts the positions reached from a given position by all the sequences of
+// a fixed number of plies (the perft function of chess engines). A ply is one
+// successor returned by GameStateTree: a move that closes a mill and the
+// removal that follows it are a single ply. The positions in which the game is
+// over are not expanded. The same counts computed with different methods
+// verify the move generators, and the time taken to compute them measures
+// their speed.
+class AI_EXPORT Perft {
+ public:
+  enum Method {
+    // Executes and undoes all the valid actions on a game::Game, which checks
+    // them with game::PlayerAction::CanExecuteOn() and
+    // game::Game::CanExecutePlayerAction(). This is the rules path used by the
+    // user interfaces, so the other methods are checked against it.
+    GAME_RULES,
+    // Uses GameStateTree::GetSuccessors(), which caches the successors of all
+    // the expanded states. The cache is discarded after each count.
+    GET_SUCCESSORS,
+    // Uses GameStateTree::GenerateSuccessors(), which does not allocate
+    // memory.
+    GENERATE_SUCCESSORS
+  };
+
+  explicit Perft(const game::GameOptions& options);
+  ~Perft();
+
+  // Returns the number of positions reached from the current position of
+  // |game_model| after |depth| plies, using |method|. If |game_model| waits
+  // for a piece to be removed, the removals complete the first ply. The game
+  // must have been played with the options of this instance.
+  int64_t CountLeaves(const game::Game& game_model, int depth, Method method);
+
+ private:
+  // Counts the leaves from the position of |game_model|. The GAME_RULES method
+  // executes all the actions on |game_model|, while the other methods only
+  // execute the removals of the first ply, since they cannot be stored by a
+  // GameState.
+  int64_t CountGameLeaves(game::Game* game_model, int depth, Method method);
+
+  // Counts the leaves from |state| using the successors of |tree_|.
+  int64_t CountStateLeaves(const GameState& state, int depth, Method method);
+
+  const game::GameOptions options_;
+  base::ptr::scoped_ptr<GameStateTree> tree_;
+
+  // The successors of the states expanded by GENERATE_SUCCESSORS, one buffer
+  // for each remaining depth.
+  std::vector<SuccessorBuffer*> buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(Perft);
+};
+
+}  // namespace ai
+
+#endif  // AI_PERFT_H_
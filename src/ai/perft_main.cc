@@ -0,0 +1,202 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Counts the positions reached after a fixed number of plies from the start
+// position or from the last position of saved games, with each method of
+// ai::Perft. Reports the speed of each method and fails if the counts differ.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ai/perft.h"
+#include "base/basic_macros.h"
+#include "base/command_line.h"
+#include "base/debug/stacktrace.h"
+#include "base/time_util.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_serializer.h"
+#include "game/game_type.h"
+
+namespace {
+
+using ai::Perft;
+
+const char kGameTypeSwitch[] = "--game-type";
+const char kNoJumpsSwitch[] = "--no-jumps";
+const char kDepthSwitch[] = "--depth";
+const char kMethodSwitch[] = "--method";
+const char kHelpSwitch[] = "--help";
+
+const int kDefaultDepth = 4;
+
+const char kStartCommentChar = '#';
+
+const struct {
+  const char* name;
+  Perft::Method method;
+} kMethods[] = {
+  { "rules", Perft::GAME_RULES },
+  { "tree", Perft::GET_SUCCESSORS },
+  { "generator", Perft::GENERATE_SUCCESSORS }
+};
+
+void Usage() {
+  std::cout << "Usage: perft [options] [saved game files]" << std::endl;
+  std::cout << "Counts the leaves from the last position of each saved game, "
+            << "or from the start position if there is no saved game."
+            << std::endl;
+  std::cout << "Possible command line options:" << std::endl;
+  std::cout << "\t" << kGameTypeSwitch << "=3|6|9" << std::endl;
+  std::cout << "\t\t" << "Specifies the game type of the start position: "
+            << "three/six/nine men morris." << std::endl;
+  std::cout << "\t" << kNoJumpsSwitch << std::endl;
+  std::cout << "\t\t" << "The players with three pieces cannot jump."
+            << std::endl;
+  std::cout << "\t" << kDepthSwitch << "=<plies>" << std::endl;
+  std::cout << "\t\t" << "Default: " << kDefaultDepth << "." << std::endl;
+  std::cout << "\t" << kMethodSwitch << "=rules|tree|generator" << std::endl;
+  std::cout << "\t\t" << "The rules of game::Game, GameStateTree::"
+            << "GetSuccessors() or GameStateTree::GenerateSuccessors(). "
+            << "Default: all of them." << std::endl;
+  std::cout << "\t" << kHelpSwitch << std::endl;
+  std::cout << "\t\t" << "Displays this help message and exits." << std::endl;
+}
+
+// Loads a game saved by game::GameSerializer. The text files can contain
+// comment lines, which start with '#'.
+std::auto_ptr<game::Game> LoadGame(const std::string& path) {
+  std::ifstream in(path.c_str(), std::ios_base::binary);
+  const std::string contents((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+  size_t start = contents.find_first_not_of(" \t\r\n");
+  const bool use_binary = start != std::string::npos &&
+      contents[start] != kStartCommentChar &&
+      !std::isdigit(static_cast<unsigned char>(contents[start]));
+  if (use_binary) {
+    std::istringstream binary_in(contents, std::ios_base::binary);
+    return game::GameSerializer::DeserializeFrom(&binary_in, true);
+  }
+  std::stringstream text_in;
+  std::istringstream lines(contents);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty() || line[0] != kStartCommentChar) {
+      text_in << line << std::endl;
+    }
+  }
+  return game::GameSerializer::DeserializeFrom(&text_in, false);
+}
+
+// Counts the leaves from |game_model| with each method from |methods| and
+// returns false if the counts differ.
+bool RunPerft(const game::Game& game_model,
+              int depth,
+              const std::vector<int>& methods) {
+  Perft perft(game_model.options());
+  int64_t expected = -1;
+  bool result = true;
+  for (size_t i = 0; i < methods.size(); ++i) {
+    const int64_t start_time = base::GetMonotonicTime();
+    const int64_t leaves =
+        perft.CountLeaves(game_model, depth, kMethods[methods[i]].method);
+    const int64_t duration = base::GetMonotonicTime() - start_time;
+    std::cout << "\t" << kMethods[methods[i]].name << ": " << leaves
+              << " leaves in " << duration / 1000000 << " ms";
+    if (duration > 0) {
+      std::cout << ", " << leaves * 1000000000 / duration << " nodes/s";
+    }
+    if (expected >= 0 && leaves != expected) {
+      std::cout << " MISMATCH";
+      result = false;
+    }
+    std::cout << std::endl;
+    if (expected < 0) {
+      expected = leaves;
+    }
+  }
+  return result;
+}
+
+bool RunPerftTool(const base::CommandLine& cmd_line) {
+  game::GameOptions options;
+  if (cmd_line.HasSwitch(kGameTypeSwitch)) {
+    const std::string game_type(cmd_line.GetSwitchValue(kGameTypeSwitch));
+    if (game_type == "3") {
+      options.set_game_type(game::THREE_MEN_MORRIS);
+    } else if (game_type == "6") {
+      options.set_game_type(game::SIX_MEN_MORRIS);
+    } else if (game_type == "9") {
+      options.set_game_type(game::NINE_MEN_MORRIS);
+    } else {
+      Usage();
+      return false;
+    }
+  }
+  options.set_jumps_allowed(!cmd_line.HasSwitch(kNoJumpsSwitch));
+  int depth = kDefaultDepth;
+  if (cmd_line.HasSwitch(kDepthSwitch)) {
+    depth = std::atoi(cmd_line.GetSwitchValue(kDepthSwitch).c_str());
+  }
+  std::vector<int> methods;
+  for (size_t i = 0; i < arraysize(kMethods); ++i) {
+    if (!cmd_line.HasSwitch(kMethodSwitch) ||
+        cmd_line.GetSwitchValue(kMethodSwitch) == kMethods[i].name) {
+      methods.push_back(i);
+    }
+  }
+  if (depth < 0 || methods.empty()) {
+    Usage();
+    return false;
+  }
+
+  const std::vector<std::string> saved_games(cmd_line.GetArguments());
+  if (saved_games.empty()) {
+    game::Game game_model(options);
+    game_model.Initialize();
+    std::cout << "Start position, depth " << depth << std::endl;
+    return RunPerft(game_model, depth, methods);
+  }
+  bool result = true;
+  for (size_t i = 0; i < saved_games.size(); ++i) {
+    const std::auto_ptr<game::Game> saved_game(LoadGame(saved_games[i]));
+    if (!saved_game.get()) {
+      std::cerr << "Could not load " << saved_games[i] << std::endl;
+      result = false;
+      continue;
+    }
+    std::cout << saved_games[i] << ", depth " << depth << std::endl;
+    result = RunPerft(*saved_game, depth, methods) && result;
+  }
+  return result;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  cmd_line->Init(argc, argv);
+  bool result = true;
+  if (cmd_line->HasSwitch(kHelpSwitch)) {
+    Usage();
+  } else {
+    result = RunPerftTool(*cmd_line);
+  }
+  base::CommandLine::DeleteForCurrentProcess();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "ai/perft.h"
+#include "base/basic_macros.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_test_helper.h"
+#include "game/game_type.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace {
+
+const Perft::Method kMethods[] = {
+  Perft::GAME_RULES, Perft::GET_SUCCESSORS, Perft::GENERATE_SUCCESSORS
+};
+
+// Expects all the methods to count |expected| leaves at |depth| from the
+// position of |game_model|. A negative |expected| value is replaced by the
+// count of the GAME_RULES method.
+void ExpectSameLeaves(const game::Game& game_model, int depth,
+                      int64_t expected) {
+  Perft perft(game_model.options());
+  if (expected < 0) {
+    expected = perft.CountLeaves(game_model, depth, Perft::GAME_RULES);
+  }
+  for (size_t i = 0; i < arraysize(kMethods); ++i) {
+    EXPECT_EQ(expected, perft.CountLeaves(game_model, depth, kMethods[i]))
+        << "Method " << kMethods[i] << ", depth " << depth;
+  }
+}
+
+class PerftTest : public ::testing::TestWithParam<game::GameType> {
+};
+
+TEST_P(PerftTest, StartPosition) {
+  game::GameOptions options;
+  options.set_game_type(GetParam());
+  game::Game game_model(options);
+  game_model.Initialize();
+  const int location_count = game_model.board().locations().size();
+  // No mill can be closed during the first four plies, so the pieces can be
+  // placed on any of the empty locations.
+  int64_t expected = 1;
+  for (int depth = 0; depth <= 3; ++depth) {
+    ExpectSameLeaves(game_model, depth, expected);
+    expected *= location_count - depth;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(PerftTestInstance,
+                        PerftTest,
+                        ::testing::Values(game::THREE_MEN_MORRIS,
+                                          game::SIX_MEN_MORRIS,
+                                          game::NINE_MEN_MORRIS));
+
+// The fifth ply is the first one that can close a mill. The count was computed
+// with the GAME_RULES method. The six and nine men morris counts at the same
+// depth (531648 and 5140800) take too long to be computed by the tests.
+TEST(Perft, FirstMills) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  game::Game game_model(options);
+  game_model.Initialize();
+  ExpectSameLeaves(game_model, 5, 16200);
+}
+
+// Compares the methods from all the positions of the saved games, including
+// the ones in which the current player must remove a piece.
+TEST(Perft, SavedGames) {
+  struct SavedGame {
+    const char* name;
+    int depth;
+  };
+  const SavedGame saved_games[] = {
+    { "actions_test_3", 2 },
+    { "full_3", 2 },
+    { "place_phase_3", 2 },
+    { "full_6", 2 },
+    { "remove_from_mill_6", 2 },
+    { "random_9", 1 }
+  };
+  for (size_t i = 0; i < arraysize(saved_games); ++i) {
+    const std::auto_ptr<game::Game> saved_game(
+        game::LoadSavedGameForTests(saved_games[i].name));
+    ASSERT_TRUE(saved_game.get()) << saved_games[i].name;
+    std::vector<game::PlayerAction> actions;
+    saved_game->DumpActionList(&actions);
+    game::Game game_model(saved_game->options());
+    game_model.Initialize();
+    for (size_t k = 0; k <= actions.size(); ++k) {
+      SCOPED_TRACE(::testing::Message() << saved_games[i].name << " after "
+                                        << k << " actions");
+      ExpectSameLeaves(game_model, saved_games[i].depth, -1);
+      if (k < actions.size()) {
+        game_model.ExecutePlayerAction(actions[k]);
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
+}  // namespace ai
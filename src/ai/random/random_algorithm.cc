@@ -4,106 +4,111 @@
 
 #include "ai/random/random_algorithm.h"
 
-#include <cstdlib>
+#include <stdint.h>
+
 #include <ctime>
 #include <memory>
-#include <vector>
 
+#include "ai/bitboard.h"
 #include "base/log.h"
+#include "base/random.h"
 #include "game/board.h"
 #include "game/board_location.h"
 #include "game/game.h"
 #include "game/piece_color.h"
 #include "game/player_action.h"
-#include "base/function.h"
 
 namespace ai {
 namespace random {
 
 namespace {
 
-void GetValidMoveActions(const game::Game& game_model,
-                         std::vector<game::PlayerAction>* actions) {
-  DCHECK_EQ(game_model.next_action_type(), game::PlayerAction::MOVE_PIECE);
+// Stores in |own| and |opponent| the pieces of the current player of
+// |game_model| and the ones of its opponent.
+void GetPieces(const BitboardLayout& layout,
+               const game::Game& game_model,
+               Bitboard* own,
+               Bitboard* opponent) {
   const game::Board& board = game_model.board();
-  std::vector<game::BoardLocation> piece_locations;
-  std::vector<game::BoardLocation> empty_locations;
-  const std::vector<game::BoardLocation>& locations = board.locations();
-  for (size_t i = 0; i < locations.size(); ++i) {
-    const game::PieceColor loc_color = board.GetPieceAt(locations[i]);
-    if (loc_color == game::NO_COLOR) {
-      empty_locations.push_back(locations[i]);
-    } else if (loc_color == game_model.current_player()) {
-      piece_locations.push_back(locations[i]);
-    }
-  }
-  for (size_t i = 0; i < piece_locations.size(); ++i) {
-    for (size_t j = 0; j < empty_locations.size(); ++j) {
-      game::PlayerAction action(game_model.current_player(),
-                                game::PlayerAction::MOVE_PIECE);
-      action.set_source(piece_locations[i]);
-      action.set_destination(empty_locations[j]);
-      if ((!game_model.CanJump()) && action.IsJumpOn(board)) {
-        continue;
-      }
-      actions->push_back(action);
+  const game::PieceColor player = game_model.current_player();
+  *own = 0;
+  *opponent = 0;
+  for (int i = 0; i < layout.location_count; ++i) {
+    const game::PieceColor color = board.GetPieceAt(layout.LocationAt(i));
+    if (color == player) {
+      *own |= BitAt(i);
+    } else if (color != game::NO_COLOR) {
+      *opponent |= BitAt(i);
     }
   }
 }
 
-void GetValidPlaceActions(const game::Game& game_model,
-                          std::vector<game::PlayerAction>* actions) {
-  DCHECK_EQ(game_model.next_action_type(), game::PlayerAction::PLACE_PIECE);
-  const game::Board& board = game_model.board();
-  const std::vector<game::BoardLocation>& locations = board.locations();
-  for (size_t i = 0; i < locations.size(); ++i) {
-    if (board.GetPieceAt(locations[i]) != game::NO_COLOR) {
-      continue;
-    }
-    game::PlayerAction action(game_model.current_player(),
-                              game::PlayerAction::PLACE_PIECE);
-    action.set_destination(locations[i]);
-    actions->push_back(action);
-  }
-}
+// Adapts an external generator to the interface of the generators used by the
+// sampling functions from ai/bitboard.h.
+class ExternalRandom {
+ public:
+  explicit ExternalRandom(RandomAlgorithm::RandomNumberGenerator* generator)
+      : generator_(generator) {}
 
-void GetValidRemoveActions(const game::Game& game_model,
-                           std::vector<game::PlayerAction>* actions) {
-  DCHECK_EQ(game_model.next_action_type(), game::PlayerAction::REMOVE_PIECE);
-  const game::Board& board = game_model.board();
-  std::vector<game::BoardLocation> morris_locations;
-  bool allow_remove_from_mill = true;
-  game::PieceColor opponent = game::GetOpponent(game_model.current_player());
-  const std::vector<game::BoardLocation>& locations = board.locations();
-  for (size_t i = 0; i < locations.size(); ++i) {
-    if (board.GetPieceAt(locations[i]) != opponent) {
-      continue;
-    }
-    if (board.IsPartOfMill(locations[i])) {
-      morris_locations.push_back(locations[i]);
-    } else {
-      allow_remove_from_mill = false;
-      game::PlayerAction action(game_model.current_player(),
-                                game::PlayerAction::REMOVE_PIECE);
-      action.set_source(locations[i]);
-      actions->push_back(action);
-    }
+  uint32_t NextBelow(uint32_t bound) {
+    return static_cast<unsigned>((*generator_)()) % bound;
   }
-  if (allow_remove_from_mill) {
-    for (size_t i = 0; i < morris_locations.size(); ++i) {
-      game::PlayerAction action(game_model.current_player(),
-                                game::PlayerAction::REMOVE_PIECE);
-      action.set_source(morris_locations[i]);
-      actions->push_back(action);
+
+ private:
+  RandomAlgorithm::RandomNumberGenerator* const generator_;
+};
+
+// Chooses one of the actions that can be executed next in |model|, using
+// |random|.
+template <class Random>
+game::PlayerAction ChooseAction(const game::Game& model, Random* random) {
+  const BitboardLayout& layout = GetBitboardLayout(model.options().game_type());
+  Bitboard own = 0;
+  Bitboard opponent = 0;
+  GetPieces(layout, model, &own, &opponent);
+  const Bitboard empty = layout.all & ~(own | opponent);
+  game::PlayerAction action(model.current_player(), model.next_action_type());
+  switch (model.next_action_type()) {
+    case game::PlayerAction::PLACE_PIECE:
+      action.set_destination(
+          layout.LocationAt(GetRandomLocation(empty, random)));
+      break;
+    case game::PlayerAction::REMOVE_PIECE:
+      action.set_source(layout.LocationAt(
+          GetRandomLocation(GetRemovablePieces(layout, opponent), random)));
+      break;
+    case game::PlayerAction::MOVE_PIECE: {
+      int source = -1;
+      int destination = -1;
+      if (model.CanJump()) {
+        // All the pieces can move to all the empty locations.
+        source = GetRandomLocation(own, random);
+        destination = GetRandomLocation(empty, random);
+      } else {
+        const bool has_moves = GetRandomAdjacentMove(layout, own, empty,
+                                                     random, &source,
+                                                     &destination);
+        DCHECK(has_moves);
+      }
+      action.set_source(layout.LocationAt(source));
+      action.set_destination(layout.LocationAt(destination));
+      break;
     }
   }
+  DCHECK(model.CanExecutePlayerAction(action));
+  return action;
 }
 
 }  // anonymous namespace
 
 RandomAlgorithm::RandomAlgorithm()
-    : random_number_generator_(new base::Function<int(void)>(&std::rand)) {
-  std::srand(std::time(NULL));
+    : random_number_generator_(NULL),
+      random_(static_cast<uint64_t>(std::time(NULL)) ^
+              reinterpret_cast<uintptr_t>(this)) {
+}
+
+RandomAlgorithm::RandomAlgorithm(uint64_t seed)
+    : random_number_generator_(NULL), random_(seed) {
 }
 
 RandomAlgorithm::RandomAlgorithm(std::auto_ptr<RandomNumberGenerator> random)
@@ -111,23 +116,11 @@ RandomAlgorithm::RandomAlgorithm(std::auto_ptr<RandomNumberGenerator> random)
 }
 
 game::PlayerAction RandomAlgorithm::GetNextAction(const game::Game& model) {
-  std::vector<game::PlayerAction> valid_actions;
-  switch (model.next_action_type()) {
-    case game::PlayerAction::MOVE_PIECE:
-      GetValidMoveActions(model, &valid_actions);
-      break;
-    case game::PlayerAction::PLACE_PIECE:
-      GetValidPlaceActions(model, &valid_actions);
-      break;
-    case game::PlayerAction::REMOVE_PIECE:
-      GetValidRemoveActions(model, &valid_actions);
-      break;
+  if (Get(random_number_generator_)) {
+    ExternalRandom random(Get(random_number_generator_));
+    return ChooseAction(model, &random);
   }
-  DCHECK_GT(valid_actions.size(), 0);
-  int index = (*random_number_generator_)() % valid_actions.size();
-  const game::PlayerAction& next_action = valid_actions[index];
-  DCHECK(model.CanExecutePlayerAction(next_action));
-  return next_action;
+  return ChooseAction(model, &random_);
 }
 
 }  // namespace random
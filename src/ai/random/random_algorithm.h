@@ -5,12 +5,15 @@
 #ifndef AI_RANDOM_RANDOM_ALGORITHM_H_
 #define AI_RANDOM_RANDOM_ALGORITHM_H_
 
+#include <stdint.h>
+
 #include <memory>
 
 #include "ai/ai_algorithm.h"
 #include "ai/ai_export.h"
 #include "base/callable.h"
 #include "base/ptr/scoped_ptr.h"
+#include "base/random.h"
 #include "game/player_action.h"
 
 namespace game {
@@ -21,18 +24,26 @@ namespace ai {
 namespace random {
 
 // This class is the most simple AI player. In each situation it randomly
-// chooses one of the valid actions that can be made.
-// The randomness is given by an external random number generator that is
-// provided when a new |RandomAlgorithm| is instantiated. The generator is an
-// object that can be called without any arguments and returns a random int.
+// chooses one of the valid actions that can be made, with equal probabilities.
+// The actions are sampled directly from the bitboards of the pieces, without
+// building the list of valid actions, so it is fast enough to be used as the
+// policy of simulated games.
+// The randomness is given by a fast generator owned by each instance, or by an
+// external random number generator that is provided when a new
+// |RandomAlgorithm| is instantiated. The external generator is an object that
+// can be called without any arguments and returns a random int.
 class AI_EXPORT RandomAlgorithm : public AIAlgorithm {
  public:
   typedef base::Callable<int(void)> RandomNumberGenerator;
 
-  // The no-argument constructor uses std::rand() to generate random numbers. It
-  // also calls std::srand(std::time(NULL)).
+  // The no-argument constructor seeds the generator of this instance with the
+  // current time and the address of the instance.
   RandomAlgorithm();
 
+  // The actions chosen by the instances that use the same |seed| are the same,
+  // so the simulated games are reproducible.
+  explicit RandomAlgorithm(uint64_t seed);
+
   // This constructor allows the users of this class to provide their own random
   // number generator.
   explicit RandomAlgorithm(std::auto_ptr<RandomNumberGenerator> random);
@@ -41,7 +52,9 @@ class AI_EXPORT RandomAlgorithm : public AIAlgorithm {
   // AIAlgorithm interface
   virtual game::PlayerAction GetNextAction(const game::Game& game_model);
 
+  // NULL if the generator of this instance is used.
   base::ptr::scoped_ptr<RandomNumberGenerator> random_number_generator_;
+  base::XorShift64Star random_;
 };
 
 }  // namespace random
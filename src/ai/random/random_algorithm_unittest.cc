@@ -4,7 +4,10 @@
 
 #include <cstdlib>
 #include <ctime>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "ai/ai_algorithm.h"
 #include "ai/random/random_algorithm.h"
@@ -13,6 +16,8 @@
 #include "base/log.h"
 #include "base/ptr/scoped_ptr.h"
 #include "base/random.h"
+#include "game/board.h"
+#include "game/board_location.h"
 #include "game/game.h"
 #include "game/game_options.h"
 #include "game/game_type.h"
@@ -40,7 +45,9 @@ RandomAlgorithm* GetRandomTestPlayer(MersenneTwister32* generator) {
 }
 
 void RunTestGame(game::GameType game_type, bool allow_jumps) {
-  const int max_moves = 250;
+  // About a quarter of the nine men morris games played by random players are
+  // longer than 250 actions.
+  const int max_moves = 1000;
   MersenneTwister32 white_random(12345);
   MersenneTwister32 black_random(54321);
   scoped_ptr<AIAlgorithm> white(GetRandomTestPlayer(&white_random));
@@ -81,6 +88,94 @@ INSTANTIATE_TEST_CASE_P(RandomAlgorithmTest,
                                           game::SIX_MEN_MORRIS,
                                           game::NINE_MEN_MORRIS));
 
+TEST(RandomAlgorithm, SameSeed) {
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  RandomAlgorithm first(12345);
+  RandomAlgorithm second(12345);
+  game::Game test_game(options);
+  test_game.Initialize();
+  for (int i = 0; i < 1000 && !test_game.is_game_over(); ++i) {
+    const game::PlayerAction action =
+        static_cast<AIAlgorithm*>(&first)->GetNextAction(test_game);
+    const game::PlayerAction expected_action =
+        static_cast<AIAlgorithm*>(&second)->GetNextAction(test_game);
+    EXPECT_EQ(expected_action.source(), action.source());
+    EXPECT_EQ(expected_action.destination(), action.destination());
+    test_game.ExecutePlayerAction(action);
+  }
+  EXPECT_TRUE(test_game.is_game_over());
+}
+
+TEST(RandomAlgorithm, UniformPlaceActions) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  game::Game test_game(options);
+  test_game.Initialize();
+  // All the 16 locations are empty, so they must be chosen equally often.
+  RandomAlgorithm algorithm(54321);
+  std::map<game::BoardLocation, int> counts;
+  for (int i = 0; i < 16000; ++i) {
+    ++counts[static_cast<AIAlgorithm*>(&algorithm)->GetNextAction(
+        test_game).destination()];
+  }
+  EXPECT_EQ(16U, counts.size());
+  for (std::map<game::BoardLocation, int>::const_iterator it = counts.begin();
+       it != counts.end(); ++it) {
+    EXPECT_GT(it->second, 800);
+    EXPECT_LT(it->second, 1200);
+  }
+}
+
+TEST(RandomAlgorithm, UniformMoveActions) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  game::Game test_game(options);
+  test_game.Initialize();
+  RandomAlgorithm algorithm(7);
+  AIAlgorithm* const player = &algorithm;
+  while (test_game.next_action_type() != game::PlayerAction::MOVE_PIECE) {
+    test_game.ExecutePlayerAction(player->GetNextAction(test_game));
+  }
+  ASSERT_FALSE(test_game.is_game_over());
+  ASSERT_FALSE(test_game.CanJump());
+  // The valid moves are found by trying all the pairs of locations.
+  typedef std::pair<game::BoardLocation, game::BoardLocation> Move;
+  std::map<Move, int> counts;
+  const game::Board& board = test_game.board();
+  const std::vector<game::BoardLocation>& locations = board.locations();
+  for (size_t i = 0; i < locations.size(); ++i) {
+    if (board.GetPieceAt(locations[i]) != test_game.current_player()) {
+      continue;
+    }
+    for (size_t j = 0; j < locations.size(); ++j) {
+      if (board.GetPieceAt(locations[j]) != game::NO_COLOR) {
+        continue;
+      }
+      game::PlayerAction action(test_game.current_player(),
+                                game::PlayerAction::MOVE_PIECE);
+      action.set_source(locations[i]);
+      action.set_destination(locations[j]);
+      if (!action.IsJumpOn(board)) {
+        counts[Move(locations[i], locations[j])] = 0;
+      }
+    }
+  }
+  ASSERT_GT(counts.size(), 1U);
+  const int samples_per_move = 1000;
+  for (size_t i = 0; i < samples_per_move * counts.size(); ++i) {
+    const game::PlayerAction action = player->GetNextAction(test_game);
+    const Move move(action.source(), action.destination());
+    ASSERT_TRUE(counts.count(move));
+    ++counts[move];
+  }
+  for (std::map<Move, int>::const_iterator it = counts.begin();
+       it != counts.end(); ++it) {
+    EXPECT_GT(it->second, samples_per_move * 8 / 10);
+    EXPECT_LT(it->second, samples_per_move * 12 / 10);
+  }
+}
+
 }  // anonymous namespace
 }  // namespace random
 }  // namespace ai
@@ -0,0 +1,214 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/selfplay/game_log.h"
+
+#include <stdint.h>
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "base/log.h"
+#include "game/board_location.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+const uint32_t kGameLogMagic = 0x474c5053;  // "SPLG"
+const uint32_t kGameLogVersion = 1;
+
+// The bits of the flags byte from the header of the log.
+const uint8_t kJumpsAllowedFlag = 1;
+const uint8_t kWhiteStartsFlag = 2;
+
+// The bits of the flags byte of each game.
+const uint8_t kFirstPlayerIsWhiteFlag = 1;
+
+template <typename T>
+void WriteValue(T value, std::ostream* out) {
+  out->write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool ReadValue(std::istream* in, T* value) {
+  in->read(reinterpret_cast<char*>(value), sizeof(*value));
+  return static_cast<size_t>(in->gcount()) == sizeof(*value);
+}
+
+void WriteLocation(const BitboardLayout& layout,
+                   const game::BoardLocation& location,
+                   std::ostream* out) {
+  const int index = layout.IndexOf(location);
+  DCHECK(index >= 0);
+  WriteValue(static_cast<uint8_t>(index), out);
+}
+
+bool ReadLocation(std::istream* in,
+                  const BitboardLayout& layout,
+                  game::BoardLocation* location) {
+  uint8_t index = 0;
+  if (!ReadValue(in, &index) || index >= layout.location_count) {
+    return false;
+  }
+  *location = layout.LocationAt(index);
+  return true;
+}
+
+// Reads the actions of one game and replays them. The type of each action is
+// the next action type of the replayed game.
+bool ReadActions(std::istream* in,
+                 const game::GameOptions& options,
+                 int action_count,
+                 GameRecord* record) {
+  const BitboardLayout& layout = GetBitboardLayout(options.game_type());
+  game::Game replay(options);
+  replay.Initialize();
+  for (int i = 0; i < action_count; ++i) {
+    if (replay.is_game_over()) {
+      return false;
+    }
+    game::PlayerAction action(replay.current_player(),
+                              replay.next_action_type());
+    game::BoardLocation location(-1, -1);
+    switch (replay.next_action_type()) {
+      case game::PlayerAction::MOVE_PIECE:
+        if (!ReadLocation(in, layout, &location)) {
+          return false;
+        }
+        action.set_source(location);
+        if (!ReadLocation(in, layout, &location)) {
+          return false;
+        }
+        action.set_destination(location);
+        break;
+      case game::PlayerAction::PLACE_PIECE:
+        if (!ReadLocation(in, layout, &location)) {
+          return false;
+        }
+        action.set_destination(location);
+        break;
+      case game::PlayerAction::REMOVE_PIECE:
+        if (!ReadLocation(in, layout, &location)) {
+          return false;
+        }
+        action.set_source(location);
+        break;
+    }
+    if (!replay.CanExecutePlayerAction(action)) {
+      return false;
+    }
+    replay.ExecutePlayerAction(action);
+    record->actions.push_back(action);
+  }
+  // A game that is over must have the winner of the replay.
+  if (record->winner != game::NO_COLOR &&
+      (!replay.is_game_over() || replay.winner() != record->winner)) {
+    return false;
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+bool WriteGameLog(const game::GameOptions& options,
+                  const std::vector<GameRecord>& games,
+                  std::ostream* out) {
+  for (size_t i = 0; i < games.size(); ++i) {
+    if (games[i].actions.size() > kMaxLoggedActions) {
+      LOG(ERROR) << "Game " << i << " has too many actions to be logged";
+      return false;
+    }
+  }
+  const BitboardLayout& layout = GetBitboardLayout(options.game_type());
+  WriteValue(kGameLogMagic, out);
+  WriteValue(kGameLogVersion, out);
+  WriteValue(static_cast<uint8_t>(options.game_type()), out);
+  uint8_t flags = 0;
+  if (options.jumps_allowed()) {
+    flags |= kJumpsAllowedFlag;
+  }
+  if (options.white_starts()) {
+    flags |= kWhiteStartsFlag;
+  }
+  WriteValue(flags, out);
+  WriteValue(static_cast<uint32_t>(games.size()), out);
+  for (size_t i = 0; i < games.size(); ++i) {
+    const GameRecord& record = games[i];
+    WriteValue(static_cast<uint8_t>(
+        record.first_player_color == game::WHITE_COLOR ?
+            kFirstPlayerIsWhiteFlag : 0), out);
+    WriteValue(static_cast<uint8_t>(record.winner), out);
+    WriteValue(static_cast<uint16_t>(record.actions.size()), out);
+    for (size_t k = 0; k < record.actions.size(); ++k) {
+      const game::PlayerAction& action = record.actions[k];
+      switch (action.type()) {
+        case game::PlayerAction::MOVE_PIECE:
+          WriteLocation(layout, action.source(), out);
+          WriteLocation(layout, action.destination(), out);
+          break;
+        case game::PlayerAction::PLACE_PIECE:
+          WriteLocation(layout, action.destination(), out);
+          break;
+        case game::PlayerAction::REMOVE_PIECE:
+          WriteLocation(layout, action.source(), out);
+          break;
+      }
+    }
+  }
+  return out->good();
+}
+
+bool ReadGameLog(std::istream* in,
+                 game::GameOptions* options,
+                 std::vector<GameRecord>* games) {
+  DCHECK(options);
+  DCHECK(games);
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint8_t game_type = 0;
+  uint8_t flags = 0;
+  uint32_t game_count = 0;
+  if (!ReadValue(in, &magic) || magic != kGameLogMagic ||
+      !ReadValue(in, &version) || version != kGameLogVersion ||
+      !ReadValue(in, &game_type) || game_type > game::NINE_MEN_MORRIS ||
+      !ReadValue(in, &flags) || !ReadValue(in, &game_count)) {
+    ELOG(ERROR) << "Invalid game log header";
+    return false;
+  }
+  options->set_game_type(static_cast<game::GameType>(game_type));
+  options->set_jumps_allowed(flags & kJumpsAllowedFlag);
+  options->set_white_starts(flags & kWhiteStartsFlag);
+  games->clear();
+  for (uint32_t i = 0; i < game_count; ++i) {
+    uint8_t game_flags = 0;
+    uint8_t winner = 0;
+    uint16_t action_count = 0;
+    if (!ReadValue(in, &game_flags) || !ReadValue(in, &winner) ||
+        winner > game::BLACK_COLOR || !ReadValue(in, &action_count)) {
+      ELOG(ERROR) << "Invalid header for game number " << (i + 1);
+      return false;
+    }
+    games->push_back(GameRecord());
+    GameRecord& record = games->back();
+    record.first_player_color = (game_flags & kFirstPlayerIsWhiteFlag) ?
+        game::WHITE_COLOR : game::BLACK_COLOR;
+    record.winner = static_cast<game::PieceColor>(winner);
+    if (!ReadActions(in, *options, action_count, &record)) {
+      ELOG(ERROR) << "Invalid actions for game number " << (i + 1);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace selfplay
+}  // namespace ai
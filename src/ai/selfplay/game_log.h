@@ -0,0 +1,64 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_SELFPLAY_GAME_LOG_H_
+#define AI_SELFPLAY_GAME_LOG_H_
+
+#include <stddef.h>
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "game/game_options.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace selfplay {
+
+// A game played by the SelfPlayRunner.
+struct GameRecord {
+  GameRecord()
+      : first_player_color(game::WHITE_COLOR),
+        winner(game::NO_COLOR),
+        actions() {}
+
+  // The color played by the first of the two players of the runner.
+  game::PieceColor first_player_color;
+
+  // The winner of the game, or game::NO_COLOR if the game was stopped before
+  // it was over, which counts as a draw.
+  game::PieceColor winner;
+
+  // All the actions of the game, starting from the initial position.
+  std::vector<game::PlayerAction> actions;
+};
+
+// The number of actions of each game is stored on 16 bits, so the games that
+// have more actions than this cannot be logged.
+const size_t kMaxLoggedActions = 0xffff;
+
+// Writes |games|, played with |options|, to |out|, which must be a binary
+// stream. The type of each action and the player who performs it follow from
+// the rules of the game, so the log stores only the bit index of each
+// location used by an action (see BitboardLayout): one byte for placements
+// and removals, two bytes for moves. Returns false, without writing anything,
+// if one of the games has more than kMaxLoggedActions actions, or if writing
+// to |out| failed.
+AI_EXPORT bool WriteGameLog(const game::GameOptions& options,
+                            const std::vector<GameRecord>& games,
+                            std::ostream* out);
+
+// Reads a log written by WriteGameLog() from the binary stream |in|, replaying
+// each game to restore its actions. Returns false if the log is not valid.
+AI_EXPORT bool ReadGameLog(std::istream* in,
+                           game::GameOptions* options,
+                           std::vector<GameRecord>* games);
+
+}  // namespace selfplay
+}  // namespace ai
+
+#endif  // AI_SELFPLAY_GAME_LOG_H_
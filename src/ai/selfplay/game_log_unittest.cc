@@ -0,0 +1,134 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ai/selfplay/game_log.h"
+#include "ai/selfplay/selfplay_runner.h"
+#include "ai/selfplay/selfplay_test_helper.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+// The size of the header of the log and of the header of each game.
+const size_t kLogHeaderSize = 14;
+const size_t kGameHeaderSize = 4;
+
+// Plays |game_count| games between random players.
+std::vector<GameRecord> PlayRandomGames(const game::GameOptions& options,
+                                        int game_count) {
+  SelfPlayRunner runner(options, CreateRandomPlayersForTests());
+  runner.set_max_actions(100);
+  runner.Run(game_count);
+  return runner.games();
+}
+
+class GameLogTest : public ::testing::TestWithParam<game::GameType> {
+};
+
+TEST_P(GameLogTest, WriteAndRead) {
+  game::GameOptions options;
+  options.set_game_type(GetParam());
+  options.set_jumps_allowed(false);
+  const std::vector<GameRecord> games(PlayRandomGames(options, 6));
+  std::ostringstream out(std::ios_base::binary);
+  ASSERT_TRUE(WriteGameLog(options, games, &out));
+
+  // One byte for each location used by the actions.
+  size_t expected_size = kLogHeaderSize + games.size() * kGameHeaderSize;
+  for (size_t i = 0; i < games.size(); ++i) {
+    for (size_t k = 0; k < games[i].actions.size(); ++k) {
+      expected_size += games[i].actions[k].type() ==
+          game::PlayerAction::MOVE_PIECE ? 2 : 1;
+    }
+  }
+  EXPECT_EQ(expected_size, out.str().size());
+
+  std::istringstream in(out.str(), std::ios_base::binary);
+  game::GameOptions read_options;
+  std::vector<GameRecord> read_games;
+  ASSERT_TRUE(ReadGameLog(&in, &read_options, &read_games));
+  EXPECT_EQ(options, read_options);
+  ASSERT_EQ(games.size(), read_games.size());
+  for (size_t i = 0; i < games.size(); ++i) {
+    EXPECT_EQ(games[i].first_player_color, read_games[i].first_player_color);
+    EXPECT_EQ(games[i].winner, read_games[i].winner);
+    ASSERT_EQ(games[i].actions.size(), read_games[i].actions.size());
+    for (size_t k = 0; k < games[i].actions.size(); ++k) {
+      const game::PlayerAction& action = games[i].actions[k];
+      const game::PlayerAction& read_action = read_games[i].actions[k];
+      EXPECT_EQ(action.type(), read_action.type());
+      EXPECT_EQ(action.player_color(), read_action.player_color());
+      if (action.type() != game::PlayerAction::PLACE_PIECE) {
+        EXPECT_EQ(action.source(), read_action.source());
+      }
+      if (action.type() != game::PlayerAction::REMOVE_PIECE) {
+        EXPECT_EQ(action.destination(), read_action.destination());
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(GameLogTestInstance,
+                        GameLogTest,
+                        ::testing::Values(game::THREE_MEN_MORRIS,
+                                          game::SIX_MEN_MORRIS,
+                                          game::NINE_MEN_MORRIS));
+
+TEST(GameLog, InvalidLogs) {
+  game::GameOptions options;
+  const std::vector<GameRecord> games(PlayRandomGames(options, 2));
+  std::ostringstream out(std::ios_base::binary);
+  ASSERT_TRUE(WriteGameLog(options, games, &out));
+  const std::string log(out.str());
+  game::GameOptions read_options;
+  std::vector<GameRecord> read_games;
+
+  std::string invalid_magic(log);
+  invalid_magic[0] ^= 1;
+  std::istringstream invalid_magic_in(invalid_magic, std::ios_base::binary);
+  EXPECT_FALSE(ReadGameLog(&invalid_magic_in, &read_options, &read_games));
+
+  std::istringstream truncated_in(log.substr(0, log.size() - 1),
+                                  std::ios_base::binary);
+  EXPECT_FALSE(ReadGameLog(&truncated_in, &read_options, &read_games));
+
+  // The second placement of the first game is on the same location as the
+  // first one.
+  std::string invalid_action(log);
+  invalid_action[kLogHeaderSize + kGameHeaderSize + 1] =
+      invalid_action[kLogHeaderSize + kGameHeaderSize];
+  std::istringstream invalid_action_in(invalid_action, std::ios_base::binary);
+  EXPECT_FALSE(ReadGameLog(&invalid_action_in, &read_options, &read_games));
+
+  std::istringstream valid_in(log, std::ios_base::binary);
+  EXPECT_TRUE(ReadGameLog(&valid_in, &read_options, &read_games));
+  EXPECT_EQ(games.size(), read_games.size());
+}
+
+TEST(GameLog, WriteFailures) {
+  game::GameOptions options;
+  std::vector<GameRecord> games(PlayRandomGames(options, 2));
+  std::ostringstream failed_out(std::ios_base::binary);
+  failed_out.setstate(std::ios_base::badbit);
+  EXPECT_FALSE(WriteGameLog(options, games, &failed_out));
+
+  // The action count of each game is stored on 16 bits.
+  games[1].actions.resize(kMaxLoggedActions + 1, games[1].actions[0]);
+  std::ostringstream out(std::ios_base::binary);
+  EXPECT_FALSE(WriteGameLog(options, games, &out));
+  EXPECT_TRUE(out.str().empty());
+}
+
+}  // anonymous namespace
+}  // namespace selfplay
+}  // namespace ai
@@ -0,0 +1,70 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/selfplay/latency_histogram.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/log.h"
+
+namespace ai {
+namespace selfplay {
+
+const int LatencyHistogram::kBucketCount;
+
+LatencyHistogram::LatencyHistogram() : count_(0), total_(0), max_(0) {
+  std::fill(buckets_, buckets_ + kBucketCount, 0);
+}
+
+void LatencyHistogram::Add(int64_t nanoseconds) {
+  DCHECK(nanoseconds >= 0);
+  const int64_t microseconds = nanoseconds / 1000;
+  int index = 0;
+  while (index < kBucketCount - 1 &&
+         microseconds >= (static_cast<int64_t>(1) << index)) {
+    ++index;
+  }
+  ++buckets_[index];
+  ++count_;
+  total_ += nanoseconds;
+  max_ = std::max(max_, nanoseconds);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketCount; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  total_ += other.total_;
+  max_ = std::max(max_, other.max_);
+}
+
+int64_t LatencyHistogram::GetBucketLimit(int index) {
+  DCHECK(index >= 0);
+  DCHECK_LT(index, kBucketCount);
+  return (static_cast<int64_t>(1) << index) * 1000;
+}
+
+int64_t LatencyHistogram::GetPercentile(double percentile) const {
+  DCHECK(percentile >= 0 && percentile <= 100);
+  if (!count_) {
+    return 0;
+  }
+  const int64_t rank = std::max(static_cast<int64_t>(1),
+      static_cast<int64_t>(std::ceil(count_ * percentile / 100)));
+  int64_t seen = 0;
+  for (int i = 0; i < kBucketCount - 1; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min(GetBucketLimit(i), max_);
+    }
+  }
+  return max_;
+}
+
+}  // namespace selfplay
+}  // namespace ai
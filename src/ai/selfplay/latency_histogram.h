@@ -0,0 +1,59 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_SELFPLAY_LATENCY_HISTOGRAM_H_
+#define AI_SELFPLAY_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include "ai/ai_export.h"
+
+namespace ai {
+namespace selfplay {
+
+// Counts durations in buckets whose bounds grow exponentially, so the same
+// histogram covers searches that take microseconds and searches that take
+// minutes. The first bucket holds the durations below one microsecond and
+// bucket k holds the durations in [2^(k-1), 2^k) microseconds. The last bucket
+// also holds all the longer durations.
+class AI_EXPORT LatencyHistogram {
+ public:
+  static const int kBucketCount = 32;
+
+  LatencyHistogram();
+
+  // Adds a duration given in nanoseconds.
+  void Add(int64_t nanoseconds);
+
+  // Adds all the durations counted by |other|.
+  void Merge(const LatencyHistogram& other);
+
+  // The number of durations, their sum and the longest one, in nanoseconds.
+  int64_t count() const { return count_; }
+  int64_t total() const { return total_; }
+  int64_t max() const { return max_; }
+
+  // The number of durations counted by the bucket given by |index|.
+  int64_t bucket(int index) const { return buckets_[index]; }
+
+  // Returns the upper bound of the bucket given by |index|, in nanoseconds.
+  static int64_t GetBucketLimit(int index);
+
+  // Returns an upper bound of the duration that is longer than |percentile|
+  // percent of the durations: the upper bound of the bucket that contains it,
+  // or the longest duration if it is smaller. Returns 0 if the histogram is
+  // empty.
+  int64_t GetPercentile(double percentile) const;
+
+ private:
+  int64_t buckets_[kBucketCount];
+  int64_t count_;
+  int64_t total_;
+  int64_t max_;
+};
+
+}  // namespace selfplay
+}  // namespace ai
+
+#endif  // AI_SELFPLAY_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,69 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include "ai/selfplay/latency_histogram.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+const int64_t kMicrosecond = 1000;
+const int64_t kSecond = 1000000000;
+
+TEST(LatencyHistogram, Buckets) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+  histogram.Add(0);
+  histogram.Add(kMicrosecond - 1);
+  histogram.Add(kMicrosecond);
+  histogram.Add(2 * kMicrosecond - 1);
+  histogram.Add(2 * kMicrosecond);
+  histogram.Add(3600 * kSecond);
+  EXPECT_EQ(2, histogram.bucket(0));
+  EXPECT_EQ(2, histogram.bucket(1));
+  EXPECT_EQ(1, histogram.bucket(2));
+  EXPECT_EQ(1, histogram.bucket(LatencyHistogram::kBucketCount - 1));
+  EXPECT_EQ(6, histogram.count());
+  EXPECT_EQ(3600 * kSecond, histogram.max());
+  EXPECT_EQ(3600 * kSecond + 6 * kMicrosecond - 2, histogram.total());
+  EXPECT_EQ(kMicrosecond, LatencyHistogram::GetBucketLimit(0));
+  EXPECT_EQ(4 * kMicrosecond, LatencyHistogram::GetBucketLimit(2));
+}
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 90; ++i) {
+    histogram.Add(10 * kMicrosecond);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.Add(100 * kMicrosecond);
+  }
+  // The durations are in [8, 16) and [64, 128) microseconds.
+  EXPECT_EQ(16 * kMicrosecond, histogram.GetPercentile(0));
+  EXPECT_EQ(16 * kMicrosecond, histogram.GetPercentile(50));
+  EXPECT_EQ(16 * kMicrosecond, histogram.GetPercentile(90));
+  EXPECT_EQ(100 * kMicrosecond, histogram.GetPercentile(91));
+  EXPECT_EQ(100 * kMicrosecond, histogram.GetPercentile(100));
+}
+
+TEST(LatencyHistogram, Merge) {
+  LatencyHistogram first;
+  LatencyHistogram second;
+  first.Add(kMicrosecond);
+  second.Add(kMicrosecond);
+  second.Add(kSecond);
+  first.Merge(second);
+  EXPECT_EQ(3, first.count());
+  EXPECT_EQ(2, first.bucket(1));
+  EXPECT_EQ(kSecond, first.max());
+  EXPECT_EQ(kSecond + 2 * kMicrosecond, first.total());
+}
+
+}  // anonymous namespace
+}  // namespace selfplay
+}  // namespace ai
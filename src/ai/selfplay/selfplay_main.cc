@@ -0,0 +1,295 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Plays games between two engines on a pool of threads and reports the
+// results, the number of actions of the games and the time taken by the
+// engines to choose their moves. The games can be saved in a binary log that
+// can be loaded by ai::selfplay::ReadGameLog().
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/mcts/mcts_algorithm.h"
+#include "ai/random/random_algorithm.h"
+#include "ai/selfplay/game_log.h"
+#include "ai/selfplay/latency_histogram.h"
+#include "ai/selfplay/selfplay_runner.h"
+#include "base/basic_macros.h"
+#include "base/command_line.h"
+#include "base/debug/stacktrace.h"
+#include "base/time_util.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+
+namespace {
+
+using ai::selfplay::LatencyHistogram;
+using ai::selfplay::SelfPlayRunner;
+
+const char kGameTypeSwitch[] = "--game-type";
+const char kNoJumpsSwitch[] = "--no-jumps";
+const char kFirstPlayerSwitch[] = "--first-player";
+const char kSecondPlayerSwitch[] = "--second-player";
+const char kGamesSwitch[] = "--games";
+const char kThreadsSwitch[] = "--threads";
+const char kMaxActionsSwitch[] = "--max-actions";
+const char kNoColorAlternationSwitch[] = "--no-color-alternation";
+const char kSeedSwitch[] = "--seed";
+const char kOutputSwitch[] = "--output";
+const char kHelpSwitch[] = "--help";
+
+const char kDefaultFirstPlayer[] = "alphabeta";
+const char kDefaultSecondPlayer[] = "random";
+const int kDefaultGames = 100;
+const int kDefaultMaxActions = 250;
+const int kDefaultSearchDepth = 4;
+const int kDefaultPlayoutCount = 1000;
+
+void Usage() {
+  std::cout << "Usage: selfplay [options]" << std::endl;
+  std::cout << "Possible command line options:" << std::endl;
+  std::cout << "\t" << kGameTypeSwitch << "=3|6|9" << std::endl;
+  std::cout << "\t\t" << "Specifies the game type: three/six/nine men morris."
+            << std::endl;
+  std::cout << "\t" << kNoJumpsSwitch << std::endl;
+  std::cout << "\t\t" << "The players with three pieces cannot jump."
+            << std::endl;
+  std::cout << "\t" << kFirstPlayerSwitch << "=<engine>" << std::endl;
+  std::cout << "\t" << kSecondPlayerSwitch << "=<engine>" << std::endl;
+  std::cout << "\t\t" << "The engines of the two players, as random, "
+            << "alphabeta[:<depth>] or mcts[:<playouts>]. Default: "
+            << kDefaultFirstPlayer << " and " << kDefaultSecondPlayer << "."
+            << std::endl;
+  std::cout << "\t\t" << "The default search depth is "
+            << kDefaultSearchDepth << " and the default playout count is "
+            << kDefaultPlayoutCount << "." << std::endl;
+  std::cout << "\t" << kGamesSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The number of games. Default: " << kDefaultGames
+            << "." << std::endl;
+  std::cout << "\t" << kThreadsSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The number of games played in parallel. Default: "
+            << "the number of processors." << std::endl;
+  std::cout << "\t" << kMaxActionsSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The games that are longer than this are draws. "
+            << "Default: " << kDefaultMaxActions << "." << std::endl;
+  std::cout << "\t" << kNoColorAlternationSwitch << std::endl;
+  std::cout << "\t\t" << "The first player always plays with white. By "
+            << "default, it plays with black in every other game."
+            << std::endl;
+  std::cout << "\t" << kSeedSwitch << "=<seed>" << std::endl;
+  std::cout << "\t\t" << "The seed of the engines. The games are the same for "
+            << "a given seed. Default: 0." << std::endl;
+  std::cout << "\t" << kOutputSwitch << "=<path>" << std::endl;
+  std::cout << "\t\t" << "The file where the games are written." << std::endl;
+  std::cout << "\t" << kHelpSwitch << std::endl;
+  std::cout << "\t\t" << "Displays this help message and exits." << std::endl;
+}
+
+int GetIntSwitch(const base::CommandLine& cmd_line,
+                 const std::string& switch_name,
+                 int default_value) {
+  if (!cmd_line.HasSwitch(switch_name)) {
+    return default_value;
+  }
+  return std::atoi(cmd_line.GetSwitchValue(switch_name).c_str());
+}
+
+// An engine given on the command line as <name>[:<strength>]. The strength is
+// the search depth of alphabeta and the playout count of mcts.
+struct Engine {
+  std::string name;
+  int strength;
+};
+
+bool ParseEngine(const std::string& description, Engine* engine) {
+  const size_t separator = description.find(':');
+  engine->name = description.substr(0, separator);
+  if (engine->name == "random") {
+    engine->strength = 0;
+    return separator == std::string::npos;
+  }
+  if (engine->name == "alphabeta") {
+    engine->strength = kDefaultSearchDepth;
+  } else if (engine->name == "mcts") {
+    engine->strength = kDefaultPlayoutCount;
+  } else {
+    return false;
+  }
+  if (separator != std::string::npos) {
+    engine->strength =
+        std::atoi(description.substr(separator + 1).c_str());
+  }
+  return engine->strength > 0;
+}
+
+class EngineFactory : public SelfPlayRunner::Delegate {
+ public:
+  EngineFactory(const game::GameOptions& options,
+                const Engine& first,
+                const Engine& second,
+                uint32_t seed)
+      : options_(options), seed_(seed) {
+    engines_[0] = first;
+    engines_[1] = second;
+  }
+
+  virtual std::auto_ptr<ai::AIAlgorithm> CreatePlayer(int player,
+                                                      int game_index) {
+    const Engine& engine = engines_[player];
+    const uint32_t seed = seed_ + 2 * game_index + player;
+    if (engine.name == "alphabeta") {
+      // Shuffling the moves with equal scores makes the games different.
+      std::auto_ptr<ai::alphabeta::MorrisAlphaBeta> algorithm(
+          new ai::alphabeta::MorrisAlphaBeta(options_));
+      algorithm->set_max_search_depth(engine.strength);
+      // The search depth is the only limit.
+      algorithm->set_max_search_time(0x7fffffffffffffffLL);
+      algorithm->set_shuffling_enabled(true);
+      algorithm->set_seed(seed);
+      return std::auto_ptr<ai::AIAlgorithm>(algorithm.release());
+    }
+    if (engine.name == "mcts") {
+      std::auto_ptr<ai::mcts::MctsAlgorithm> algorithm(
+          new ai::mcts::MctsAlgorithm(options_));
+      algorithm->set_max_playout_count(engine.strength);
+      // The number of playouts is the only limit.
+      algorithm->set_max_search_time(0x7fffffffffffffffLL);
+      algorithm->set_seed(seed);
+      return std::auto_ptr<ai::AIAlgorithm>(algorithm.release());
+    }
+    return std::auto_ptr<ai::AIAlgorithm>(
+        new ai::random::RandomAlgorithm(seed));
+  }
+
+ private:
+  const game::GameOptions options_;
+  Engine engines_[2];
+  const uint32_t seed_;
+
+  DISALLOW_COPY_AND_ASSIGN(EngineFactory);
+};
+
+void PrintLatency(const std::string& engine,
+                  const LatencyHistogram& histogram) {
+  std::cout << "Latency of " << engine << ": " << histogram.count()
+            << " moves";
+  if (!histogram.count()) {
+    std::cout << std::endl;
+    return;
+  }
+  std::cout << ", mean " << histogram.total() / histogram.count() / 1000
+            << " us, p50 " << histogram.GetPercentile(50) / 1000
+            << " us, p90 " << histogram.GetPercentile(90) / 1000
+            << " us, p99 " << histogram.GetPercentile(99) / 1000
+            << " us, max " << histogram.max() / 1000 << " us" << std::endl;
+  for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+    if (histogram.bucket(i)) {
+      std::cout << "\t< " << LatencyHistogram::GetBucketLimit(i) / 1000
+                << " us\t" << histogram.bucket(i) << std::endl;
+    }
+  }
+}
+
+bool RunSelfPlay(const base::CommandLine& cmd_line) {
+  game::GameOptions options;
+  if (cmd_line.HasSwitch(kGameTypeSwitch)) {
+    const std::string game_type(cmd_line.GetSwitchValue(kGameTypeSwitch));
+    if (game_type == "3") {
+      options.set_game_type(game::THREE_MEN_MORRIS);
+    } else if (game_type == "6") {
+      options.set_game_type(game::SIX_MEN_MORRIS);
+    } else if (game_type == "9") {
+      options.set_game_type(game::NINE_MEN_MORRIS);
+    } else {
+      Usage();
+      return false;
+    }
+  }
+  options.set_jumps_allowed(!cmd_line.HasSwitch(kNoJumpsSwitch));
+  std::string engine_names[] = { kDefaultFirstPlayer, kDefaultSecondPlayer };
+  if (cmd_line.HasSwitch(kFirstPlayerSwitch)) {
+    engine_names[0] = cmd_line.GetSwitchValue(kFirstPlayerSwitch);
+  }
+  if (cmd_line.HasSwitch(kSecondPlayerSwitch)) {
+    engine_names[1] = cmd_line.GetSwitchValue(kSecondPlayerSwitch);
+  }
+  Engine engines[2];
+  const int game_count = GetIntSwitch(cmd_line, kGamesSwitch, kDefaultGames);
+  const int thread_count = GetIntSwitch(cmd_line, kThreadsSwitch,
+                                        sysconf(_SC_NPROCESSORS_ONLN));
+  const int max_actions = GetIntSwitch(cmd_line, kMaxActionsSwitch,
+                                       kDefaultMaxActions);
+  const uint32_t seed = GetIntSwitch(cmd_line, kSeedSwitch, 0);
+  if (!ParseEngine(engine_names[0], &engines[0]) ||
+      !ParseEngine(engine_names[1], &engines[1]) ||
+      game_count < 0 || thread_count < 1 || max_actions < 1) {
+    Usage();
+    return false;
+  }
+
+  SelfPlayRunner runner(options, std::auto_ptr<SelfPlayRunner::Delegate>(
+      new EngineFactory(options, engines[0], engines[1], seed)));
+  runner.set_thread_count(thread_count);
+  runner.set_max_actions(max_actions);
+  runner.set_color_alternation_enabled(
+      !cmd_line.HasSwitch(kNoColorAlternationSwitch));
+  const int64_t start_time = base::GetMonotonicTime();
+  runner.Run(game_count);
+  const int64_t duration = base::GetMonotonicTime() - start_time;
+
+  std::cout << "Played " << game_count << " games in "
+            << duration / 1000000 << " ms" << std::endl;
+  std::cout << engine_names[0] << " vs " << engine_names[1] << ": "
+            << runner.wins() << " wins, " << runner.draws() << " draws, "
+            << runner.losses() << " losses" << std::endl;
+  if (game_count) {
+    std::cout << "Actions per game: min " << runner.min_action_count()
+              << ", mean " << runner.total_action_count() / game_count
+              << ", max " << runner.max_action_count() << std::endl;
+  }
+  for (int i = 0; i < 2; ++i) {
+    PrintLatency(engine_names[i], runner.latency(i));
+  }
+
+  if (cmd_line.HasSwitch(kOutputSwitch)) {
+    const std::string path(cmd_line.GetSwitchValue(kOutputSwitch));
+    std::ofstream out(path.c_str(), std::ios_base::binary);
+    const bool written =
+        ai::selfplay::WriteGameLog(options, runner.games(), &out);
+    out.close();
+    if (!written || !out) {
+      std::cerr << "Could not write " << path << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  cmd_line->Init(argc, argv);
+  bool result = true;
+  if (cmd_line->HasSwitch(kHelpSwitch)) {
+    Usage();
+  } else {
+    result = RunSelfPlay(*cmd_line);
+  }
+  base::CommandLine::DeleteForCurrentProcess();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
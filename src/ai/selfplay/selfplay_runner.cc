@@ -0,0 +1,171 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/selfplay/selfplay_runner.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/log.h"
+#include "base/method.h"
+#include "base/string_util.h"
+#include "base/threading/thread.h"
+#include "base/time_util.h"
+#include "game/game.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+const int kDefaultMaxActions = 250;
+
+}  // anonymous namespace
+
+// The statistics collected by one thread, which are added to the ones of the
+// runner after all the games are over.
+struct SelfPlayRunner::Worker {
+  LatencyHistogram latency[2];
+};
+
+SelfPlayRunner::SelfPlayRunner(const game::GameOptions& options,
+                               std::auto_ptr<Delegate> delegate)
+    : options_(options),
+      delegate_(delegate.release()),
+      thread_count_(1),
+      max_actions_(kDefaultMaxActions),
+      alternate_colors_(true),
+      workers_(),
+      game_count_(0),
+      next_game_(0),
+      games_(),
+      wins_(0),
+      draws_(0),
+      losses_(0),
+      min_action_count_(0),
+      max_action_count_(0),
+      total_action_count_(0) {
+  DCHECK(Get(delegate_));
+}
+
+SelfPlayRunner::~SelfPlayRunner() {}
+
+void SelfPlayRunner::set_thread_count(int count) {
+  DCHECK_GT(count, 0);
+  thread_count_ = count;
+}
+
+void SelfPlayRunner::set_max_actions(int count) {
+  DCHECK_GT(count, 0);
+  max_actions_ = std::min(count, static_cast<int>(kMaxLoggedActions));
+}
+
+void SelfPlayRunner::Run(int game_count) {
+  DCHECK(game_count >= 0);
+  game_count_ = game_count;
+  next_game_.BitwiseAnd(0);
+  games_.assign(game_count, GameRecord());
+  for (int i = 0; i < thread_count_; ++i) {
+    workers_.push_back(new Worker());
+  }
+
+  // The main thread is the first worker.
+  std::vector<base::threading::Thread*> threads;
+  for (int i = 1; i < thread_count_; ++i) {
+    threads.push_back(
+        new base::threading::Thread("Self-play worker " + base::ToString(i)));
+    threads.back()->Start();
+    threads.back()->SubmitTask(FROM_HERE,
+        base::Bind(new base::Method<void(SelfPlayRunner::*)(int)>(
+            &SelfPlayRunner::RunWorker), this, i));
+  }
+  RunWorker(0);
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i]->SubmitQuitTaskAndJoin();
+    delete threads[i];
+  }
+
+  for (int player = 0; player < 2; ++player) {
+    latency_[player] = LatencyHistogram();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      latency_[player].Merge(workers_[i]->latency[player]);
+    }
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    delete workers_[i];
+  }
+  workers_.clear();
+
+  wins_ = draws_ = losses_ = 0;
+  min_action_count_ = max_action_count_ = 0;
+  total_action_count_ = 0;
+  for (size_t i = 0; i < games_.size(); ++i) {
+    const GameRecord& record = games_[i];
+    if (record.winner == game::NO_COLOR) {
+      ++draws_;
+    } else if (record.winner == record.first_player_color) {
+      ++wins_;
+    } else {
+      ++losses_;
+    }
+    const int action_count = record.actions.size();
+    min_action_count_ = i ? std::min(min_action_count_, action_count) :
+                            action_count;
+    max_action_count_ = std::max(max_action_count_, action_count);
+    total_action_count_ += action_count;
+  }
+}
+
+void SelfPlayRunner::RunWorker(int worker_index) {
+  Worker* const worker = workers_[worker_index];
+  while (true) {
+    const int game_index = next_game_.Increment() - 1;
+    if (game_index >= game_count_) {
+      break;
+    }
+    PlayGame(game_index, worker);
+  }
+}
+
+void SelfPlayRunner::PlayGame(int game_index, Worker* worker) {
+  GameRecord& record = games_[game_index];
+  record.first_player_color = (alternate_colors_ && game_index % 2) ?
+      game::BLACK_COLOR : game::WHITE_COLOR;
+  const std::auto_ptr<AIAlgorithm> first(
+      delegate_->CreatePlayer(0, game_index));
+  const std::auto_ptr<AIAlgorithm> second(
+      delegate_->CreatePlayer(1, game_index));
+  AIAlgorithm* const players[] = { first.get(), second.get() };
+  DCHECK(players[0]);
+  DCHECK(players[1]);
+  game::Game game_model(options_);
+  game_model.Initialize();
+  for (int i = 0; i < max_actions_ && !game_model.is_game_over(); ++i) {
+    const int player =
+        game_model.current_player() == record.first_player_color ? 0 : 1;
+    const bool timed =
+        game_model.next_action_type() != game::PlayerAction::REMOVE_PIECE;
+    const int64_t start_time = base::GetMonotonicTime();
+    const game::PlayerAction action(
+        players[player]->GetNextAction(game_model));
+    if (timed) {
+      worker->latency[player].Add(base::GetMonotonicTime() - start_time);
+    }
+    DCHECK(game_model.CanExecutePlayerAction(action));
+    game_model.ExecutePlayerAction(action);
+  }
+  record.winner =
+      game_model.is_game_over() ? game_model.winner() : game::NO_COLOR;
+  game_model.DumpActionList(&record.actions);
+}
+
+}  // namespace selfplay
+}  // namespace ai
@@ -0,0 +1,129 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_SELFPLAY_SELFPLAY_RUNNER_H_
+#define AI_SELFPLAY_SELFPLAY_RUNNER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/selfplay/game_log.h"
+#include "ai/selfplay/latency_histogram.h"
+#include "base/basic_macros.h"
+#include "base/ptr/scoped_ptr.h"
+#include "base/threading/atomic.h"
+#include "game/game_options.h"
+
+namespace ai {
+
+class AIAlgorithm;
+
+namespace selfplay {
+
+// Plays games between two players, without any user interface, on a pool of
+// worker threads. The workers take the next game to be played when they finish
+// their previous one, so the long games do not keep the other workers idle.
+// The results are counted from the point of view of the first player.
+class AI_EXPORT SelfPlayRunner {
+ public:
+  class Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Returns a new instance of the algorithm used by |player| (0 for the
+    // first player, 1 for the second one) in the game given by |game_index|.
+    // Each instance plays a single game. It is called by all the workers, so
+    // it must be thread safe.
+    virtual std::auto_ptr<AIAlgorithm> CreatePlayer(int player,
+                                                    int game_index) = 0;
+  };
+
+  SelfPlayRunner(const game::GameOptions& options,
+                 std::auto_ptr<Delegate> delegate);
+  ~SelfPlayRunner();
+
+  // The number of threads that play games, including the thread that calls
+  // Run(). By default, the games are played by one thread.
+  int thread_count() const { return thread_count_; }
+  void set_thread_count(int count);
+
+  // The games that are not over after this many actions are stopped and count
+  // as draws. By default, it is 250. It is capped to kMaxLoggedActions, so that
+  // all the games can be written with WriteGameLog().
+  int max_actions() const { return max_actions_; }
+  void set_max_actions(int count);
+
+  // If enabled, the first player plays with white in the even games and with
+  // black in the odd games. Otherwise, it always plays with white. By default,
+  // it is enabled.
+  bool is_color_alternation_enabled() const { return alternate_colors_; }
+  void set_color_alternation_enabled(bool enable) {
+    alternate_colors_ = enable;
+  }
+
+  // Plays |game_count| games and returns when all of them are over. The
+  // results of the previous run are discarded.
+  void Run(int game_count);
+
+  // The games played by the last run, in the order given by their indices.
+  const std::vector<GameRecord>& games() const { return games_; }
+
+  // The results of the first player in the last run.
+  int wins() const { return wins_; }
+  int draws() const { return draws_; }
+  int losses() const { return losses_; }
+
+  // The number of actions of the shortest game, of the longest game, and of all
+  // the games of the last run.
+  int min_action_count() const { return min_action_count_; }
+  int max_action_count() const { return max_action_count_; }
+  int64_t total_action_count() const { return total_action_count_; }
+
+  // The time taken by |player| to choose its moves in the last run. The
+  // removals that follow the moves which close mills are not timed, since the
+  // algorithms choose them together with the moves.
+  const LatencyHistogram& latency(int player) const {
+    return latency_[player];
+  }
+
+ private:
+  struct Worker;
+
+  // Plays games until all of them were taken. It is run by each thread.
+  void RunWorker(int worker_index);
+
+  // Plays the game given by |game_index| and stores it in |games_|.
+  void PlayGame(int game_index, Worker* worker);
+
+  const game::GameOptions options_;
+  base::ptr::scoped_ptr<Delegate> delegate_;
+
+  int thread_count_;
+  int max_actions_;
+  bool alternate_colors_;
+
+  // The state of the running games.
+  std::vector<Worker*> workers_;
+  int game_count_;
+  base::threading::Atomic<int> next_game_;
+
+  std::vector<GameRecord> games_;
+  int wins_;
+  int draws_;
+  int losses_;
+  int min_action_count_;
+  int max_action_count_;
+  int64_t total_action_count_;
+  LatencyHistogram latency_[2];
+
+  DISALLOW_COPY_AND_ASSIGN(SelfPlayRunner);
+};
+
+}  // namespace selfplay
+}  // namespace ai
+
+#endif  // AI_SELFPLAY_SELFPLAY_RUNNER_H_
@@ -0,0 +1,180 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/selfplay/game_log.h"
+#include "ai/selfplay/selfplay_runner.h"
+#include "ai/selfplay/selfplay_test_helper.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+// Creates alphabeta players whose searches are limited only by their depth
+// and whose seeds depend only on the game and the player.
+class AlphaBetaPlayers : public SelfPlayRunner::Delegate {
+ public:
+  explicit AlphaBetaPlayers(const game::GameOptions& options)
+      : options_(options) {}
+
+  virtual std::auto_ptr<AIAlgorithm> CreatePlayer(int player,
+                                                  int game_index) {
+    std::auto_ptr<alphabeta::MorrisAlphaBeta> algorithm(
+        new alphabeta::MorrisAlphaBeta(options_));
+    algorithm->set_max_search_depth(2);
+    algorithm->set_max_search_time(0x7fffffffffffffffLL);
+    algorithm->set_seed(2 * game_index + player + 1);
+    return std::auto_ptr<AIAlgorithm>(algorithm.release());
+  }
+
+ private:
+  // The algorithms keep a reference to the options.
+  const game::GameOptions options_;
+};
+
+std::auto_ptr<SelfPlayRunner::Delegate> CreateAlphaBetaPlayers(
+    const game::GameOptions& options) {
+  return std::auto_ptr<SelfPlayRunner::Delegate>(new AlphaBetaPlayers(options));
+}
+
+bool HaveSameActions(const GameRecord& first, const GameRecord& second) {
+  if (first.actions.size() != second.actions.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < first.actions.size(); ++i) {
+    const game::PlayerAction& action = first.actions[i];
+    const game::PlayerAction& other = second.actions[i];
+    if (action.type() != other.type() ||
+        action.player_color() != other.player_color() ||
+        action.source() != other.source() ||
+        action.destination() != other.destination()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(SelfPlayRunner, PlayGames) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  SelfPlayRunner runner(options, CreateRandomPlayersForTests());
+  runner.set_thread_count(3);
+  runner.Run(20);
+  ASSERT_EQ(20U, runner.games().size());
+  EXPECT_EQ(20, runner.wins() + runner.draws() + runner.losses());
+  int64_t total_action_count = 0;
+  int64_t timed_action_count = 0;
+  for (size_t i = 0; i < runner.games().size(); ++i) {
+    const GameRecord& record = runner.games()[i];
+    EXPECT_EQ(i % 2 ? game::BLACK_COLOR : game::WHITE_COLOR,
+              record.first_player_color);
+    EXPECT_LE(runner.min_action_count(),
+              static_cast<int>(record.actions.size()));
+    EXPECT_GE(runner.max_action_count(),
+              static_cast<int>(record.actions.size()));
+    total_action_count += record.actions.size();
+    game::Game replay(options);
+    replay.Initialize();
+    for (size_t k = 0; k < record.actions.size(); ++k) {
+      if (record.actions[k].type() != game::PlayerAction::REMOVE_PIECE) {
+        ++timed_action_count;
+      }
+      ASSERT_TRUE(replay.CanExecutePlayerAction(record.actions[k]));
+      replay.ExecutePlayerAction(record.actions[k]);
+    }
+    if (replay.is_game_over()) {
+      EXPECT_EQ(replay.winner(), record.winner);
+    } else {
+      EXPECT_EQ(game::NO_COLOR, record.winner);
+      EXPECT_EQ(runner.max_actions(),
+                static_cast<int>(record.actions.size()));
+    }
+  }
+  EXPECT_EQ(total_action_count, runner.total_action_count());
+  EXPECT_EQ(timed_action_count,
+            runner.latency(0).count() + runner.latency(1).count());
+}
+
+TEST(SelfPlayRunner, MaxActions) {
+  game::GameOptions options;
+  options.set_game_type(game::NINE_MEN_MORRIS);
+  SelfPlayRunner runner(options, CreateRandomPlayersForTests());
+  runner.set_max_actions(10);
+  runner.set_color_alternation_enabled(false);
+  runner.Run(4);
+  // The games cannot be over before all the pieces are placed.
+  EXPECT_EQ(4, runner.draws());
+  EXPECT_EQ(10, runner.min_action_count());
+  EXPECT_EQ(10, runner.max_action_count());
+  for (size_t i = 0; i < runner.games().size(); ++i) {
+    EXPECT_EQ(game::WHITE_COLOR, runner.games()[i].first_player_color);
+    EXPECT_EQ(game::NO_COLOR, runner.games()[i].winner);
+  }
+
+  // The games must fit in the logs.
+  runner.set_max_actions(kMaxLoggedActions + 1);
+  EXPECT_EQ(static_cast<int>(kMaxLoggedActions), runner.max_actions());
+}
+
+TEST(SelfPlayRunner, SameGamesForAnyThreadCount) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  SelfPlayRunner single_thread(options, CreateRandomPlayersForTests());
+  single_thread.Run(12);
+  SelfPlayRunner multiple_threads(options, CreateRandomPlayersForTests());
+  multiple_threads.set_thread_count(4);
+  multiple_threads.Run(12);
+  ASSERT_EQ(single_thread.games().size(), multiple_threads.games().size());
+  for (size_t i = 0; i < single_thread.games().size(); ++i) {
+    EXPECT_EQ(single_thread.games()[i].winner,
+              multiple_threads.games()[i].winner);
+    EXPECT_TRUE(HaveSameActions(single_thread.games()[i],
+                                multiple_threads.games()[i]));
+  }
+  EXPECT_EQ(single_thread.wins(), multiple_threads.wins());
+  EXPECT_EQ(single_thread.losses(), multiple_threads.losses());
+}
+
+TEST(SelfPlayRunner, SameAlphaBetaGamesForAnyThreadCount) {
+  game::GameOptions options;
+  options.set_game_type(game::SIX_MEN_MORRIS);
+  SelfPlayRunner single_thread(options, CreateAlphaBetaPlayers(options));
+  single_thread.set_max_actions(60);
+  single_thread.Run(6);
+  SelfPlayRunner multiple_threads(options, CreateAlphaBetaPlayers(options));
+  multiple_threads.set_max_actions(60);
+  multiple_threads.set_thread_count(3);
+  multiple_threads.Run(6);
+  ASSERT_EQ(single_thread.games().size(), multiple_threads.games().size());
+  int distinct_game_count = 0;
+  for (size_t i = 0; i < single_thread.games().size(); ++i) {
+    EXPECT_EQ(single_thread.games()[i].winner,
+              multiple_threads.games()[i].winner);
+    EXPECT_TRUE(HaveSameActions(single_thread.games()[i],
+                                multiple_threads.games()[i]));
+    if (i > 0 && !HaveSameActions(single_thread.games()[0],
+                                  single_thread.games()[i])) {
+      ++distinct_game_count;
+    }
+  }
+  // The seeds are different for each game, so the shuffled searches choose
+  // different moves among the ones with equal scores.
+  EXPECT_GT(distinct_game_count, 0);
+}
+
+}  // anonymous namespace
+}  // namespace selfplay
+}  // namespace ai
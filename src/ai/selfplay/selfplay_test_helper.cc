@@ -0,0 +1,33 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/selfplay/selfplay_test_helper.h"
+
+#include <memory>
+
+#include "ai/ai_algorithm.h"
+#include "ai/random/random_algorithm.h"
+#include "ai/selfplay/selfplay_runner.h"
+
+namespace ai {
+namespace selfplay {
+namespace {
+
+class RandomPlayers : public SelfPlayRunner::Delegate {
+ public:
+  virtual std::auto_ptr<AIAlgorithm> CreatePlayer(int player,
+                                                  int game_index) {
+    return std::auto_ptr<AIAlgorithm>(
+        new random::RandomAlgorithm(2 * game_index + player + 1));
+  }
+};
+
+}  // anonymous namespace
+
+std::auto_ptr<SelfPlayRunner::Delegate> CreateRandomPlayersForTests() {
+  return std::auto_ptr<SelfPlayRunner::Delegate>(new RandomPlayers());
+}
+
+}  // namespace selfplay
+}  // namespace ai
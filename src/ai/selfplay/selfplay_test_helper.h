@@ -0,0 +1,23 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_SELFPLAY_SELFPLAY_TEST_HELPER_H_
+#define AI_SELFPLAY_SELFPLAY_TEST_HELPER_H_
+
+#include <memory>
+
+#include "ai/selfplay/selfplay_runner.h"
+
+namespace ai {
+namespace selfplay {
+
+// Returns a delegate that creates random players whose seeds depend only on
+// the game and the player, so the games do not depend on the thread that
+// plays them.
+std::auto_ptr<SelfPlayRunner::Delegate> CreateRandomPlayersForTests();
+
+}  // namespace selfplay
+}  // namespace ai
+
+#endif  // AI_SELFPLAY_SELFPLAY_TEST_HELPER_H_
@@ -0,0 +1,182 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/state_table.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <string>
+
+#include "ai/game_state.h"
+#include "base/file_path.h"
+#include "base/log.h"
+#include "base/memory_mapped_file.h"
+#include "base/ptr/scoped_ptr.h"
+#include "game/game_type.h"
+
+namespace ai {
+namespace {
+
+const uint32_t kStateTableMagic = 0x3154534d;  // "MST1"
+const uint32_t kStateTableVersion = 1;
+
+}  // anonymous namespace
+
+// The keys start right after the header, so its size keeps them aligned.
+struct StateTable::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t kind;
+  uint32_t game_type;
+  uint64_t key_count;
+  uint64_t value_size;
+  // The checksum of the keys and values.
+  uint64_t data_checksum;
+  // The checksum of the fields above.
+  uint64_t header_checksum;
+};
+
+StateTable::StateTable() : file_(), keys_(NULL), values_(NULL) {}
+
+StateTable::~StateTable() {}
+
+bool StateTable::Open(const base::FilePath& path, uint32_t kind) {
+  DCHECK(!IsOpen());
+  base::ptr::scoped_ptr<base::MemoryMappedFile> file(
+      new base::MemoryMappedFile);
+  if (!file->Initialize(path) || file->length() < sizeof(Header)) {
+    return false;
+  }
+  const Header* const header = reinterpret_cast<const Header*>(file->data());
+  if (header->magic != kStateTableMagic ||
+      header->version != kStateTableVersion ||
+      header->header_checksum != base::ComputeChecksum(
+          header, offsetof(Header, header_checksum))) {
+    ELOG(ERROR) << "Invalid state table " << path.value();
+    return false;
+  }
+  if (header->kind != kind) {
+    return false;
+  }
+  const size_t data_length = file->length() - sizeof(Header);
+  const uint64_t entry_size = sizeof(uint64_t) + header->value_size;
+  if (header->key_count > data_length / entry_size ||
+      header->key_count * entry_size != data_length) {
+    ELOG(ERROR) << "Truncated state table " << path.value();
+    return false;
+  }
+  keys_ = reinterpret_cast<const uint64_t*>(file->data() + sizeof(Header));
+  values_ = reinterpret_cast<const uint8_t*>(keys_ + header->key_count);
+  Reset(file_, Release(&file));
+  return true;
+}
+
+void StateTable::Close() {
+  Reset(file_);
+  keys_ = NULL;
+  values_ = NULL;
+}
+
+game::GameType StateTable::game_type() const {
+  return static_cast<game::GameType>(header()->game_type);
+}
+
+size_t StateTable::size() const {
+  return header()->key_count;
+}
+
+size_t StateTable::value_size() const {
+  return header()->value_size;
+}
+
+const void* StateTable::Find(uint64_t key) const {
+  const uint64_t* const end = keys_ + size();
+  const uint64_t* const it = std::lower_bound(keys_, end, key);
+  if (it == end || *it != key) {
+    return NULL;
+  }
+  return value_at(it - keys_);
+}
+
+const void* StateTable::Find(const GameState& state) const {
+  if (state.game_type() != game_type()) {
+    return NULL;
+  }
+  return Find(state.encoding());
+}
+
+uint64_t StateTable::key_at(size_t index) const {
+  DCHECK_LT(index, size());
+  return keys_[index];
+}
+
+const void* StateTable::value_at(size_t index) const {
+  DCHECK_LT(index, size());
+  return values_ + index * value_size();
+}
+
+bool StateTable::VerifyChecksum() const {
+  DCHECK(IsOpen());
+  return header()->data_checksum ==
+      base::ComputeChecksum(keys_, file_->length() - sizeof(Header));
+}
+
+const StateTable::Header* StateTable::header() const {
+  DCHECK(IsOpen());
+  return reinterpret_cast<const Header*>(file_->data());
+}
+
+StateTableWriter::StateTableWriter(game::GameType game_type, uint32_t kind,
+                                   size_t value_size)
+    : game_type_(game_type),
+      kind_(kind),
+      value_size_(value_size),
+      values_() {}
+
+StateTableWriter::~StateTableWriter() {}
+
+void StateTableWriter::Set(uint64_t key, const void* value) {
+  values_[key].assign(static_cast<const char*>(value), value_size_);
+}
+
+void StateTableWriter::Set(const GameState& state, const void* value) {
+  DCHECK_EQ(game_type_, state.game_type());
+  Set(state.encoding(), value);
+}
+
+bool StateTableWriter::Write(const base::FilePath& path) const {
+  std::string data;
+  data.reserve(values_.size() * (sizeof(uint64_t) + value_size_));
+  for (std::map<uint64_t, std::string>::const_iterator it = values_.begin();
+       it != values_.end(); ++it) {
+    data.append(reinterpret_cast<const char*>(&it->first), sizeof(it->first));
+  }
+  for (std::map<uint64_t, std::string>::const_iterator it = values_.begin();
+       it != values_.end(); ++it) {
+    data.append(it->second);
+  }
+  StateTable::Header header = StateTable::Header();
+  header.magic = kStateTableMagic;
+  header.version = kStateTableVersion;
+  header.kind = kind_;
+  header.game_type = game_type_;
+  header.key_count = values_.size();
+  header.value_size = value_size_;
+  header.data_checksum = base::ComputeChecksum(data.data(), data.size());
+  header.header_checksum =
+      base::ComputeChecksum(&header, offsetof(StateTable::Header,
+                                              header_checksum));
+  std::ofstream out(path.value().c_str(),
+                    std::ios_base::out | std::ios_base::binary);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(data.data(), data.size());
+  out.close();
+  return out.good();
+}
+
+}  // namespace ai
@@ -0,0 +1,115 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_STATE_TABLE_H_
+#define AI_STATE_TABLE_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+#include "base/memory_mapped_file.h"
+#include "base/ptr/scoped_ptr.h"
+#include "game/game_type.h"
+
+namespace ai {
+
+// A read-only table that maps game states to values of a fixed size, stored in
+// a memory-mapped file written by StateTableWriter.
+//
+// The file starts with a versioned header, which is followed by the sorted
+// keys (the encodings of the game states) and by the values, in the same order.
+// Open() only validates the header, so it takes the same time for any table
+// size. Find() is a binary search over the mapped keys and returns a pointer
+// into the mapped values, so nothing is copied. The pages of the file are
+// shared by all the processes that open it. The data is stored in the byte
+// order of the machine that wrote it.
+//
+// The table does not change after Open(), so it can be used by multiple
+// threads.
+class AI_EXPORT StateTable {
+ public:
+  StateTable();
+  ~StateTable();
+
+  // Maps the table from |path|. Returns false if the file is not a valid table
+  // with the given |kind|, which is chosen by the writer of the table to tell
+  // its contents apart from the ones of other tables.
+  bool Open(const base::FilePath& path, uint32_t kind);
+
+  bool IsOpen() const { return Get(file_) != NULL; }
+
+  // Unmaps the table. The pointers returned by Find() become invalid.
+  void Close();
+
+  game::GameType game_type() const;
+  size_t size() const;
+  size_t value_size() const;
+
+  // Returns the value of the state with the given |key|, or NULL if the key is
+  // not in the table.
+  const void* Find(uint64_t key) const;
+
+  // Same as above, with the key of |state| being its encoding. Returns NULL if
+  // |state| is from another game type.
+  const void* Find(const GameState& state) const;
+
+  // The keys and values ordered by key, for 0 <= |index| < size().
+  uint64_t key_at(size_t index) const;
+  const void* value_at(size_t index) const;
+
+  // Returns true if the contents of the table match the checksum stored in the
+  // header. This reads the entire file, so it is not done by Open().
+  bool VerifyChecksum() const;
+
+ private:
+  friend class StateTableWriter;
+
+  // The header of the table file.
+  struct Header;
+
+  const Header* header() const;
+
+  base::ptr::scoped_ptr<base::MemoryMappedFile> file_;
+  const uint64_t* keys_;
+  const uint8_t* values_;
+
+  DISALLOW_COPY_AND_ASSIGN(StateTable);
+};
+
+// Collects the values of a StateTable and writes them to a file.
+class AI_EXPORT StateTableWriter {
+ public:
+  StateTableWriter(game::GameType game_type, uint32_t kind, size_t value_size);
+  ~StateTableWriter();
+
+  // Sets the value of the state with the given |key|, replacing the previous
+  // one. |value| must point to value_size() bytes.
+  void Set(uint64_t key, const void* value);
+  void Set(const GameState& state, const void* value);
+
+  size_t size() const { return values_.size(); }
+  size_t value_size() const { return value_size_; }
+
+  // Writes the table to |path|. Returns false if the file could not be written.
+  bool Write(const base::FilePath& path) const;
+
+ private:
+  const game::GameType game_type_;
+  const uint32_t kind_;
+  const size_t value_size_;
+  std::map<uint64_t, std::string> values_;
+
+  DISALLOW_COPY_AND_ASSIGN(StateTableWriter);
+};
+
+}  // namespace ai
+
+#endif  // AI_STATE_TABLE_H_
@@ -0,0 +1,122 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "ai/game_state.h"
+#include "ai/state_table.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace {
+
+const uint32_t kTestKind = 7;
+
+TEST(StateTable, WriteAndOpen) {
+  base::ScopedTempDir temp_dir("state_table_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  const base::FilePath path(temp_dir.Get().Append("table.bin"));
+  StateTableWriter writer(game::SIX_MEN_MORRIS, kTestKind, sizeof(uint32_t));
+  const int kStateCount = 16;
+  for (int i = kStateCount - 1; i >= 0; --i) {
+    GameState state(game::SIX_MEN_MORRIS);
+    state.AddPiece(i, game::WHITE_COLOR);
+    const uint32_t value = i * 10;
+    writer.Set(state, &value);
+  }
+  // The last value of a state replaces the previous ones.
+  const uint32_t value = 12345;
+  writer.Set(GameState(game::SIX_MEN_MORRIS), &value);
+  writer.Set(GameState(game::SIX_MEN_MORRIS), &value);
+  EXPECT_EQ(static_cast<size_t>(kStateCount + 1), writer.size());
+  ASSERT_TRUE(writer.Write(path));
+
+  StateTable table;
+  EXPECT_FALSE(table.IsOpen());
+  ASSERT_TRUE(table.Open(path, kTestKind));
+  ASSERT_TRUE(table.IsOpen());
+  EXPECT_TRUE(table.VerifyChecksum());
+  EXPECT_EQ(game::SIX_MEN_MORRIS, table.game_type());
+  EXPECT_EQ(writer.size(), table.size());
+  EXPECT_EQ(sizeof(uint32_t), table.value_size());
+  for (size_t i = 1; i < table.size(); ++i) {
+    EXPECT_LT(table.key_at(i - 1), table.key_at(i));
+  }
+  for (int i = 0; i < kStateCount; ++i) {
+    GameState state(game::SIX_MEN_MORRIS);
+    state.AddPiece(i, game::WHITE_COLOR);
+    const void* const found = table.Find(state);
+    ASSERT_TRUE(found != NULL);
+    EXPECT_EQ(static_cast<uint32_t>(i * 10),
+              *static_cast<const uint32_t*>(found));
+    // The states of other game types are not in the table.
+    GameState other_state(game::NINE_MEN_MORRIS);
+    other_state.AddPiece(i, game::WHITE_COLOR);
+    EXPECT_TRUE(table.Find(other_state) == NULL);
+  }
+  const void* const found = table.Find(GameState(game::SIX_MEN_MORRIS));
+  ASSERT_TRUE(found != NULL);
+  EXPECT_EQ(value, *static_cast<const uint32_t*>(found));
+  GameState missing_state(game::SIX_MEN_MORRIS);
+  missing_state.AddPiece(0, game::BLACK_COLOR);
+  EXPECT_TRUE(table.Find(missing_state) == NULL);
+  table.Close();
+  EXPECT_FALSE(table.IsOpen());
+}
+
+TEST(StateTable, InvalidFiles) {
+  base::ScopedTempDir temp_dir("state_table_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  const base::FilePath path(temp_dir.Get().Append("table.bin"));
+  StateTableWriter writer(game::NINE_MEN_MORRIS, kTestKind, 1);
+  const char value = 'x';
+  writer.Set(GameState(), &value);
+  ASSERT_TRUE(writer.Write(path));
+  StateTable other_kind_table;
+  EXPECT_FALSE(other_kind_table.Open(path, kTestKind + 1));
+  EXPECT_FALSE(other_kind_table.IsOpen());
+
+  std::string contents;
+  {
+    std::ifstream in(path.value().c_str(), std::ios_base::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+  }
+  // A corrupted value is only detected by VerifyChecksum().
+  contents[contents.size() - 1] = 'y';
+  {
+    std::ofstream out(path.value().c_str(), std::ios_base::binary);
+    out << contents;
+  }
+  StateTable corrupted_table;
+  ASSERT_TRUE(corrupted_table.Open(path, kTestKind));
+  EXPECT_FALSE(corrupted_table.VerifyChecksum());
+  // A corrupted header is detected by Open().
+  contents[8] ^= 1;
+  {
+    std::ofstream out(path.value().c_str(), std::ios_base::binary);
+    out << contents;
+  }
+  StateTable corrupted_header_table;
+  EXPECT_FALSE(corrupted_header_table.Open(path, kTestKind));
+  // So is a truncated file.
+  contents[8] ^= 1;
+  {
+    std::ofstream out(path.value().c_str(), std::ios_base::binary);
+    out << contents.substr(0, contents.size() - 1);
+  }
+  StateTable truncated_table;
+  EXPECT_FALSE(truncated_table.Open(path, kTestKind));
+}
+
+}  // anonymous namespace
+}  // namespace ai
@@ -0,0 +1,163 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/symmetry.h"
+
+#include "ai/bitboard.h"
+#include "base/basic_macros.h"
+#include "base/log.h"
+#include "game/game_type.h"
+
+namespace ai {
+namespace {
+
+const game::GameType kGameTypes[] = {
+  game::THREE_MEN_MORRIS, game::SIX_MEN_MORRIS, game::NINE_MEN_MORRIS
+};
+
+const int kSquareSymmetries = 8;
+const int kBitsPerByte = 8;
+const int kBytesPerBitboard = (kMaxBitboardLocations + 7) / kBitsPerByte;
+
+// Applies the symmetry of the square with the given |index| to the location
+// at (|line|, |column|) of a board with the given |size|.
+void ApplySquareSymmetry(int index, int size, int* line, int* column) {
+  const int n = size - 1;
+  const int l = *line;
+  const int c = *column;
+  switch (index) {
+    case 0: *line = l; *column = c; break;
+    case 1: *line = c; *column = n - l; break;
+    case 2: *line = n - l; *column = n - c; break;
+    case 3: *line = n - c; *column = l; break;
+    case 4: *line = l; *column = n - c; break;
+    case 5: *line = n - l; *column = c; break;
+    case 6: *line = c; *column = l; break;
+    case 7: *line = n - c; *column = n - l; break;
+    default: NOTREACHED();
+  }
+}
+
+// Swaps the outer and the inner ring of a board with the given |size| and
+// |ring_count| rings. The coordinate of ring r is r or size - 1 - r.
+int SwapRings(int coordinate, int size, int ring_count) {
+  const int middle = size / 2;
+  if (coordinate < middle) {
+    return ring_count - 1 - coordinate;
+  }
+  if (coordinate > middle) {
+    return size - 1 - (ring_count - 1 - (size - 1 - coordinate));
+  }
+  return coordinate;
+}
+
+// The precomputed symmetries of one board.
+struct SymmetryTable {
+  int symmetry_count;
+  int inverses[kMaxSymmetries];
+  signed char indices[kMaxSymmetries][kMaxBitboardLocations];
+
+  // The image of each byte of a bitboard, by symmetry and byte position.
+  Bitboard byte_images[kMaxSymmetries][kBytesPerBitboard][1 << kBitsPerByte];
+};
+
+// The symmetry tables of all the game types. They are filled in before main()
+// from the bitboard layouts and they are only read after that, so they do not
+// need any locking.
+class SymmetryTables {
+ public:
+  SymmetryTables() {
+    for (size_t i = 0; i < arraysize(kGameTypes); ++i) {
+      Initialize(GetBitboardLayout(kGameTypes[i]), &tables_[kGameTypes[i]]);
+    }
+  }
+
+  const SymmetryTable& Get(game::GameType game_type) const {
+    DCHECK_LT(static_cast<size_t>(game_type), arraysize(tables_));
+    return tables_[game_type];
+  }
+
+ private:
+  static void Initialize(const BitboardLayout& layout, SymmetryTable* table) {
+    const int size = layout.board_size;
+    const int ring_count = size / 2;
+    const int ring_variants = ring_count > 1 ? 2 : 1;
+    table->symmetry_count = kSquareSymmetries * ring_variants;
+    for (int s = 0; s < table->symmetry_count; ++s) {
+      for (int i = 0; i < layout.location_count; ++i) {
+        int line = layout.lines[i];
+        int column = layout.columns[i];
+        if (s >= kSquareSymmetries) {
+          line = SwapRings(line, size, ring_count);
+          column = SwapRings(column, size, ring_count);
+        }
+        ApplySquareSymmetry(s % kSquareSymmetries, size, &line, &column);
+        table->indices[s][i] =
+            layout.indices[line * kMaxBitboardBoardSize + column];
+        DCHECK_GT(table->indices[s][i], -1);
+      }
+      for (int byte = 0; byte < kBytesPerBitboard; ++byte) {
+        for (int value = 0; value < (1 << kBitsPerByte); ++value) {
+          Bitboard image = 0;
+          for (int bit = 0; bit < kBitsPerByte; ++bit) {
+            const int index = byte * kBitsPerByte + bit;
+            if ((value & (1 << bit)) && index < layout.location_count) {
+              image |= BitAt(table->indices[s][index]);
+            }
+          }
+          table->byte_images[s][byte][value] = image;
+        }
+      }
+    }
+    for (int s = 0; s < table->symmetry_count; ++s) {
+      table->inverses[s] = -1;
+      for (int t = 0; t < table->symmetry_count; ++t) {
+        bool is_inverse = true;
+        for (int i = 0; i < layout.location_count; ++i) {
+          is_inverse &= table->indices[t][table->indices[s][i]] == i;
+        }
+        if (is_inverse) {
+          table->inverses[s] = t;
+        }
+      }
+      DCHECK_GT(table->inverses[s], -1);
+    }
+  }
+
+  SymmetryTable tables_[arraysize(kGameTypes)];
+};
+
+const SymmetryTables kSymmetryTables;
+
+}  // anonymous namespace
+
+int GetSymmetryCount(game::GameType game_type) {
+  return kSymmetryTables.Get(game_type).symmetry_count;
+}
+
+int GetInverseSymmetry(game::GameType game_type, int symmetry) {
+  const SymmetryTable& table = kSymmetryTables.Get(game_type);
+  DCHECK(symmetry >= 0 && symmetry < table.symmetry_count);
+  return table.inverses[symmetry];
+}
+
+int GetSymmetricIndex(game::GameType game_type, int symmetry, int index) {
+  const SymmetryTable& table = kSymmetryTables.Get(game_type);
+  DCHECK(symmetry >= 0 && symmetry < table.symmetry_count);
+  DCHECK(index >= 0 && index < kMaxBitboardLocations);
+  return table.indices[symmetry][index];
+}
+
+Bitboard GetSymmetricBitboard(game::GameType game_type,
+                              int symmetry,
+                              Bitboard board) {
+  const SymmetryTable& table = kSymmetryTables.Get(game_type);
+  DCHECK(symmetry >= 0 && symmetry < table.symmetry_count);
+  const Bitboard (*images)[1 << kBitsPerByte] = table.byte_images[symmetry];
+  return images[0][board & 0xff] |
+         images[1][(board >> 8) & 0xff] |
+         images[2][(board >> 16) & 0xff];
+}
+
+}  // namespace ai
@@ -0,0 +1,43 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_SYMMETRY_H_
+#define AI_SYMMETRY_H_
+
+#include "ai/ai_export.h"
+#include "ai/bitboard.h"
+#include "game/game_type.h"
+
+namespace ai {
+
+// The symmetries of the morris boards are the permutations of the locations
+// that preserve the adjacent locations and the mills. Each board has the eight
+// symmetries of the square: the rotations by multiples of 90 degrees and the
+// reflections. The boards with more than one ring also have the symmetries
+// obtained by swapping the outer and the inner ring, which brings their count
+// to sixteen. Symmetry 0 is always the identity.
+const int kMaxSymmetries = 16;
+
+// Returns the number of symmetries of the board used by |game_type|.
+AI_EXPORT int GetSymmetryCount(game::GameType game_type);
+
+// Returns the symmetry that undoes |symmetry|.
+AI_EXPORT int GetInverseSymmetry(game::GameType game_type, int symmetry);
+
+// Returns the bit index of the location to which |symmetry| moves the
+// location with the given |index|.
+AI_EXPORT int GetSymmetricIndex(game::GameType game_type,
+                                int symmetry,
+                                int index);
+
+// Returns the set of locations to which |symmetry| moves the locations from
+// |board|. The permutation is performed with one table lookup for each byte
+// of |board|.
+AI_EXPORT Bitboard GetSymmetricBitboard(game::GameType game_type,
+                                        int symmetry,
+                                        Bitboard board);
+
+}  // namespace ai
+
+#endif  // AI_SYMMETRY_H_
@@ -0,0 +1,118 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "ai/symmetry.h"
+#include "base/basic_macros.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace {
+
+const game::GameType kGameTypes[] = {
+  game::THREE_MEN_MORRIS, game::SIX_MEN_MORRIS, game::NINE_MEN_MORRIS
+};
+
+// Returns a state of |game_type| with pieces on a few asymmetric locations.
+GameState GetTestState(game::GameType game_type) {
+  GameState state(game_type);
+  state.set_current_player(game::BLACK_COLOR);
+  state.set_pieces_in_hand(game::WHITE_COLOR, 1);
+  state.set_pieces_in_hand(game::BLACK_COLOR, 2);
+  state.AddPiece(0, game::WHITE_COLOR);
+  state.AddPiece(1, game::WHITE_COLOR);
+  state.AddPiece(5, game::BLACK_COLOR);
+  return state;
+}
+
+TEST(Symmetry, SymmetryCount) {
+  EXPECT_EQ(8, GetSymmetryCount(game::THREE_MEN_MORRIS));
+  EXPECT_EQ(16, GetSymmetryCount(game::SIX_MEN_MORRIS));
+  EXPECT_EQ(16, GetSymmetryCount(game::NINE_MEN_MORRIS));
+}
+
+TEST(Symmetry, PreservesAdjacencyAndMills) {
+  for (size_t i = 0; i < arraysize(kGameTypes); ++i) {
+    const game::GameType game_type = kGameTypes[i];
+    const BitboardLayout& layout = GetBitboardLayout(game_type);
+    std::set<std::vector<int> > permutations;
+    for (int s = 0; s < GetSymmetryCount(game_type); ++s) {
+      std::vector<int> permutation;
+      for (int index = 0; index < layout.location_count; ++index) {
+        permutation.push_back(GetSymmetricIndex(game_type, s, index));
+        EXPECT_EQ(layout.adjacency[permutation.back()],
+                  GetSymmetricBitboard(game_type, s, layout.adjacency[index]));
+      }
+      EXPECT_EQ(layout.all, GetSymmetricBitboard(game_type, s, layout.all));
+      for (int m = 0; m < layout.mill_count; ++m) {
+        const Bitboard mill =
+            GetSymmetricBitboard(game_type, s, layout.mills[m]);
+        EXPECT_TRUE(std::count(layout.mills,
+                               layout.mills + layout.mill_count, mill) == 1);
+      }
+      // All the symmetries are distinct.
+      EXPECT_TRUE(permutations.insert(permutation).second);
+    }
+    for (int index = 0; index < layout.location_count; ++index) {
+      EXPECT_EQ(index, GetSymmetricIndex(game_type, 0, index));
+    }
+  }
+}
+
+TEST(Symmetry, Inverse) {
+  for (size_t i = 0; i < arraysize(kGameTypes); ++i) {
+    const game::GameType game_type = kGameTypes[i];
+    const GameState state(GetTestState(game_type));
+    for (int s = 0; s < GetSymmetryCount(game_type); ++s) {
+      const int inverse = GetInverseSymmetry(game_type, s);
+      EXPECT_EQ(state,
+                state.GetSymmetricState(s).GetSymmetricState(inverse));
+    }
+    EXPECT_EQ(0, GetInverseSymmetry(game_type, 0));
+  }
+}
+
+TEST(Symmetry, CanonicalState) {
+  for (size_t i = 0; i < arraysize(kGameTypes); ++i) {
+    const game::GameType game_type = kGameTypes[i];
+    const GameState state(GetTestState(game_type));
+    int symmetry = -1;
+    const GameState canonical_state(state.GetCanonicalState(&symmetry));
+    EXPECT_EQ(canonical_state, state.GetSymmetricState(symmetry));
+    EXPECT_LE(canonical_state.encoding(), state.encoding());
+    EXPECT_EQ(state.current_player(), canonical_state.current_player());
+    EXPECT_EQ(state.pieces_in_hand(game::BLACK_COLOR),
+              canonical_state.pieces_in_hand(game::BLACK_COLOR));
+    // The key is updated with the pieces.
+    GameState expected_state(game_type);
+    expected_state.set_current_player(game::BLACK_COLOR);
+    expected_state.set_pieces_in_hand(game::WHITE_COLOR, 1);
+    expected_state.set_pieces_in_hand(game::BLACK_COLOR, 2);
+    for (int index = 0; index < kMaxBitboardLocations; ++index) {
+      if (canonical_state.pieces(game::WHITE_COLOR) & BitAt(index)) {
+        expected_state.AddPiece(index, game::WHITE_COLOR);
+      } else if (canonical_state.pieces(game::BLACK_COLOR) & BitAt(index)) {
+        expected_state.AddPiece(index, game::BLACK_COLOR);
+      }
+    }
+    EXPECT_EQ(expected_state.key(), canonical_state.key());
+    // All the symmetric states have the same canonical form.
+    for (int s = 0; s < GetSymmetryCount(game_type); ++s) {
+      const GameState symmetric_state(state.GetSymmetricState(s));
+      EXPECT_EQ(canonical_state, symmetric_state.GetCanonicalState(NULL));
+      EXPECT_EQ(canonical_state.key(),
+                symmetric_state.GetCanonicalState(NULL).key());
+    }
+  }
+}
+
+}  // anonymous namespace
+}  // namespace ai
@@ -0,0 +1,195 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/tablebase/position_index.h"
+
+#include <stdint.h>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "base/log.h"
+#include "game/piece_color.h"
+
+namespace ai {
+namespace tablebase {
+namespace {
+
+// The binomial coefficients C(n, k) for all the values needed to rank sets of
+// locations. The table is filled in before main() and it is only read after
+// that, so it does not need any locking.
+class BinomialTable {
+ public:
+  BinomialTable() {
+    for (int n = 0; n <= kMaxBitboardLocations; ++n) {
+      values_[n][0] = 1;
+      for (int k = 1; k <= kMaxBitboardLocations; ++k) {
+        values_[n][k] = n == 0 ? 0 : values_[n - 1][k - 1] + values_[n - 1][k];
+      }
+    }
+  }
+
+  uint64_t Get(int n, int k) const {
+    DCHECK(n >= 0 && n <= kMaxBitboardLocations);
+    DCHECK(k >= 0 && k <= kMaxBitboardLocations);
+    return values_[n][k];
+  }
+
+ private:
+  uint64_t values_[kMaxBitboardLocations + 1][kMaxBitboardLocations + 1];
+};
+
+const BinomialTable kBinomials;
+
+// Returns the rank of the set of bit indices from |set| among all the sets
+// with the same number of elements (the combinatorial number system).
+uint64_t RankSet(Bitboard set) {
+  uint64_t rank = 0;
+  for (int k = 1; set; ++k) {
+    rank += kBinomials.Get(LowestBitIndex(set), k);
+    set &= set - 1;
+  }
+  return rank;
+}
+
+// The inverse of RankSet() for sets with |size| elements, all of them lower
+// than |limit|.
+Bitboard UnrankSet(uint64_t rank, int size, int limit) {
+  Bitboard set = 0;
+  int index = limit - 1;
+  for (int k = size; k > 0; --k) {
+    while (kBinomials.Get(index, k) > rank) {
+      --index;
+    }
+    DCHECK(index >= 0);
+    set |= BitAt(index);
+    rank -= kBinomials.Get(index, k);
+    --index;
+  }
+  return set;
+}
+
+// Removes the bits of |mask| from |set| and shifts the bits above them, so
+// that the result contains the indices of |set| among the locations that are
+// not in |mask|.
+Bitboard Compress(Bitboard set, Bitboard mask) {
+  Bitboard result = 0;
+  while (set) {
+    const int index = LowestBitIndex(set);
+    set &= set - 1;
+    result |= BitAt(index - PopCount(mask & (BitAt(index) - 1)));
+  }
+  return result;
+}
+
+// The inverse of Compress().
+Bitboard Expand(Bitboard set, Bitboard mask) {
+  Bitboard result = 0;
+  int compressed_index = 0;
+  for (int index = 0; set; ++index) {
+    if (mask & BitAt(index)) {
+      continue;
+    }
+    if (set & BitAt(compressed_index)) {
+      result |= BitAt(index);
+      set &= ~BitAt(compressed_index);
+    }
+    ++compressed_index;
+  }
+  return result;
+}
+
+}  // anonymous namespace
+
+Material::Material()
+    : mover_on_board(0),
+      mover_in_hand(0),
+      opponent_on_board(0),
+      opponent_in_hand(0) {}
+
+Material::Material(int mover_on_board, int mover_in_hand,
+                   int opponent_on_board, int opponent_in_hand)
+    : mover_on_board(mover_on_board),
+      mover_in_hand(mover_in_hand),
+      opponent_on_board(opponent_on_board),
+      opponent_in_hand(opponent_in_hand) {}
+
+// static
+Material Material::FromState(const GameState& state) {
+  const game::PieceColor mover = state.current_player();
+  const game::PieceColor opponent = game::GetOpponent(mover);
+  return Material(PopCount(state.pieces(mover)), state.pieces_in_hand(mover),
+                  PopCount(state.pieces(opponent)),
+                  state.pieces_in_hand(opponent));
+}
+
+bool Material::operator==(const Material& other) const {
+  return mover_on_board == other.mover_on_board &&
+         mover_in_hand == other.mover_in_hand &&
+         opponent_on_board == other.opponent_on_board &&
+         opponent_in_hand == other.opponent_in_hand;
+}
+
+bool Material::operator<(const Material& other) const {
+  if (mover_on_board != other.mover_on_board) {
+    return mover_on_board < other.mover_on_board;
+  }
+  if (mover_in_hand != other.mover_in_hand) {
+    return mover_in_hand < other.mover_in_hand;
+  }
+  if (opponent_on_board != other.opponent_on_board) {
+    return opponent_on_board < other.opponent_on_board;
+  }
+  return opponent_in_hand < other.opponent_in_hand;
+}
+
+uint64_t GetPositionCount(game::GameType game_type, const Material& material) {
+  const int locations = GetBitboardLayout(game_type).location_count;
+  if (material.mover_on_board + material.opponent_on_board > locations) {
+    return 0;
+  }
+  return kBinomials.Get(locations, material.mover_on_board) *
+      kBinomials.Get(locations - material.mover_on_board,
+                     material.opponent_on_board);
+}
+
+uint64_t GetPositionIndex(const GameState& state) {
+  const game::PieceColor mover = state.current_player();
+  const Bitboard mover_pieces = state.pieces(mover);
+  const Bitboard opponent_pieces = state.pieces(game::GetOpponent(mover));
+  const int free_locations =
+      state.layout().location_count - PopCount(mover_pieces);
+  return RankSet(mover_pieces) *
+      kBinomials.Get(free_locations, PopCount(opponent_pieces)) +
+      RankSet(Compress(opponent_pieces, mover_pieces));
+}
+
+GameState GetPosition(game::GameType game_type,
+                      const Material& material,
+                      uint64_t index) {
+  DCHECK_LT(index, GetPositionCount(game_type, material));
+  const int locations = GetBitboardLayout(game_type).location_count;
+  const int free_locations = locations - material.mover_on_board;
+  const uint64_t opponent_sets =
+      kBinomials.Get(free_locations, material.opponent_on_board);
+  const Bitboard mover_pieces =
+      UnrankSet(index / opponent_sets, material.mover_on_board, locations);
+  const Bitboard opponent_pieces = Expand(
+      UnrankSet(index % opponent_sets, material.opponent_on_board,
+                free_locations),
+      mover_pieces);
+  GameState state(game_type);
+  state.set_current_player(game::WHITE_COLOR);
+  state.set_pieces_in_hand(game::WHITE_COLOR, material.mover_in_hand);
+  state.set_pieces_in_hand(game::BLACK_COLOR, material.opponent_in_hand);
+  for (Bitboard pieces = mover_pieces; pieces; pieces &= pieces - 1) {
+    state.AddPiece(LowestBitIndex(pieces), game::WHITE_COLOR);
+  }
+  for (Bitboard pieces = opponent_pieces; pieces; pieces &= pieces - 1) {
+    state.AddPiece(LowestBitIndex(pieces), game::BLACK_COLOR);
+  }
+  return state;
+}
+
+}  // namespace tablebase
+}  // namespace ai
@@ -0,0 +1,60 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_TABLEBASE_POSITION_INDEX_H_
+#define AI_TABLEBASE_POSITION_INDEX_H_
+
+#include <stdint.h>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "game/game_type.h"
+
+namespace ai {
+namespace tablebase {
+
+// The material of a position, from the point of view of the player to move
+// (the mover). The rules do not depend on the colors of the players, so the
+// positions with the same material form a class that is solved and stored as
+// a whole, regardless of which color is to move.
+struct AI_EXPORT Material {
+  Material();
+  Material(int mover_on_board, int mover_in_hand,
+           int opponent_on_board, int opponent_in_hand);
+
+  // Returns the material of |state|.
+  static Material FromState(const GameState& state);
+
+  int mover_pieces() const { return mover_on_board + mover_in_hand; }
+  int opponent_pieces() const { return opponent_on_board + opponent_in_hand; }
+
+  bool operator==(const Material& other) const;
+  bool operator<(const Material& other) const;
+
+  int mover_on_board;
+  int mover_in_hand;
+  int opponent_on_board;
+  int opponent_in_hand;
+};
+
+// Returns the number of positions with the given |material| that can be set
+// up on the board of |game_type|.
+AI_EXPORT uint64_t GetPositionCount(game::GameType game_type,
+                                    const Material& material);
+
+// Returns the index of |state| among the positions with the same material.
+// The index is between 0 and GetPositionCount() - 1. The mover pieces are
+// ranked among all the locations of the board, and the opponent pieces among
+// the locations that remain empty.
+AI_EXPORT uint64_t GetPositionIndex(const GameState& state);
+
+// The inverse of GetPositionIndex(). The returned state has white to move.
+AI_EXPORT GameState GetPosition(game::GameType game_type,
+                                const Material& material,
+                                uint64_t index);
+
+}  // namespace tablebase
+}  // namespace ai
+
+#endif  // AI_TABLEBASE_POSITION_INDEX_H_
@@ -0,0 +1,80 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "ai/tablebase/position_index.h"
+#include "base/basic_macros.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace tablebase {
+namespace {
+
+TEST(PositionIndex, PositionCount) {
+  EXPECT_EQ(84U * 20U,
+            GetPositionCount(game::THREE_MEN_MORRIS, Material(3, 0, 3, 0)));
+  EXPECT_EQ(1U,
+            GetPositionCount(game::THREE_MEN_MORRIS, Material(0, 3, 0, 3)));
+  EXPECT_EQ(2024U * 1330U,
+            GetPositionCount(game::NINE_MEN_MORRIS, Material(3, 0, 3, 0)));
+  EXPECT_EQ(0U,
+            GetPositionCount(game::THREE_MEN_MORRIS, Material(5, 0, 5, 0)));
+}
+
+TEST(PositionIndex, RoundTrip) {
+  const game::GameType game_types[] = {
+    game::THREE_MEN_MORRIS, game::SIX_MEN_MORRIS, game::NINE_MEN_MORRIS
+  };
+  const Material materials[] = {
+    Material(3, 0, 3, 0), Material(2, 1, 3, 0), Material(4, 0, 3, 0),
+    Material(0, 3, 0, 3)
+  };
+  for (size_t i = 0; i < arraysize(game_types); ++i) {
+    for (size_t j = 0; j < arraysize(materials); ++j) {
+      const uint64_t count = GetPositionCount(game_types[i], materials[j]);
+      // Visit about a thousand positions, including the first and last ones.
+      const uint64_t step = count / 1000 + 1;
+      for (uint64_t index = 0; index < count; index += step) {
+        const GameState state(
+            GetPosition(game_types[i], materials[j], index));
+        EXPECT_EQ(materials[j], Material::FromState(state));
+        EXPECT_EQ(index, GetPositionIndex(state));
+      }
+      if (count) {
+        EXPECT_EQ(count - 1, GetPositionIndex(
+            GetPosition(game_types[i], materials[j], count - 1)));
+      }
+    }
+  }
+}
+
+TEST(PositionIndex, ColorIndependent) {
+  const Material material(3, 1, 4, 0);
+  const uint64_t index = 12345;
+  const GameState state(GetPosition(game::NINE_MEN_MORRIS, material, index));
+  // The same position with the colors swapped.
+  GameState swapped_state(game::NINE_MEN_MORRIS);
+  swapped_state.set_current_player(game::BLACK_COLOR);
+  swapped_state.set_pieces_in_hand(game::BLACK_COLOR, material.mover_in_hand);
+  swapped_state.set_pieces_in_hand(game::WHITE_COLOR,
+                                   material.opponent_in_hand);
+  for (int i = 0; i < kMaxBitboardLocations; ++i) {
+    if (state.pieces(game::WHITE_COLOR) & BitAt(i)) {
+      swapped_state.AddPiece(i, game::BLACK_COLOR);
+    } else if (state.pieces(game::BLACK_COLOR) & BitAt(i)) {
+      swapped_state.AddPiece(i, game::WHITE_COLOR);
+    }
+  }
+  EXPECT_EQ(material, Material::FromState(swapped_state));
+  EXPECT_EQ(index, GetPositionIndex(swapped_state));
+}
+
+}  // anonymous namespace
+}  // namespace tablebase
+}  // namespace ai
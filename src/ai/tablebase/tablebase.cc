@@ -0,0 +1,263 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/tablebase/tablebase.h"
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ai/game_state.h"
+#include "ai/tablebase/position_index.h"
+#include "base/file_path.h"
+#include "base/log.h"
+#include "base/memory_mapped_file.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+
+namespace ai {
+namespace tablebase {
+namespace {
+
+const char kTableFileExtension[] = ".tb";
+
+const uint32_t kTableMagic = 0x3142544d;  // "MTB1"
+const uint32_t kTableVersion = 2;
+
+// The header of a table file. It is followed by the packed entries, stored in
+// 64-bit words. Entry i starts at bit i * |entry_bits| of the data. The size of
+// the header keeps the words aligned when the file is mapped.
+struct TableHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint8_t game_type;
+  uint8_t jumps_allowed;
+  uint8_t mover_on_board;
+  uint8_t mover_in_hand;
+  uint8_t opponent_on_board;
+  uint8_t opponent_in_hand;
+  uint8_t entry_bits;
+  uint8_t reserved;
+  uint64_t position_count;
+  // The checksum of the packed entries.
+  uint64_t data_checksum;
+  // The checksum of the fields above.
+  uint64_t header_checksum;
+};
+
+const int kOutcomeBits = 2;
+
+size_t GetWordCount(uint64_t entry_count, int entry_bits) {
+  return (entry_count * entry_bits + 63) / 64;
+}
+
+uint16_t GetPackedEntry(const uint64_t* words, int entry_bits,
+                        uint64_t index) {
+  const uint64_t bit = index * entry_bits;
+  const size_t word = bit / 64;
+  const int offset = bit % 64;
+  uint64_t value = words[word] >> offset;
+  if (offset + entry_bits > 64) {
+    value |= words[word + 1] << (64 - offset);
+  }
+  return value & ((1U << entry_bits) - 1);
+}
+
+void SetPackedEntry(int entry_bits, uint64_t index, uint16_t value,
+                    std::vector<uint64_t>* words) {
+  const uint64_t bit = index * entry_bits;
+  const size_t word = bit / 64;
+  const int offset = bit % 64;
+  (*words)[word] |= static_cast<uint64_t>(value) << offset;
+  if (offset + entry_bits > 64) {
+    (*words)[word + 1] |= static_cast<uint64_t>(value) >> (64 - offset);
+  }
+}
+
+}  // anonymous namespace
+
+// static
+Entry Entry::Decode(uint16_t value) {
+  return Entry(static_cast<Outcome>(value & ((1 << kOutcomeBits) - 1)),
+               value >> kOutcomeBits);
+}
+
+uint16_t Entry::Encode() const {
+  DCHECK_LT(distance, 1 << (16 - kOutcomeBits));
+  return (distance << kOutcomeBits) | outcome;
+}
+
+bool Entry::operator==(const Entry& other) const {
+  return outcome == other.outcome && distance == other.distance;
+}
+
+std::string GetTableFileName(const game::GameOptions& options,
+                             const Material& material) {
+  std::ostringstream name;
+  switch (options.game_type()) {
+    case game::THREE_MEN_MORRIS:
+      name << "three";
+      break;
+    case game::SIX_MEN_MORRIS:
+      name << "six";
+      break;
+    case game::NINE_MEN_MORRIS:
+      name << "nine";
+      break;
+  }
+  name << (options.jumps_allowed() ? "_jumps_" : "_") << material.mover_on_board
+       << "_" << material.mover_in_hand << "_" << material.opponent_on_board
+       << "_" << material.opponent_in_hand << kTableFileExtension;
+  return name.str();
+}
+
+bool WriteTable(const base::FilePath& path,
+                const game::GameOptions& options,
+                const Material& material,
+                const std::vector<uint16_t>& entries) {
+  DCHECK_EQ(GetPositionCount(options.game_type(), material), entries.size());
+  uint16_t max_value = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    max_value |= entries[i];
+  }
+  int entry_bits = kOutcomeBits;
+  while (max_value >> entry_bits) {
+    ++entry_bits;
+  }
+  std::vector<uint64_t> words(GetWordCount(entries.size(), entry_bits), 0);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    SetPackedEntry(entry_bits, i, entries[i], &words);
+  }
+  TableHeader header = TableHeader();
+  header.magic = kTableMagic;
+  header.version = kTableVersion;
+  header.game_type = options.game_type();
+  header.jumps_allowed = options.jumps_allowed();
+  header.mover_on_board = material.mover_on_board;
+  header.mover_in_hand = material.mover_in_hand;
+  header.opponent_on_board = material.opponent_on_board;
+  header.opponent_in_hand = material.opponent_in_hand;
+  header.entry_bits = entry_bits;
+  header.position_count = entries.size();
+  header.data_checksum = words.empty() ? base::ComputeChecksum(NULL, 0) :
+      base::ComputeChecksum(&words[0], words.size() * sizeof(words[0]));
+  header.header_checksum =
+      base::ComputeChecksum(&header, offsetof(TableHeader, header_checksum));
+  std::ofstream out(path.value().c_str(),
+                    std::ios_base::out | std::ios_base::binary);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!words.empty()) {
+    out.write(reinterpret_cast<const char*>(&words[0]),
+              words.size() * sizeof(words[0]));
+  }
+  out.close();
+  return out.good();
+}
+
+Tablebase::Tablebase(const game::GameOptions& options) : options_(options) {}
+
+Tablebase::~Tablebase() {
+  for (TableMap::iterator it = tables_.begin(); it != tables_.end(); ++it) {
+    delete it->second.file;
+  }
+}
+
+int Tablebase::Load(const base::FilePath& dir) {
+  std::vector<base::FilePath> contents;
+  dir.GetDirContents(&contents);
+  const std::string extension(kTableFileExtension);
+  int loaded_tables = 0;
+  for (size_t i = 0; i < contents.size(); ++i) {
+    const std::string name(contents[i].BaseName().value());
+    if (name.size() > extension.size() &&
+        name.compare(name.size() - extension.size(), extension.size(),
+                     extension) == 0 &&
+        LoadTable(contents[i])) {
+      ++loaded_tables;
+    }
+  }
+  return loaded_tables;
+}
+
+bool Tablebase::Probe(const GameState& state, Entry* entry) const {
+  const Material material(Material::FromState(state));
+  if (material.mover_pieces() <= 2) {
+    *entry = Entry(LOSS, 0);
+    return true;
+  }
+  TableMap::const_iterator it = tables_.find(material);
+  if (it == tables_.end()) {
+    return false;
+  }
+  *entry = Entry::Decode(GetPackedEntry(it->second.words,
+                                        it->second.entry_bits,
+                                        GetPositionIndex(state)));
+  return true;
+}
+
+bool Tablebase::HasMaterial(const Material& material) const {
+  return tables_.count(material) > 0;
+}
+
+bool Tablebase::VerifyChecksums() const {
+  for (TableMap::const_iterator it = tables_.begin(); it != tables_.end();
+       ++it) {
+    const Table& table = it->second;
+    if (table.checksum != base::ComputeChecksum(
+            table.words, table.word_count * sizeof(table.words[0]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Tablebase::LoadTable(const base::FilePath& path) {
+  base::MemoryMappedFile* file = new base::MemoryMappedFile;
+  if (!file->Initialize(path) || file->length() < sizeof(TableHeader)) {
+    delete file;
+    return false;
+  }
+  const TableHeader& header =
+      *reinterpret_cast<const TableHeader*>(file->data());
+  if (header.magic != kTableMagic || header.version != kTableVersion ||
+      header.game_type != options_.game_type() ||
+      (header.jumps_allowed != 0) != options_.jumps_allowed()) {
+    delete file;
+    return false;
+  }
+  const Material material(header.mover_on_board, header.mover_in_hand,
+                          header.opponent_on_board, header.opponent_in_hand);
+  const size_t word_count =
+      GetWordCount(header.position_count, header.entry_bits);
+  if (header.header_checksum != base::ComputeChecksum(
+          &header, offsetof(TableHeader, header_checksum)) ||
+      header.position_count !=
+      GetPositionCount(options_.game_type(), material) ||
+      header.entry_bits < kOutcomeBits || header.entry_bits > 16 ||
+      file->length() != sizeof(header) + word_count * sizeof(uint64_t)) {
+    ELOG(ERROR) << "Invalid tablebase file " << path.value();
+    delete file;
+    return false;
+  }
+  TableMap::iterator it = tables_.find(material);
+  if (it != tables_.end()) {
+    delete it->second.file;
+  }
+  Table& table = tables_[material];
+  table.entry_bits = header.entry_bits;
+  table.words = reinterpret_cast<const uint64_t*>(file->data() +
+                                                  sizeof(header));
+  table.word_count = word_count;
+  table.checksum = header.data_checksum;
+  table.file = file;
+  return true;
+}
+
+}  // namespace tablebase
+}  // namespace ai
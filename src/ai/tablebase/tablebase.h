@@ -0,0 +1,124 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_TABLEBASE_TABLEBASE_H_
+#define AI_TABLEBASE_TABLEBASE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "ai/tablebase/position_index.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+#include "base/memory_mapped_file.h"
+#include "game/game_options.h"
+
+namespace ai {
+namespace tablebase {
+
+// The result of a solved position for the player to move.
+enum Outcome {
+  DRAW,
+  WIN,
+  LOSS
+};
+
+// The value of a solved position. For won and lost positions, |distance| is
+// the number of moves until the end of the game if both players play
+// perfectly: the winner chooses the shortest win and the loser the longest
+// loss. A position in which the player to move already lost is a LOSS at
+// distance zero.
+struct AI_EXPORT Entry {
+  Entry() : outcome(DRAW), distance(0) {}
+  Entry(Outcome outcome, int distance)
+      : outcome(outcome), distance(distance) {}
+
+  // The entries are stored as 16-bit values: the outcome in the lowest two bits
+  // and the distance in the others.
+  static Entry Decode(uint16_t value);
+  uint16_t Encode() const;
+
+  bool operator==(const Entry& other) const;
+
+  Outcome outcome;
+  int distance;
+};
+
+// Returns the name of the file that stores the solved positions with the
+// given |material| for the game described by |options|.
+AI_EXPORT std::string GetTableFileName(const game::GameOptions& options,
+                                       const Material& material);
+
+// Writes the encoded |entries| of all the positions with the given |material|
+// to |path|. Each entry is packed on as few bits as needed for the largest
+// distance from the class. Returns false if the file could not be written.
+AI_EXPORT bool WriteTable(const base::FilePath& path,
+                          const game::GameOptions& options,
+                          const Material& material,
+                          const std::vector<uint16_t>& entries);
+
+// An endgame tablebase: the solved positions of one or more material classes,
+// as written by the TablebaseGenerator. The positions are probed with any
+// color to move. Probe() does not change the tablebase, so it can be called
+// from multiple threads.
+//
+// The tables are memory-mapped and probed in place: loading a table only
+// reads its header, and its pages are shared by all the processes that load
+// it. The index of a position inside its class (see GetPositionIndex()) is a
+// minimal perfect hash, so each table only stores the packed entries.
+class AI_EXPORT Tablebase {
+ public:
+  explicit Tablebase(const game::GameOptions& options);
+  ~Tablebase();
+
+  // Loads all the tables from |dir| that were generated for the same game
+  // options. Returns the number of tables that were loaded.
+  int Load(const base::FilePath& dir);
+
+  // Returns true and fills in |entry| if |state| is solved by this tablebase.
+  // The positions in which the player to move has less than three pieces are
+  // always solved, as losses at distance zero.
+  bool Probe(const GameState& state, Entry* entry) const;
+
+  // Returns true if the positions with the given |material| are solved.
+  bool HasMaterial(const Material& material) const;
+
+  // Returns true if the entries of all the loaded tables match the checksums
+  // stored in their headers. This reads all the tables, so it is not done by
+  // Load().
+  bool VerifyChecksums() const;
+
+  size_t table_count() const { return tables_.size(); }
+
+ private:
+  // The packed entries of one material class, which point into |file|.
+  struct Table {
+    int entry_bits;
+    const uint64_t* words;
+    size_t word_count;
+    uint64_t checksum;
+    base::MemoryMappedFile* file;
+  };
+
+  typedef std::map<Material, Table> TableMap;
+
+  // Maps the table from |path|. Returns false if it is not a valid table for
+  // |options_|.
+  bool LoadTable(const base::FilePath& path);
+
+  const game::GameOptions options_;
+  TableMap tables_;
+
+  DISALLOW_COPY_AND_ASSIGN(Tablebase);
+};
+
+}  // namespace tablebase
+}  // namespace ai
+
+#endif  // AI_TABLEBASE_TABLEBASE_H_
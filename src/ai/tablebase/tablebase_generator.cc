@@ -0,0 +1,281 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ai/tablebase/tablebase_generator.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ai/bitboard.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "ai/tablebase/position_index.h"
+#include "ai/tablebase/tablebase.h"
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/location.h"
+#include "base/log.h"
+#include "base/method.h"
+#include "base/string_util.h"
+#include "base/threading/thread.h"
+#include "game/game.h"
+#include "game/game_options.h"
+
+namespace ai {
+namespace tablebase {
+namespace {
+
+// The passes over classes with fewer unsolved positions than this are not
+// split between threads.
+const size_t kMinPositionsPerThread = 256;
+
+// The order in which the classes are solved: a class is solved after all the
+// classes that can be reached from it, except for its own group.
+bool IsSolvedBefore(const Material& a, const Material& b) {
+  const int a_in_hand = a.mover_in_hand + a.opponent_in_hand;
+  const int b_in_hand = b.mover_in_hand + b.opponent_in_hand;
+  if (a_in_hand != b_in_hand) {
+    return a_in_hand < b_in_hand;
+  }
+  const int a_pieces = a.mover_pieces() + a.opponent_pieces();
+  const int b_pieces = b.mover_pieces() + b.opponent_pieces();
+  if (a_pieces != b_pieces) {
+    return a_pieces < b_pieces;
+  }
+  return a < b;
+}
+
+// Returns the class of the positions reached by sliding a piece from the
+// positions with the given |material|.
+Material GetSlideMaterial(const Material& material) {
+  return Material(material.opponent_on_board, material.opponent_in_hand,
+                  material.mover_on_board, material.mover_in_hand);
+}
+
+}  // anonymous namespace
+
+struct TablebaseGenerator::WorkItem {
+  WorkItem(const Material& material, const std::vector<uint32_t>* unsolved,
+           size_t begin, size_t end, int pass)
+      : material(material),
+        unsolved(unsolved),
+        begin(begin),
+        end(end),
+        pass(pass) {}
+
+  Material material;
+  const std::vector<uint32_t>* unsolved;
+  size_t begin;
+  size_t end;
+  int pass;
+
+  // The indices of the positions solved by this item and their entries.
+  std::vector<std::pair<uint32_t, uint16_t> > solved;
+};
+
+TablebaseGenerator::TablebaseGenerator(const game::GameOptions& options,
+                                       int thread_count)
+    : options_(options),
+      thread_count_(thread_count),
+      tree_(options_),
+      max_distance_(0) {
+  DCHECK(thread_count > 0);
+}
+
+TablebaseGenerator::~TablebaseGenerator() {}
+
+void TablebaseGenerator::Solve(int max_pieces) {
+  const game::GameType game_type = options_.game_type();
+  max_pieces = std::min(
+      max_pieces, game::Game::GetInitialPieceCountByGameType(game_type));
+  std::vector<Material> materials;
+  for (int mover = 3; mover <= max_pieces; ++mover) {
+    for (int opponent = 3; opponent <= max_pieces; ++opponent) {
+      // The players place their pieces in turns, so the player to move has
+      // either as many pieces in hand as the opponent, or one more.
+      for (int opponent_in_hand = 0; opponent_in_hand <= opponent;
+           ++opponent_in_hand) {
+        for (int extra = 0; extra <= 1; ++extra) {
+          const int mover_in_hand = opponent_in_hand + extra;
+          const Material material(mover - mover_in_hand, mover_in_hand,
+                                  opponent - opponent_in_hand,
+                                  opponent_in_hand);
+          if (mover_in_hand <= mover &&
+              GetPositionCount(game_type, material) > 0 &&
+              !entries_.count(material)) {
+            materials.push_back(material);
+          }
+        }
+      }
+    }
+  }
+  std::sort(materials.begin(), materials.end(), IsSolvedBefore);
+  for (size_t i = 0; i < materials.size(); ++i) {
+    if (entries_.count(materials[i])) {
+      continue;
+    }
+    std::vector<Material> group(1, materials[i]);
+    if (materials[i].mover_in_hand == 0) {
+      // The classes reached by sliding a piece are solved together.
+      const Material slide_material = GetSlideMaterial(materials[i]);
+      if (!(slide_material == materials[i])) {
+        group.push_back(slide_material);
+      }
+    }
+    SolveGroup(group);
+  }
+}
+
+Entry TablebaseGenerator::GetEntry(const GameState& state) const {
+  return Entry::Decode(GetEncodedEntry(state));
+}
+
+bool TablebaseGenerator::Write(const base::FilePath& dir) const {
+  bool result = true;
+  for (EntryMap::const_iterator it = entries_.begin(); it != entries_.end();
+       ++it) {
+    const base::FilePath path(
+        dir.Append(GetTableFileName(options_, it->first)));
+    if (!WriteTable(path, options_, it->first, it->second)) {
+      ELOG(ERROR) << "Could not write " << path.value();
+      result = false;
+    }
+  }
+  return result;
+}
+
+void TablebaseGenerator::SolveGroup(const std::vector<Material>& group) {
+  const game::GameType game_type = options_.game_type();
+  std::vector<std::vector<uint32_t> > unsolved(group.size());
+  for (size_t i = 0; i < group.size(); ++i) {
+    const uint64_t position_count = GetPositionCount(game_type, group[i]);
+    DCHECK(position_count <= std::numeric_limits<uint32_t>::max());
+    entries_[group[i]].assign(position_count, 0);
+    unsolved[i].resize(position_count);
+    for (uint64_t index = 0; index < position_count; ++index) {
+      unsolved[i][index] = index;
+    }
+    materials_.push_back(group[i]);
+  }
+  // If the group does not lead to itself (i.e. the player to move places a
+  // piece), all the positions are solved by one pass that can use any
+  // distance.
+  const bool single_pass = group[0].mover_in_hand > 0;
+  int group_max_distance = 0;
+  for (int pass = 0; ; ++pass) {
+    std::vector<WorkItem*> items;
+    for (size_t i = 0; i < group.size(); ++i) {
+      const size_t size = unsolved[i].size();
+      const size_t item_count = std::max<size_t>(1, std::min<size_t>(
+          thread_count_, size / kMinPositionsPerThread));
+      for (size_t k = 0; k < item_count; ++k) {
+        items.push_back(new WorkItem(group[i], &unsolved[i],
+            size * k / item_count, size * (k + 1) / item_count,
+            single_pass ? std::numeric_limits<int>::max() : pass));
+      }
+    }
+    if (thread_count_ == 1 || items.size() == 1) {
+      for (size_t i = 0; i < items.size(); ++i) {
+        RunPass(items[i]);
+      }
+    } else {
+      std::vector<base::threading::Thread*> threads;
+      for (size_t i = 0; i < items.size(); ++i) {
+        threads.push_back(new base::threading::Thread(
+            "Tablebase generator " + base::ToString(i)));
+        threads.back()->Start();
+        threads.back()->SubmitTask(FROM_HERE,
+            base::Bind(new base::Method<void(TablebaseGenerator::*)(
+                WorkItem*)>(&TablebaseGenerator::RunPass), this, items[i]));
+      }
+      for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->SubmitQuitTaskAndJoin();
+        delete threads[i];
+      }
+    }
+    // The entries are only updated after the pass is complete, so all the
+    // threads see the same entries.
+    bool progress = false;
+    for (size_t i = 0; i < items.size(); ++i) {
+      std::vector<uint16_t>& entries = entries_[items[i]->material];
+      const std::vector<std::pair<uint32_t, uint16_t> >& solved =
+          items[i]->solved;
+      for (size_t k = 0; k < solved.size(); ++k) {
+        entries[solved[k].first] = solved[k].second;
+        group_max_distance = std::max(
+            group_max_distance, Entry::Decode(solved[k].second).distance);
+      }
+      progress |= !solved.empty();
+      delete items[i];
+    }
+    for (size_t i = 0; i < group.size(); ++i) {
+      const std::vector<uint16_t>& entries = entries_[group[i]];
+      std::vector<uint32_t>::iterator end = unsolved[i].begin();
+      for (size_t k = 0; k < unsolved[i].size(); ++k) {
+        if (!entries[unsolved[i][k]]) {
+          *end++ = unsolved[i][k];
+        }
+      }
+      unsolved[i].erase(end, unsolved[i].end());
+    }
+    // The unsolved positions that lead to the other classes are solved by
+    // the pass that reaches their distance, which is at most one more than
+    // the largest distance of those classes.
+    if (single_pass || (!progress && pass > max_distance_)) {
+      break;
+    }
+  }
+  max_distance_ = std::max(max_distance_, group_max_distance);
+}
+
+void TablebaseGenerator::RunPass(WorkItem* item) {
+  const game::GameType game_type = options_.game_type();
+  SuccessorBuffer successors;
+  for (size_t i = item->begin; i < item->end; ++i) {
+    const uint32_t index = (*item->unsolved)[i];
+    const GameState state(GetPosition(game_type, item->material, index));
+    successors.clear();
+    tree_.GenerateSuccessors(state, &successors);
+    bool has_winning_move = false;
+    int shortest_win = std::numeric_limits<int>::max();
+    int longest_loss = 0;
+    bool all_moves_lose = true;
+    for (int k = 0; k < successors.size(); ++k) {
+      const Entry entry(GetEntry(successors[k]));
+      if (entry.outcome == LOSS) {
+        has_winning_move = true;
+        shortest_win = std::min(shortest_win, entry.distance + 1);
+      } else if (entry.outcome == WIN) {
+        longest_loss = std::max(longest_loss, entry.distance + 1);
+      } else {
+        all_moves_lose = false;
+      }
+    }
+    if (has_winning_move && shortest_win <= item->pass) {
+      item->solved.push_back(
+          std::make_pair(index, Entry(WIN, shortest_win).Encode()));
+    } else if (all_moves_lose && longest_loss <= item->pass) {
+      item->solved.push_back(
+          std::make_pair(index, Entry(LOSS, longest_loss).Encode()));
+    }
+  }
+}
+
+uint16_t TablebaseGenerator::GetEncodedEntry(const GameState& state) const {
+  const Material material(Material::FromState(state));
+  if (material.mover_pieces() <= 2) {
+    return Entry(LOSS, 0).Encode();
+  }
+  EntryMap::const_iterator it = entries_.find(material);
+  DCHECK(it != entries_.end());
+  return it->second[GetPositionIndex(state)];
+}
+
+}  // namespace tablebase
+}  // namespace ai
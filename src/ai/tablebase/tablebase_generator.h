@@ -0,0 +1,93 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef AI_TABLEBASE_TABLEBASE_GENERATOR_H_
+#define AI_TABLEBASE_TABLEBASE_GENERATOR_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "ai/ai_export.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "ai/tablebase/position_index.h"
+#include "ai/tablebase/tablebase.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+#include "game/game_options.h"
+
+namespace ai {
+namespace tablebase {
+
+// Solves all the positions in which each player has at most a given number of
+// pieces (on the board and in hand) using retrograde analysis.
+//
+// The material classes are solved in increasing order of the pieces in hand
+// and of the pieces on the board. A move either places a piece, which leads
+// to a class with fewer pieces in hand, or it removes a piece, which leads to
+// a class with fewer pieces, or it slides a piece, which leads to the class
+// with the same material seen by the other player. The classes that only
+// differ by which player is to move are solved together, in passes. The
+// positions solved by pass N are the ones at distance N: the wins in which one
+// of the moves leads to a loss at distance N - 1, and the losses in which all
+// the moves lead to wins at distance at most N - 1. The positions that are
+// still unsolved when the passes stop making progress are draws.
+//
+// Each pass is split between the worker threads, which only read the entries
+// solved by the previous passes.
+class AI_EXPORT TablebaseGenerator {
+ public:
+  TablebaseGenerator(const game::GameOptions& options, int thread_count);
+  ~TablebaseGenerator();
+
+  // Solves all the classes in which each player has between three and
+  // |max_pieces| pieces. The classes that are already solved are skipped.
+  void Solve(int max_pieces);
+
+  // Returns the entry of |state|, whose material class must be solved.
+  Entry GetEntry(const GameState& state) const;
+
+  // The solved material classes, in the order in which they were solved.
+  const std::vector<Material>& materials() const { return materials_; }
+
+  // Writes one file for each solved class to |dir|. Returns false if any of
+  // the files could not be written.
+  bool Write(const base::FilePath& dir) const;
+
+ private:
+  // The range of unsolved positions examined by one thread in one pass.
+  struct WorkItem;
+
+  typedef std::map<Material, std::vector<uint16_t> > EntryMap;
+
+  // Solves the classes from |group|, which only lead to each other and to the
+  // classes that are already solved.
+  void SolveGroup(const std::vector<Material>& group);
+
+  // Examines the positions from |item| and records the ones that are solved.
+  void RunPass(WorkItem* item);
+
+  // Returns the encoded entry of |state| if its class is solved, or 0 (a draw)
+  // if the state is not solved yet.
+  uint16_t GetEncodedEntry(const GameState& state) const;
+
+  const game::GameOptions options_;
+  const int thread_count_;
+  GameStateTree tree_;
+
+  EntryMap entries_;
+  std::vector<Material> materials_;
+
+  // The largest distance of all the solved entries.
+  int max_distance_;
+
+  DISALLOW_COPY_AND_ASSIGN(TablebaseGenerator);
+};
+
+}  // namespace tablebase
+}  // namespace ai
+
+#endif  // AI_TABLEBASE_TABLEBASE_GENERATOR_H_
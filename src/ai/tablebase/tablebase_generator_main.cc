@@ -0,0 +1,122 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Solves the endgames of a morris game and writes the tables that can be
+// loaded by ai::tablebase::Tablebase.
+
+#ifdef ENABLE_DCHECK
+#undef ENABLE_DCHECK
+#endif
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ai/tablebase/position_index.h"
+#include "ai/tablebase/tablebase_generator.h"
+#include "base/command_line.h"
+#include "base/debug/stacktrace.h"
+#include "base/file_path.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+
+namespace {
+
+const char kGameTypeSwitch[] = "--game-type";
+const char kNoJumpsSwitch[] = "--no-jumps";
+const char kMaxPiecesSwitch[] = "--max-pieces";
+const char kOutputDirSwitch[] = "--output-dir";
+const char kThreadsSwitch[] = "--threads";
+const char kHelpSwitch[] = "--help";
+
+const int kDefaultMaxPieces = 3;
+
+void Usage() {
+  std::cout << "Possible command line options:" << std::endl;
+  std::cout << "\t" << kGameTypeSwitch << "=3|6|9" << std::endl;
+  std::cout << "\t\t" << "Specifies the game type: three/six/nine men morris."
+            << std::endl;
+  std::cout << "\t" << kNoJumpsSwitch << std::endl;
+  std::cout << "\t\t" << "Solves the game in which the players with three "
+            << "pieces cannot jump." << std::endl;
+  std::cout << "\t" << kMaxPiecesSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "Solves the positions in which each player has at "
+            << "most this many pieces. Default: " << kDefaultMaxPieces << "."
+            << std::endl;
+  std::cout << "\t" << kOutputDirSwitch << "=<path>" << std::endl;
+  std::cout << "\t\t" << "The directory where the tables are written. "
+            << "Default: the current directory." << std::endl;
+  std::cout << "\t" << kThreadsSwitch << "=<count>" << std::endl;
+  std::cout << "\t\t" << "The number of worker threads. Default: the number "
+            << "of cores." << std::endl;
+  std::cout << "\t" << kHelpSwitch << std::endl;
+  std::cout << "\t\t" << "Displays this help message and exits." << std::endl;
+}
+
+bool RunGenerator(const base::CommandLine& cmd_line) {
+  game::GameOptions options;
+  if (cmd_line.HasSwitch(kGameTypeSwitch)) {
+    const std::string game_type(cmd_line.GetSwitchValue(kGameTypeSwitch));
+    if (game_type == "3") {
+      options.set_game_type(game::THREE_MEN_MORRIS);
+    } else if (game_type == "6") {
+      options.set_game_type(game::SIX_MEN_MORRIS);
+    } else if (game_type == "9") {
+      options.set_game_type(game::NINE_MEN_MORRIS);
+    } else {
+      Usage();
+      return false;
+    }
+  }
+  options.set_jumps_allowed(!cmd_line.HasSwitch(kNoJumpsSwitch));
+  int max_pieces = kDefaultMaxPieces;
+  if (cmd_line.HasSwitch(kMaxPiecesSwitch)) {
+    max_pieces = std::atoi(cmd_line.GetSwitchValue(kMaxPiecesSwitch).c_str());
+  }
+  int thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cmd_line.HasSwitch(kThreadsSwitch)) {
+    thread_count = std::atoi(cmd_line.GetSwitchValue(kThreadsSwitch).c_str());
+  }
+  base::FilePath output_dir(base::FilePath::CurrentDir());
+  if (cmd_line.HasSwitch(kOutputDirSwitch)) {
+    output_dir = base::FilePath(cmd_line.GetSwitchValue(kOutputDirSwitch));
+  }
+  if (max_pieces < 3 || thread_count < 1 || !output_dir.IsDir()) {
+    Usage();
+    return false;
+  }
+  ai::tablebase::TablebaseGenerator generator(options, thread_count);
+  generator.Solve(max_pieces);
+  const std::vector<ai::tablebase::Material>& materials =
+      generator.materials();
+  for (size_t i = 0; i < materials.size(); ++i) {
+    std::cout << "Solved " << materials[i].mover_on_board << "+"
+              << materials[i].mover_in_hand << " vs "
+              << materials[i].opponent_on_board << "+"
+              << materials[i].opponent_in_hand << ": "
+              << ai::tablebase::GetPositionCount(options.game_type(),
+                                                 materials[i])
+              << " positions" << std::endl;
+  }
+  return generator.Write(output_dir);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  base::debug::EnableStackTraceDumpOnCrash();
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  cmd_line->Init(argc, argv);
+  bool result = true;
+  if (cmd_line->HasSwitch(kHelpSwitch)) {
+    Usage();
+  } else {
+    result = RunGenerator(*cmd_line);
+  }
+  base::CommandLine::DeleteForCurrentProcess();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
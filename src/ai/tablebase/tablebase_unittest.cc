@@ -0,0 +1,186 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/game_state.h"
+#include "ai/game_state_tree.h"
+#include "ai/tablebase/position_index.h"
+#include "ai/tablebase/tablebase.h"
+#include "ai/tablebase/tablebase_generator.h"
+#include "base/basic_macros.h"
+#include "base/file_util.h"
+#include "game/game.h"
+#include "game/game_options.h"
+#include "game/game_type.h"
+#include "game/piece_color.h"
+#include "game/player_action.h"
+#include "gtest/gtest.h"
+
+namespace ai {
+namespace tablebase {
+namespace {
+
+// Returns the entry of |state| computed from the entries of its successors.
+Entry GetExpectedEntry(const TablebaseGenerator& generator,
+                       const GameStateTree& tree,
+                       const GameState& state) {
+  SuccessorBuffer successors;
+  tree.GenerateSuccessors(state, &successors);
+  bool has_winning_move = false;
+  bool has_drawing_move = false;
+  int shortest_win = 0;
+  int longest_loss = 0;
+  for (int i = 0; i < successors.size(); ++i) {
+    const Entry entry(generator.GetEntry(successors[i]));
+    if (entry.outcome == LOSS) {
+      shortest_win = has_winning_move ?
+          std::min(shortest_win, entry.distance + 1) : entry.distance + 1;
+      has_winning_move = true;
+    } else if (entry.outcome == WIN) {
+      longest_loss = std::max(longest_loss, entry.distance + 1);
+    } else {
+      has_drawing_move = true;
+    }
+  }
+  if (has_winning_move) {
+    return Entry(WIN, shortest_win);
+  }
+  return has_drawing_move ? Entry(DRAW, 0) : Entry(LOSS, longest_loss);
+}
+
+TEST(Tablebase, Entry) {
+  const Entry entries[] = {
+    Entry(), Entry(WIN, 1), Entry(LOSS, 0), Entry(LOSS, 1000)
+  };
+  for (size_t i = 0; i < arraysize(entries); ++i) {
+    EXPECT_EQ(entries[i], Entry::Decode(entries[i].Encode()));
+  }
+  // Unsolved positions are draws.
+  EXPECT_EQ(Entry(DRAW, 0), Entry::Decode(0));
+}
+
+TEST(Tablebase, ThreeMenMorris) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  TablebaseGenerator generator(options, 1);
+  generator.Solve(3);
+  GameStateTree tree(options);
+  const std::vector<Material>& materials = generator.materials();
+  ASSERT_FALSE(materials.empty());
+  bool has_wins = false;
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const uint64_t count =
+        GetPositionCount(options.game_type(), materials[i]);
+    for (uint64_t index = 0; index < count; ++index) {
+      const GameState state(
+          GetPosition(options.game_type(), materials[i], index));
+      const Entry entry(generator.GetEntry(state));
+      EXPECT_EQ(GetExpectedEntry(generator, tree, state), entry);
+      has_wins |= entry.outcome == WIN;
+    }
+  }
+  EXPECT_TRUE(has_wins);
+  // The multithreaded generator solves the same positions.
+  TablebaseGenerator parallel_generator(options, 4);
+  parallel_generator.Solve(3);
+  EXPECT_EQ(materials, parallel_generator.materials());
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const uint64_t count =
+        GetPositionCount(options.game_type(), materials[i]);
+    for (uint64_t index = 0; index < count; ++index) {
+      const GameState state(
+          GetPosition(options.game_type(), materials[i], index));
+      EXPECT_EQ(generator.GetEntry(state), parallel_generator.GetEntry(state));
+    }
+  }
+}
+
+TEST(Tablebase, WriteAndLoad) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  TablebaseGenerator generator(options, 4);
+  generator.Solve(3);
+  base::ScopedTempDir temp_dir("tablebase_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  ASSERT_TRUE(generator.Write(temp_dir.Get()));
+  // The tables of other game options are ignored.
+  game::GameOptions no_jumps_options(options);
+  no_jumps_options.set_jumps_allowed(false);
+  Tablebase no_jumps_tablebase(no_jumps_options);
+  EXPECT_EQ(0, no_jumps_tablebase.Load(temp_dir.Get()));
+  Tablebase tablebase(options);
+  const std::vector<Material>& materials = generator.materials();
+  EXPECT_EQ(static_cast<int>(materials.size()),
+            tablebase.Load(temp_dir.Get()));
+  EXPECT_TRUE(tablebase.VerifyChecksums());
+  for (size_t i = 0; i < materials.size(); ++i) {
+    EXPECT_TRUE(tablebase.HasMaterial(materials[i]));
+    const uint64_t count =
+        GetPositionCount(options.game_type(), materials[i]);
+    for (uint64_t index = 0; index < count; index += count / 1000 + 1) {
+      const GameState state(
+          GetPosition(options.game_type(), materials[i], index));
+      Entry entry;
+      ASSERT_TRUE(tablebase.Probe(state, &entry));
+      EXPECT_EQ(generator.GetEntry(state), entry);
+    }
+  }
+  // Positions with more pieces are not solved.
+  EXPECT_FALSE(tablebase.HasMaterial(Material(4, 0, 3, 0)));
+  Entry entry;
+  EXPECT_FALSE(tablebase.Probe(
+      GetPosition(options.game_type(), Material(4, 0, 3, 0), 0), &entry));
+}
+
+TEST(Tablebase, MorrisAlphaBeta) {
+  game::GameOptions options;
+  options.set_game_type(game::THREE_MEN_MORRIS);
+  TablebaseGenerator generator(options, 1);
+  generator.Solve(3);
+  base::ScopedTempDir temp_dir("tablebase_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  ASSERT_TRUE(generator.Write(temp_dir.Get()));
+  Tablebase tablebase(options);
+  ASSERT_LT(0, tablebase.Load(temp_dir.Get()));
+  alphabeta::MorrisAlphaBeta alg(options);
+  alg.set_max_search_depth(4);
+  alg.set_tablebase(&tablebase);
+  // The game is played perfectly by both players, without searching.
+  const Entry entry(generator.GetEntry(GetPosition(
+      options.game_type(), Material(0, 3, 0, 3), 0)));
+  const int kMaxMoves = 100;
+  game::Game test_game(options);
+  test_game.Initialize();
+  const game::PieceColor first_player = test_game.current_player();
+  AIAlgorithm* const player = &alg;
+  int move_count = 0;
+  while (!test_game.is_game_over() && move_count < kMaxMoves) {
+    const game::PlayerAction action = player->GetNextAction(test_game);
+    EXPECT_EQ(0, alg.node_count());
+    ASSERT_TRUE(test_game.CanExecutePlayerAction(action));
+    test_game.ExecutePlayerAction(action);
+    // A move that closes a mill and the removal that follows it are stored
+    // as a single move in the tablebase.
+    if (action.type() != game::PlayerAction::REMOVE_PIECE) {
+      ++move_count;
+    }
+  }
+  if (entry.outcome == DRAW) {
+    EXPECT_FALSE(test_game.is_game_over());
+  } else {
+    ASSERT_TRUE(test_game.is_game_over());
+    EXPECT_EQ(entry.distance, move_count);
+    EXPECT_EQ(entry.outcome == WIN, test_game.winner() == first_player);
+  }
+}
+
+}  // anonymous namespace
+}  // namespace tablebase
+}  // namespace ai
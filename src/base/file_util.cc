@@ -52,9 +52,9 @@ bool ScopedTempDir::Create() {
     dir_name = FilePath(name_prefix_);
   }
 
-  const FilePath full_path = FilePath(tmp_dir).Append(dir_name);
-  char* path = const_cast<char*>(full_path.value().c_str());
-  path = mkdtemp(path);
+  // mkdtemp() changes the template in place, so it needs its own buffer.
+  std::string full_path = FilePath(tmp_dir).Append(dir_name).value();
+  char* path = mkdtemp(&full_path[0]);
   if (!path) {
     ELOG(ERROR) << "Could not create temporary folder";
     return false;
@@ -0,0 +1,67 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory_mapped_file.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "base/file_path.h"
+#include "base/log.h"
+
+namespace base {
+namespace {
+
+const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+
+}  // anonymous namespace
+
+MemoryMappedFile::MemoryMappedFile() : data_(NULL), length_(0) {}
+
+MemoryMappedFile::~MemoryMappedFile() {
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), length_);
+  }
+}
+
+bool MemoryMappedFile::Initialize(const FilePath& path) {
+  DCHECK(!data_);
+  const int fd = open(path.value().c_str(), O_RDONLY);
+  if (fd < 0) {
+    ELOG(ERROR) << "Could not open " << path.value();
+    return false;
+  }
+  struct stat file_info;
+  bool result = false;
+  if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+    void* const data = mmap(NULL, file_info.st_size, PROT_READ, MAP_SHARED, fd,
+                            0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<const uint8_t*>(data);
+      length_ = file_info.st_size;
+      result = true;
+    } else {
+      ELOG(ERROR) << "Could not map " << path.value();
+    }
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+  return result;
+}
+
+uint64_t ComputeChecksum(const void* data, size_t size) {
+  const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = kFnvOffsetBasis;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+}  // namespace base
@@ -0,0 +1,51 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_MAPPED_FILE_H_
+#define BASE_MEMORY_MAPPED_FILE_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "base/base_export.h"
+#include "base/basic_macros.h"
+#include "base/file_path.h"
+
+namespace base {
+
+// A file mapped read-only into memory. The mapping is shared, so the pages of
+// a file that is mapped by several processes are only loaded once by the
+// operating system, and they are only loaded when they are first accessed.
+// Mapping a file takes the same time regardless of its size.
+class BASE_EXPORT MemoryMappedFile {
+ public:
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+
+  // Maps the file from |path|. Returns false if the file could not be opened
+  // or mapped. This can only be called once.
+  bool Initialize(const FilePath& path);
+
+  bool IsValid() const { return data_ != NULL; }
+
+  // The contents of the file. The data is aligned to the page size.
+  const uint8_t* data() const { return data_; }
+  size_t length() const { return length_; }
+
+ private:
+  const uint8_t* data_;
+  size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryMappedFile);
+};
+
+// Returns the 64-bit FNV-1a hash of the |size| bytes from |data|. It is used to
+// detect corrupted files.
+// http://en.wikipedia.org/wiki/Fowler-Noll-Vo_hash_function
+BASE_EXPORT uint64_t ComputeChecksum(const void* data, size_t size);
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_MAPPED_FILE_H_
@@ -0,0 +1,55 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory_mapped_file.h"
+#include "gtest/gtest.h"
+
+namespace base {
+namespace {
+
+TEST(MemoryMappedFile, Basic) {
+  ScopedTempDir temp_dir("memory_mapped_file_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  const FilePath file_path(temp_dir.Get().Append("file.bin"));
+  const std::string contents("Test contents");
+  {
+    std::ofstream out(file_path.value().c_str());
+    out << contents;
+  }
+  MemoryMappedFile file;
+  ASSERT_TRUE(file.Initialize(file_path));
+  ASSERT_TRUE(file.IsValid());
+  ASSERT_EQ(contents.size(), file.length());
+  EXPECT_EQ(0, std::memcmp(contents.data(), file.data(), contents.size()));
+}
+
+TEST(MemoryMappedFile, InvalidFiles) {
+  ScopedTempDir temp_dir("memory_mapped_file_unittest");
+  ASSERT_TRUE(temp_dir.Create());
+  MemoryMappedFile missing_file;
+  EXPECT_FALSE(missing_file.Initialize(temp_dir.Get().Append("missing")));
+  EXPECT_FALSE(missing_file.IsValid());
+  // Empty files cannot be mapped.
+  const FilePath empty_path(temp_dir.Get().Append("empty"));
+  std::ofstream(empty_path.value().c_str()).close();
+  MemoryMappedFile empty_file;
+  EXPECT_FALSE(empty_file.Initialize(empty_path));
+  EXPECT_FALSE(empty_file.IsValid());
+}
+
+TEST(MemoryMappedFile, Checksum) {
+  // The reference values of the 64-bit FNV-1a hash.
+  EXPECT_EQ(14695981039346656037ULL, ComputeChecksum("", 0));
+  EXPECT_EQ(0xaf63dc4c8601ec8cULL, ComputeChecksum("a", 1));
+  EXPECT_EQ(0x85944171f73967e8ULL, ComputeChecksum("foobar", 6));
+}
+
+}  // anonymous namespace
+}  // namespace base
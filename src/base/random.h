@@ -51,6 +51,37 @@ class BASE_EXPORT MersenneTwister32 {
   DISALLOW_COPY_AND_ASSIGN(MersenneTwister32);
 };
 
+// Small and fast pseudo random number generator that uses the xorshift64*
+// algorithm. Its state is a single 64-bit word, so it can be embedded in each
+// object that needs random numbers, e.g. in the players used for simulations.
+// https://en.wikipedia.org/wiki/Xorshift#xorshift*
+class BASE_EXPORT XorShift64Star {
+ public:
+  // The state must not be zero, so a zero |seed| is replaced by a constant.
+  explicit XorShift64Star(uint64_t seed = 88172645463325252ULL)
+      : state_(seed ? seed : 88172645463325252ULL) {}
+
+  // Returns the next unsigned 32-bit random number.
+  uint32_t Next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    // The high bits of the product are the best ones.
+    return static_cast<uint32_t>((state_ * 2685821657736338717ULL) >> 32);
+  }
+
+  // Returns a random number in the interval [0, |bound|). It uses a
+  // multiplication instead of a division, with a negligible bias for the
+  // small bounds used by the games.
+  uint32_t NextBelow(uint32_t bound) {
+    return static_cast<uint32_t>(
+        (static_cast<uint64_t>(Next()) * bound) >> 32);
+  }
+
+ private:
+  uint64_t state_;
+};
+
 // Utility function used to obtain a random number in the interval [0.0, |max|).
 BASE_EXPORT double Random(double max = 1.0);
 
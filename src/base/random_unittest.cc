@@ -61,5 +61,37 @@ TEST(Random, TwoGeneratorsWithSameSeed) {
   }
 }
 
+TEST(Random, XorShift64Star) {
+  // Expected for seed = 12345
+  const uint32_t expected_values[] = {
+    2555902770U, 275273349U, 243004396U, 2023026319U, 3948957576U
+  };
+  size_t index = 0;
+  XorShift64Star generator(12345U);
+  for (int i = 0; i < 1001; ++i) {
+    const uint32_t x = generator.Next();
+    if (i % 250 == 0) {
+      EXPECT_EQ(expected_values[index++], x) << i;
+    }
+  }
+  // The zero seed does not produce only zeros.
+  XorShift64Star zero_seed(0);
+  EXPECT_NE(0U, zero_seed.Next() | zero_seed.Next());
+}
+
+TEST(Random, XorShift64StarNextBelow) {
+  XorShift64Star generator;
+  int counts[7] = { 0 };
+  for (int i = 0; i < 7000; ++i) {
+    const uint32_t x = generator.NextBelow(7);
+    ASSERT_LT(x, 7U);
+    ++counts[x];
+  }
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_GT(counts[i], 800) << i;
+    EXPECT_LT(counts[i], 1200) << i;
+  }
+}
+
 }  // anonymous namespace
 }  // namespace base
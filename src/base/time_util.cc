@@ -0,0 +1,18 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/time_util.h"
+
+#include <time.h>
+
+namespace base {
+
+int64_t GetMonotonicTime() {
+  const int64_t sec_to_nano = 1000000000;
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * sec_to_nano + now.tv_nsec;
+}
+
+}  // namespace base
@@ -0,0 +1,20 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TIME_UTIL_H_
+#define BASE_TIME_UTIL_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+
+namespace base {
+
+// Returns the value of a monotonic clock in nanoseconds. Only the differences
+// between its values are meaningful.
+BASE_EXPORT int64_t GetMonotonicTime();
+
+}  // namespace base
+
+#endif  // BASE_TIME_UTIL_H_
@@ -0,0 +1,24 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include "base/time_util.h"
+#include "gtest/gtest.h"
+
+namespace base {
+namespace {
+
+TEST(TimeUtil, GetMonotonicTime) {
+  const int64_t start = GetMonotonicTime();
+  EXPECT_LE(start, GetMonotonicTime());
+  usleep(10000);
+  const int64_t elapsed = GetMonotonicTime() - start;
+  EXPECT_LE(10000000, elapsed);
+  EXPECT_GT(10000000000LL, elapsed);
+}
+
+}  // anonymous namespace
+}  // namespace base
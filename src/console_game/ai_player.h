@@ -29,10 +29,11 @@ class CONSOLE_GAME_EXPORT AIPlayer : public Player {
  public:
   AIPlayer(const std::string& name, std::auto_ptr<ai::AIAlgorithm> algorithm);
 
- private:
+ protected:
   // Player interface
   virtual std::string GetNextAction(game::Game* game_model);
 
+ private:
   // Stores a pointer to the AIAlgorithm used to get the next action.
   base::ptr::scoped_ptr<ai::AIAlgorithm> algorithm_;
 
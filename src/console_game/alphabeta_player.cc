@@ -0,0 +1,99 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "console_game/alphabeta_player.h"
+
+#include <stdint.h>
+
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ai/ai_algorithm.h"
+#include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/game_state.h"
+#include "game/game.h"
+#include "game/player_action.h"
+
+namespace console_game {
+namespace {
+
+using ai::GameState;
+using ai::alphabeta::MorrisAlphaBeta;
+
+// Writes |action| to |out| in a short format: "@a1" for placing a piece on
+// a1, "a1-a4" for moving a piece from a1 to a4 and "xa1" for removing the
+// piece from a1.
+void WriteAction(const game::PlayerAction& action, std::ostream* out) {
+  switch (action.type()) {
+    case game::PlayerAction::MOVE_PIECE:
+      *out << action.source() << "-" << action.destination();
+      break;
+    case game::PlayerAction::REMOVE_PIECE:
+      *out << "x" << action.source();
+      break;
+    case game::PlayerAction::PLACE_PIECE:
+      *out << "@" << action.destination();
+      break;
+  }
+}
+
+void WriteStatistics(
+    const GameState& origin,
+    const std::vector<MorrisAlphaBeta::IterationStatistics>& statistics,
+    std::ostream* out) {
+  // The status messages are used as printf formats, so they cannot contain
+  // percent signs.
+  *out << "\n\ndepth       nodes   time(ms) hit rate cut rate  branching"
+       << "       score  principal variation";
+  for (size_t i = 0; i < statistics.size(); ++i) {
+    const MorrisAlphaBeta::IterationStatistics& iteration = statistics[i];
+    const int64_t tt_probes = iteration.tt_hits + iteration.tt_misses;
+    *out << "\n" << std::setw(5) << iteration.depth
+         << std::setw(12) << iteration.node_count
+         << std::setw(11) << std::fixed << std::setprecision(1)
+         << iteration.time / 1e6
+         << std::setw(9) << std::setprecision(3)
+         << (tt_probes ? static_cast<double>(iteration.tt_hits) / tt_probes : 0)
+         << std::setw(9)
+         << (tt_probes ?
+             static_cast<double>(iteration.tt_cutoffs) / tt_probes : 0)
+         << std::setw(11) << std::setprecision(2)
+         << iteration.branching_factor()
+         << std::setw(12) << iteration.score << " ";
+    const std::vector<GameState>& variation = iteration.principal_variation;
+    for (size_t j = 0; j < variation.size(); ++j) {
+      const std::vector<game::PlayerAction> actions = GameState::GetTransition(
+          j ? variation[j - 1] : origin, variation[j]);
+      *out << " ";
+      for (size_t k = 0; k < actions.size(); ++k) {
+        WriteAction(actions[k], out);
+      }
+    }
+  }
+}
+
+}  // anonymous namespace
+
+AlphaBetaPlayer::AlphaBetaPlayer(const std::string& name,
+                                 std::auto_ptr<MorrisAlphaBeta> algorithm)
+    : AIPlayer(name, std::auto_ptr<ai::AIAlgorithm>(algorithm.get())),
+      alphabeta_(algorithm.release()) {
+}
+
+std::string AlphaBetaPlayer::GetNextAction(game::Game* game_model) {
+  GameState origin;
+  origin.Encode(*game_model);
+  std::string msg = AIPlayer::GetNextAction(game_model);
+  if (!alphabeta_->search_statistics().empty()) {
+    std::ostringstream statistics;
+    WriteStatistics(origin, alphabeta_->search_statistics(), &statistics);
+    msg += statistics.str();
+  }
+  return msg;
+}
+
+}  // namespace console_game
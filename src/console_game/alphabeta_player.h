@@ -0,0 +1,47 @@
+// Copyright (c) 2013 Cristian Patrasciuc. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONSOLE_GAME_ALPHABETA_PLAYER_H_
+#define CONSOLE_GAME_ALPHABETA_PLAYER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/basic_macros.h"
+#include "console_game/ai_player.h"
+#include "console_game/console_game_export.h"
+
+namespace ai {
+namespace alphabeta {
+class MorrisAlphaBeta;
+}
+}
+
+namespace game {
+class Game;
+}
+
+namespace console_game {
+
+// AI player that uses the MorrisAlphaBeta algorithm. If the search statistics
+// are enabled in the algorithm, the status message of each action that
+// required a search also contains the statistics of each iteration.
+class CONSOLE_GAME_EXPORT AlphaBetaPlayer : public AIPlayer {
+ public:
+  AlphaBetaPlayer(const std::string& name,
+                  std::auto_ptr<ai::alphabeta::MorrisAlphaBeta> algorithm);
+
+ private:
+  // Player interface
+  virtual std::string GetNextAction(game::Game* game_model);
+
+  // Owned by the base class.
+  const ai::alphabeta::MorrisAlphaBeta* const alphabeta_;
+
+  DISALLOW_COPY_AND_ASSIGN(AlphaBetaPlayer);
+};
+
+}  // namespace console_game
+
+#endif  // CONSOLE_GAME_ALPHABETA_PLAYER_H_
@@ -2,18 +2,25 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+
 #include <cstdlib>
+#include <ctime>
 #include <iostream>
 #include <memory>
 
 #include "ai/ai_algorithm.h"
 #include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/book/opening_book.h"
+#include "ai/mcts/mcts_algorithm.h"
 #include "ai/random/random_algorithm.h"
 #include "base/command_line.h"
 #include "base/debug/stacktrace.h"
+#include "base/file_path.h"
 #include "game/game_options.h"
 #include "game/game_type.h"
 #include "console_game/ai_player.h"
+#include "console_game/alphabeta_player.h"
 #include "console_game/console_game.h"
 #include "console_game/human_player.h"
 #include "console_game/player.h"
@@ -21,12 +28,15 @@
 namespace {
 
 using console_game::AIPlayer;
+using console_game::AlphaBetaPlayer;
 using console_game::HumanPlayer;
 using console_game::Player;
 
 const char kGameTypeSwitch[] = "--game-type";
 const char kWhitePlayerType[] = "--white-player";
 const char kBlackPlayerType[] = "--black-player";
+const char kSearchStatsSwitch[] = "--search-stats";
+const char kOpeningBookSwitch[] = "--opening-book";
 const char kHelpSwitch[] = "--help";
 
 void Usage() {
@@ -34,14 +44,20 @@ void Usage() {
   std::cout << "\t" << kGameTypeSwitch << "=3|6|9" << std::endl;
   std::cout << "\t\t" << "Specifies the game type: three/six/nine men morris."
             << std::endl;
-  std::cout << "\t" << kWhitePlayerType << "=human|random|alphabeta"
+  std::cout << "\t" << kWhitePlayerType << "=human|random|alphabeta|mcts"
             << std::endl;
   std::cout << "\t\t" << "Specifies the player type for the white color. "
             << "Default: human." << std::endl;
-  std::cout << "\t" << kBlackPlayerType << "=human|random|alphabeta"
+  std::cout << "\t" << kBlackPlayerType << "=human|random|alphabeta|mcts"
             << std::endl;
   std::cout << "\t\t" << "Specifies the player type for the black color. "
             << "Default: random (i.e. AI with RandomAlgorithm)." << std::endl;
+  std::cout << "\t" << kSearchStatsSwitch << std::endl;
+  std::cout << "\t\t" << "Displays the statistics of each search performed by "
+            << "the alphabeta players." << std::endl;
+  std::cout << "\t" << kOpeningBookSwitch << "=<path>" << std::endl;
+  std::cout << "\t\t" << "The opening book used by the alphabeta players, "
+            << "as written by ai_book_builder." << std::endl;
   std::cout << "\t" << kHelpSwitch << std::endl;
   std::cout << "\t\t" << "Displays this help message and exits." << std::endl;
 }
@@ -49,7 +65,9 @@ void Usage() {
 std::auto_ptr<Player> GetPlayerFromCmdLine(const base::CommandLine& cmd_line,
                                            const std::string& switch_name,
                                            const std::string& default_type,
-                                           const game::GameOptions& options) {
+                                           const game::GameOptions& options,
+                                           const ai::book::OpeningBook* book,
+                                           uint64_t seed) {
   std::string player_type = default_type;
   if (cmd_line.HasSwitch(switch_name)) {
     player_type = cmd_line.GetSwitchValue(switch_name);
@@ -61,10 +79,21 @@ std::auto_ptr<Player> GetPlayerFromCmdLine(const base::CommandLine& cmd_line,
     player = human_player;
   } else if (player_type == "random") {
     player = new AIPlayer("RandomAI",
-        std::auto_ptr<ai::AIAlgorithm>(new ai::random::RandomAlgorithm()));
+        std::auto_ptr<ai::AIAlgorithm>(new ai::random::RandomAlgorithm(seed)));
   } else if (player_type == "alphabeta") {
-    player = new AIPlayer("AlphaBeta", std::auto_ptr<ai::AIAlgorithm>(
-        new ai::alphabeta::MorrisAlphaBeta(options)));
+    std::auto_ptr<ai::alphabeta::MorrisAlphaBeta> algorithm(
+        new ai::alphabeta::MorrisAlphaBeta(options));
+    algorithm->set_search_statistics_enabled(
+        cmd_line.HasSwitch(kSearchStatsSwitch));
+    algorithm->set_opening_book(book);
+    algorithm->set_seed(seed);
+    player = new AlphaBetaPlayer("AlphaBeta", algorithm);
+  } else if (player_type == "mcts") {
+    std::auto_ptr<ai::mcts::MctsAlgorithm> algorithm(
+        new ai::mcts::MctsAlgorithm(options));
+    algorithm->set_seed(static_cast<uint32_t>(seed));
+    player = new AIPlayer("MCTS",
+                          std::auto_ptr<ai::AIAlgorithm>(algorithm.release()));
   }
   return std::auto_ptr<Player>(player);
 }
@@ -84,10 +113,20 @@ bool RunConsoleGame(const base::CommandLine& cmd_line) {
       return false;
     }
   }
-  std::auto_ptr<Player> white_player(
-      GetPlayerFromCmdLine(cmd_line, kWhitePlayerType, "human", options));
-  std::auto_ptr<Player> black_player(
-      GetPlayerFromCmdLine(cmd_line, kBlackPlayerType, "alphabeta", options));
+  ai::book::OpeningBook opening_book(options);
+  if (cmd_line.HasSwitch(kOpeningBookSwitch) && !opening_book.Open(
+          base::FilePath(cmd_line.GetSwitchValue(kOpeningBookSwitch)))) {
+    std::cerr << "Could not open the opening book" << std::endl;
+    return false;
+  }
+  const ai::book::OpeningBook* const book =
+      opening_book.IsOpen() ? &opening_book : NULL;
+  // The AI players are seeded from the time, so each run plays other games.
+  const uint64_t seed = 2 * static_cast<uint64_t>(std::time(NULL));
+  std::auto_ptr<Player> white_player(GetPlayerFromCmdLine(
+      cmd_line, kWhitePlayerType, "human", options, book, seed));
+  std::auto_ptr<Player> black_player(GetPlayerFromCmdLine(
+      cmd_line, kBlackPlayerType, "alphabeta", options, book, seed + 1));
   if (!white_player.get() || !black_player.get()) {
     Usage();
     return false;
@@ -160,6 +160,9 @@ void Game::UpdateGameState() {
     }
   } else {
     const PlayerAction action = moves_.back();
+    // The player of the last action is restored for the undone actions, which
+    // can leave the game waiting for the same player to remove a piece.
+    current_player_ = action.player_color();
     if ((action.type() == PlayerAction::PLACE_PIECE ||
        action.type() == PlayerAction::MOVE_PIECE) &&
        board_.IsPartOfMill(action.destination())) {
@@ -104,6 +104,21 @@ TEST(GameTest, RemovePieceFromOpponentMill) {
   EXPECT_TRUE(game->CanExecutePlayerAction(remove_from_mill));
 }
 
+TEST(GameTest, UndoRemovePiece) {
+  std::auto_ptr<Game> game = LoadSavedGameForTests("remove_from_mill_6");
+  ASSERT_TRUE(game.get());
+  PlayerAction remove_action(BLACK_COLOR, PlayerAction::REMOVE_PIECE);
+  remove_action.set_source(BoardLocation(1, 2));
+  ASSERT_TRUE(game->CanExecutePlayerAction(remove_action));
+  game->ExecutePlayerAction(remove_action);
+  EXPECT_EQ(WHITE_COLOR, game->current_player());
+  // The black player must remove a piece again after the removal is undone.
+  game->UndoLastAction();
+  EXPECT_EQ(BLACK_COLOR, game->current_player());
+  EXPECT_EQ(PlayerAction::REMOVE_PIECE, game->next_action_type());
+  EXPECT_TRUE(game->CanExecutePlayerAction(remove_action));
+}
+
 TEST(GameTest, CanJump) {
   std::auto_ptr<Game> game = LoadSavedGameForTests("full_6");
   ASSERT_TRUE(game.get());
@@ -6,7 +6,9 @@
 
 #include <memory>
 
+#include "ai/ai_algorithm.h"
 #include "ai/alphabeta/morris_alphabeta.h"
+#include "ai/mcts/mcts_algorithm.h"
 #include "base/ptr/scoped_ptr.h"
 #include "game/game.h"
 #include "game/piece_color.h"
@@ -21,7 +23,19 @@ namespace graphics {
 
 AIPlayer::AIPlayer()
     : callback_(NULL),
+      algorithm_type_(ALPHABETA),
       algorithm_(NULL),
+      alphabeta_(NULL),
+      game_model_(NULL),
+      channel_(Ogre::Root::getSingleton().getWorkQueue()->getChannel("AI")),
+      waiting_for_response_(false) {}
+
+AIPlayer::AIPlayer(Algorithm algorithm)
+    : callback_(NULL),
+      algorithm_type_(algorithm),
+      algorithm_(NULL),
+      alphabeta_(NULL),
+      game_model_(NULL),
       channel_(Ogre::Root::getSingleton().getWorkQueue()->getChannel("AI")),
       waiting_for_response_(false) {}
 
@@ -38,6 +52,7 @@ void AIPlayer::RequestAction(const game::Game& game_model,
   DCHECK(color() != game::NO_COLOR);
   DCHECK(!waiting_for_response_);
   callback_ = callback;
+  game_model_ = &game_model;
   waiting_for_response_ = true;
   Ogre::WorkQueue* const work_queue = Ogre::Root::getSingleton().getWorkQueue();
   work_queue->addRequestHandler(channel_, this);
@@ -50,11 +65,11 @@ Ogre::WorkQueue::Response* AIPlayer::handleRequest(
     const Ogre::WorkQueue* source_queue) {
   const game::Game* game_model = request->getData().get<const game::Game*>();
   if (!Get(algorithm_)) {
-    Reset(algorithm_,
-          new ai::alphabeta::MorrisAlphaBeta(game_model->options()));
+    CreateAlgorithm(*game_model);
   }
+  ai::AIAlgorithm* const algorithm = Get(algorithm_);
   const game::PlayerAction* action = new game::PlayerAction(
-      algorithm_->GetNextAction(*game_model));
+      algorithm->GetNextAction(*game_model));
   return OGRE_NEW Ogre::WorkQueue::Response(request, true, Ogre::Any(action));
 }
 
@@ -70,6 +85,23 @@ void AIPlayer::handleResponse(const Ogre::WorkQueue::Response* response,
   work_queue->removeRequestHandler(channel_, this);
   work_queue->removeResponseHandler(channel_, this);
   (*callback_)(*action);
+  // The callback executes the action, so the opponent is thinking now, unless
+  // the action closed a mill and this player must also remove a piece.
+  if (alphabeta_ && game_model_->current_player() != color()) {
+    alphabeta_->StartPondering(*game_model_);
+  }
+}
+
+void AIPlayer::CreateAlgorithm(const game::Game& game_model) {
+  switch (algorithm_type_) {
+    case ALPHABETA:
+      alphabeta_ = new ai::alphabeta::MorrisAlphaBeta(game_model.options());
+      Reset(algorithm_, alphabeta_);
+      break;
+    case MCTS:
+      Reset(algorithm_, new ai::mcts::MctsAlgorithm(game_model.options()));
+      break;
+  }
 }
 
 }  // namespace graphics
@@ -7,7 +7,6 @@
 
 #include <memory>
 
-#include "ai/ai_algorithm.h"
 #include "base/basic_macros.h"
 #include "base/ptr/scoped_ptr.h"
 #include "graphics/graphics_export.h"
@@ -15,18 +14,36 @@
 
 #include "OGRE/OgreWorkQueue.h"
 
+namespace ai {
+class AIAlgorithm;
+namespace alphabeta {
+class MorrisAlphaBeta;
+}
+}
+
 namespace game {
 class Game;
 }
 
 namespace graphics {
 
+// Player that uses an AI algorithm on a background thread. With the
+// MorrisAlphaBeta algorithm, after each of its moves, it ponders on the move
+// predicted for the opponent until it is asked for the next action.
 class GRAPHICS_EXPORT AIPlayer
     : public PlayerDelegate,
       public Ogre::WorkQueue::RequestHandler,
       public Ogre::WorkQueue::ResponseHandler {
  public:
+  // The algorithms that can be used by the player.
+  enum Algorithm {
+    ALPHABETA,
+    MCTS
+  };
+
+  // Uses the MorrisAlphaBeta algorithm.
   AIPlayer();
+  explicit AIPlayer(Algorithm algorithm);
   virtual ~AIPlayer();
 
  private:
@@ -43,8 +60,16 @@ class GRAPHICS_EXPORT AIPlayer
   virtual void handleResponse(const Ogre::WorkQueue::Response* response,
                               const Ogre::WorkQueue* source_queue);
 
+  // Creates the algorithm when the options of the game are known.
+  void CreateAlgorithm(const game::Game& game_model);
+
   std::auto_ptr<PlayerActionCallback> callback_;
+  const Algorithm algorithm_type_;
   base::ptr::scoped_ptr<ai::AIAlgorithm> algorithm_;
+  // The same object as |algorithm_| if it is a MorrisAlphaBeta, used for
+  // pondering. Otherwise, it is NULL.
+  ai::alphabeta::MorrisAlphaBeta* alphabeta_;
+  const game::Game* game_model_;
   const Ogre::uint16 channel_;
   bool waiting_for_response_;
 
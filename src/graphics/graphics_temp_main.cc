@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 
+#include "base/command_line.h"
 #include "base/debug/stacktrace.h"
 #include "base/log.h"
 
@@ -54,6 +55,9 @@ class SampleMenu : public graphics::MenuState {
 
 int main(int argc, char** argv) {
   base::debug::EnableStackTraceDumpOnCrash();
+  // The AI players read their algorithms from the command line (see
+  // MainMenuState).
+  base::CommandLine::ForCurrentProcess()->Init(argc, argv);
   graphics::OgreApp& app = graphics::OgreApp::Instance();
   app.Init();
   game::GameOptions options;
@@ -70,5 +74,6 @@ int main(int argc, char** argv) {
   app.PushState(&game_state);
   app.RunMainLoop();
   app.ShutDown();
+  base::CommandLine::DeleteForCurrentProcess();
   return 0;
 }
@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 
+#include "base/command_line.h"
 #include "base/ptr/scoped_ptr.h"
 #include "game/game.h"
 #include "game/game_options.h"
@@ -27,6 +28,27 @@ namespace graphics {
 const char kNewGameOption[] = "New Game";
 const char kQuitOption[] = "Quit";
 
+namespace {
+
+const char kWhitePlayerSwitch[] = "--white-player";
+const char kBlackPlayerSwitch[] = "--black-player";
+
+// Creates the AI player of |color|. It uses the MCTS algorithm if it was
+// selected with --white-player=mcts or --black-player=mcts.
+PlayerDelegate* CreateAIPlayer(game::PieceColor color) {
+  const base::CommandLine* const cmd_line =
+      base::CommandLine::ForCurrentProcess();
+  const char* const switch_name =
+      color == game::WHITE_COLOR ? kWhitePlayerSwitch : kBlackPlayerSwitch;
+  if (cmd_line->HasSwitch(switch_name) &&
+      cmd_line->GetSwitchValue(switch_name) == "mcts") {
+    return new AIPlayer(AIPlayer::MCTS);
+  }
+  return new AIPlayer(AIPlayer::ALPHABETA);
+}
+
+}  // anonymous namespace
+
 MainMenuState::MainMenuState() : MenuState("MainMenu") {
   set_escape_option(kQuitOption);
 }
@@ -75,10 +97,10 @@ void MainMenuState::Resume() {
     switch (new_game_state_->player_configuration()) {
       case HUMAN_VS_AI:
         white_player.reset(new graphics::HumanPlayer());
-        black_player.reset(new graphics::AIPlayer());
+        black_player.reset(CreateAIPlayer(game::BLACK_COLOR));
         break;
       case AI_VS_HUMAN:
-        white_player.reset(new graphics::AIPlayer());
+        white_player.reset(CreateAIPlayer(game::WHITE_COLOR));
         black_player.reset(new graphics::HumanPlayer());
         break;
       case HUMAN_VS_HUMAN: